@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * IMU noise characterization with Allan deviation.
+ *
+ * Usage: IMU_noise [options] log.dat
+ *
+ * A pages of a static log are converted to acceleration and angular speed
+ * with the calibration, which is the NinjaScan default or given by --calib_file,
+ * and overlapping Allan deviations of all six axes are calculated in a single pass.
+ * The table of Allan deviations is written to the standard output (or --out=),
+ * and a calibration file snippet including sigma_accel and sigma_gyro,
+ * which is acceptable by --calib_file of INS_GPS, is written to
+ * the standard error (or --calib_out=).
+ *
+ * Options:
+ *   --calib_file=(file)
+ *      specifies the calibration file in the same format as INS_GPS.
+ *   --calib_out=(file)
+ *      specifies the output of the calibration file snippet.
+ *   --tau_max=(sec)
+ *      specifies the maximum cluster time. The default is 1000 [s].
+ *      The memory usage is proportional to it, not to the log length.
+ *   --threads=(num)
+ *      specifies the number of threads among which the six axes are distributed,
+ *      when built with OpenMP (-fopenmp, which the makefile adds if available);
+ *      otherwise it is ignored. The default is 1.
+ *   --start-gpst=(sec), --end-gpst=(sec), --in_sylphide, --out=(file), etc.
+ *      are common with other tools.
+ */
+
+#if defined(_MSC_VER) && _MSC_VER >= 1400
+#define _USE_MATH_DEFINES
+#endif
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <exception>
+
+#define IS_LITTLE_ENDIAN 1
+#include "SylphideStream.h"
+#include "SylphideProcessor.h"
+
+typedef double float_sylph_t;
+#include "analyze_common.h"
+#include "StandardCalibration.h"
+#include "algorithm/allan_variance.h"
+
+using namespace std;
+
+struct Options : public GlobalOptions<float_sylph_t> {
+  typedef GlobalOptions<float_sylph_t> super_t;
+  const char *calib_file;
+  const char *calib_out;
+  float_sylph_t tau_max;
+  int threads;
+
+  Options()
+      : super_t(),
+      calib_file(NULL), calib_out(NULL), tau_max(1000), threads(1) {}
+  ~Options(){}
+
+  /**
+   * Check command argument
+   *
+   * @param spec Command
+   * @return (bool) If recognized, true; otherwise false
+   */
+  bool check_spec(const char *spec){
+#define CHECK_OPTION(name, novalue, operation, disp) { \
+  const char *value(get_value(spec, #name, novalue)); \
+  if(value){ \
+    {operation;} \
+    std::cerr << #name << ": " << disp << std::endl; \
+    return true; \
+  } \
+}
+    CHECK_OPTION(calib_file, false, calib_file = value, calib_file);
+    CHECK_OPTION(calib_out, false, calib_out = value, calib_out);
+    CHECK_OPTION(tau_max, false, tau_max = atof(value), tau_max);
+#if defined(_OPENMP)
+    CHECK_OPTION(threads, false, threads = atoi(value), threads);
+#else
+    CHECK_OPTION(threads, false, threads = atoi(value),
+        threads << " (ignored, built without OpenMP)");
+#endif
+#undef CHECK_OPTION
+    return super_t::check_spec(spec);
+  }
+} options;
+
+/**
+ * Accumulate calibrated IMU outputs into Allan variances of six axes.
+ * Samples are buffered in a chunk, which is converted at once by the batch
+ * calibration, and then added to the axes in parallel.
+ */
+class NoiseAnalyzer {
+  public:
+    typedef AllanVariance<float_sylph_t> allan_t;
+    static const int chunk_size = 0x4000;
+  protected:
+    int raw[chunk_size][9];
+    float_sylph_t values[2][chunk_size][3]; ///< acceleration and angular speed
+    int stored;
+    float_sylph_t itow_previous, elapsed;
+    std::vector<allan_t> axes; ///< constructed after the sampling interval is estimated
+    unsigned long gaps;
+
+    void flush(){
+      if(stored == 0){return;}
+      calibration.raw2accel(&raw[0][0], stored, values[0]);
+      calibration.raw2omega(&raw[0][0], stored, values[1]);
+      if(axes.empty()){
+        unsigned long m_max(1);
+        if(elapsed > 0){
+          m_max = (unsigned long)(options.tau_max / tau0());
+        }
+        axes.assign(6, allan_t(m_max));
+      }
+      const int n(stored);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(options.threads)
+#endif
+      for(int j = 0; j < 6; ++j){
+        axes[j].add(&values[j / 3][0][j % 3], n, 3);
+      }
+      stored = 0;
+    }
+
+  public:
+    StandardCalibration calibration;
+
+    NoiseAnalyzer()
+        : stored(0), itow_previous(-1), elapsed(0), axes(), gaps(0), calibration() {
+      calibration.setup_default();
+    }
+
+    void add(const float_sylph_t &itow, const int (&ch)[9]){
+      if(itow_previous >= 0){
+        float_sylph_t delta(itow - itow_previous);
+        static const float_sylph_t one_week(60 * 60 * 24 * 7);
+        if(delta <= -(one_week / 2)){delta += one_week;} // roll over
+        if(delta > 0){elapsed += delta;}
+        if(samples() > 1){
+          float_sylph_t delta_mean(elapsed / (samples() - 1));
+          if((delta <= 0) || (delta > delta_mean * 2)){++gaps;}
+        }
+      }
+      itow_previous = itow;
+      for(int i(0); i < 9; ++i){raw[stored][i] = ch[i];}
+      if(++stored >= chunk_size){flush();}
+    }
+
+    unsigned long samples() const {
+      return (axes.empty() ? 0 : axes[0].samples()) + stored;
+    }
+    /**
+     * @return (float_sylph_t) mean sampling interval
+     */
+    float_sylph_t tau0() const {
+      return (samples() > 1) ? (elapsed / (samples() - 1)) : 0;
+    }
+
+    /**
+     * Write the table of Allan deviations, and the calibration file snippet.
+     */
+    void report(std::ostream &table, std::ostream &snippet){
+      flush();
+      if(axes.empty()){
+        cerr << "No A page found!!" << endl;
+        return;
+      }
+      if(gaps > 0){
+        cerr << "(warning) " << gaps << " gaps of sampling are found, "
+            "which may bias the results." << endl;
+      }
+      float_sylph_t tau_0(tau0());
+
+      table << "tau, accel(X), accel(Y), accel(Z), gyro(X), gyro(Y), gyro(Z)" << endl;
+      int clusters(axes[0].clusters_available());
+      for(int i(0); i < clusters; ++i){
+        table << (tau_0 * axes[0].cluster_size(i));
+        for(int j(0); j < 6; ++j){
+          table << ", " << axes[j].deviation(i);
+        }
+        table << endl;
+      }
+
+      float_sylph_t mean[6], random_walk[6], bias_instability[6], sigma[6];
+      for(int j(0); j < 6; ++j){
+        mean[j] = axes[j].mean();
+        sigma[j] = axes[j].deviation(0); // white noise of each sample
+        random_walk[j] = sigma[j] * std::sqrt(tau_0);
+        float_sylph_t min_dev(sigma[j]);
+        for(int i(1); i < clusters; ++i){
+          if(axes[j].deviation(i) < min_dev){min_dev = axes[j].deviation(i);}
+        }
+        bias_instability[j] = min_dev / 0.664; // flicker floor
+      }
+#define print_3(title, target, offset) \
+  snippet << title << ' ' << target[offset] << ' ' << target[offset + 1] << ' ' << target[offset + 2] << endl
+      snippet << "# IMU_noise: " << samples() << " samples, tau0 " << tau_0 << " [s]" << endl;
+      print_3("# accel mean [m/s^2]", mean, 0);
+      print_3("# accel velocity random walk [m/s/sqrt(s)]", random_walk, 0);
+      print_3("# accel bias instability [m/s^2]", bias_instability, 0);
+      print_3("# gyro mean [rad/s]", mean, 3);
+      print_3("# gyro angle random walk [rad/sqrt(s)]", random_walk, 3);
+      print_3("# gyro bias instability [rad/s]", bias_instability, 3);
+      print_3("sigma_accel", sigma, 0);
+      print_3("sigma_gyro", sigma, 3);
+#undef print_3
+    }
+};
+
+class StreamProcessor : public SylphideProcessor<float_sylph_t> {
+  protected:
+    typedef SylphideProcessor<float_sylph_t> super_t;
+
+  public:
+    NoiseAnalyzer analyzer;
+
+    /**
+     * A page (ADC value)
+     */
+    struct HandlerA {
+      NoiseAnalyzer &analyzer;
+      float_sylph_t itow_latest;
+      HandlerA(NoiseAnalyzer &_analyzer) : analyzer(_analyzer), itow_latest(0) {}
+      void operator()(const A_Observer_t &observer){
+        if(!observer.validate()){return;}
+
+        float_sylph_t itow(observer.fetch_ITOW());
+        if(options.reduce_1pps_sync_error){
+          float_sylph_t delta_t(itow - itow_latest);
+          if((delta_t >= 1) && (delta_t < 2)){itow -= 1;}
+        }
+        itow_latest = itow;
+        if(!options.is_time_in_range(itow, Options::gps_time_t::WN_INVALID)){return;}
+
+        int ch[9];
+        A_Observer_t::values_t values(observer.fetch_values());
+        for(int i = 0; i < 8; i++){
+          ch[i] = values.values[i];
+        }
+        ch[8] = values.temperature;
+        analyzer.add(itow, ch);
+      }
+    } handler_A;
+
+    StreamProcessor() : super_t(), analyzer(), handler_A(analyzer) {}
+    ~StreamProcessor(){}
+
+    /**
+     * Extract A pages from stream until the end of stream is found
+     *
+     * @param in stream
+     */
+    void process(istream &in){
+      char buffer[SYLPHIDE_PAGE_SIZE];
+      while(true){
+        in.read(buffer, SYLPHIDE_PAGE_SIZE);
+        int read_count(in.gcount());
+        if(in.fail() || (read_count == 0)){return;}
+        if(buffer[0] == 'A'){
+          super_t::process_packet(
+              buffer, read_count,
+              observer_A, previous_seek_next_A, handler_A);
+        }
+      }
+    }
+};
+
+int main(int argc, char *argv[]){
+
+  cerr << "NinjaScan IMU noise characterization with Allan deviation." << endl;
+  cerr << "Usage: " << argv[0] << " [options] log.dat" << endl;
+  if(argc < 2){
+    cerr << "Error: too few arguments; " << argc << " < min(2)" << endl;
+    return -1;
+  }
+
+  StreamProcessor *processor(new StreamProcessor());
+
+  int log_index(0);
+
+  // check options
+  for(int i(1); i < argc; i++){
+    if(options.check_spec(argv[i])){continue;}
+    if(log_index > 0){
+      cerr << "Unknown option!! : " << argv[i] << endl;
+      return -1;
+    }
+    log_index = i;
+  }
+  if(log_index == 0){
+    cerr << "Error: no log file!!" << endl;
+    return -1;
+  }
+
+  if(options.calib_file){
+    cerr << "IMU Calibration file (" << options.calib_file << ") reading..." << endl;
+    istream &in(options.spec2istream(options.calib_file));
+    char buf[1024];
+    while(!in.eof()){
+      in.getline(buf, sizeof(buf));
+      if((!buf[0]) || (buf[0] == '#')){continue;}
+      if(!processor->analyzer.calibration.check_spec(buf)){
+        cerr << "unknown_calib_param! : " << buf << endl;
+        return -1;
+      }
+    }
+  }
+
+  if(options.in_sylphide){
+    SylphideIStream sylph_in(options.spec2istream(argv[log_index]), SYLPHIDE_PAGE_SIZE);
+    processor->process(sylph_in);
+  }else{
+    processor->process(options.spec2istream(argv[log_index]));
+  }
+
+  options.out().precision(10);
+  std::ostream &snippet(options.calib_out
+      ? options.spec2ostream(options.calib_out)
+      : std::cerr);
+  snippet.precision(10);
+  processor->analyzer.report(options.out(), snippet);
+
+  delete processor;
+  return 0;
+}
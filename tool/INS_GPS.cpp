@@ -105,6 +105,37 @@
  *   --use_udkf=<off|on>
  *      specifies whether the UD factorized Kalamn filter (UDKF), or the standard Kalman
  *      filter is utilized. The default is off (standard KF).
+ *   --mixed_precision=<off|on>
+ *      specifies whether the covariance matrices of the filter are calculated in single
+ *      precision, while the navigation states (position, velocity and attitude) are
+ *      kept in double precision. Because single precision covariance requires
+ *      numerical robustness, this option implies --use_udkf=on. The default is off.
+ *   --cov_decimation=(samples)
+ *      specifies the number of IMU samples over which the covariance propagation is
+ *      performed at once, while the mechanization is still performed at every sample.
+ *      The default is 1 (propagation at every sample). This option is effective only
+ *      in the default (offline) mode, and ignored with --back_propagate or --realtime.
+ *   --imu_block=(samples)
+ *      specifies the number of IMU samples accumulated, with coning and sculling
+ *      compensation, into a block before the mechanization, which is then performed
+ *      once per block with the attitude propagated by rotation quaternions.
+ *      The block is also closed before every measurement update and at the end of the log.
+ *      The default is 1 (mechanization at every sample).
+ *   --use_egm=<off|on>
+ *      specifies whether the Earth gravity model EGM2008 (up to degree 70), or the WGS84
+ *      normal gravity is utilized. The default is off (WGS84).
+ *   --egm_grid=<on|off>
+ *      specifies whether the gravity of --use_egm is interpolated with a lookup grid,
+ *      which is generated around the current position on demand, or the gravity model is
+ *      directly evaluated at every update. The interpolation error is checked to be less
+ *      than 1E-6 [m/s^2] for each component. The default is on.
+ *   --egm_grid_file=(file)
+ *      specifies a file from which the lookup grid of --egm_grid is loaded.
+ *      With --egm_grid_box, the grid is generated and saved to the file instead.
+ *   --egm_grid_box=(lat_min [deg]),(lng_min [deg]),(lat_max [deg]),(lng_max [deg])[,(h_min [m]),(h_max [m])]
+ *      specifies the bounding box over which the lookup grid is generated in advance.
+ *      Without --egm_grid_file, the generated grid is only kept in memory.
+ *      The default height range is from -100 to 1000 meters.
  *
  *   --direct_sylphide=<off|on>
  *   --in_sylphide=<off|on>
@@ -123,11 +154,36 @@
  * The followings are advanced (i.e., very experimental) options;
  *   --back_propagate
  *      apply Kalman filter smoothing to previously time-updated data
- *      (exclusive with --realtime)
+ *      (exclusive with --realtime and --rts_smoothing)
  *   --realtime
  *      change GPS synchronization strategy to support realtime applications.
  *      It processes data without sorting and outputs calculation results as quick as possible.
- *      (exclusive with --back_propagate)
+ *      A histogram of processing latency from the arrival of data to the output is reported at exit.
+ *      (exclusive with --back_propagate and --rts_smoothing)
+ *   --rt_max_delay=(seconds)
+ *      specifies the maximum delay of GPS information compensated in --realtime mode,
+ *      which determines the size of the preallocated snapshot pool. The default is 2.
+ *   --rts_smoothing
+ *      apply Rauch-Tung-Striebel fixed-interval smoothing over the whole log.
+ *      The forward pass is spilled to a file, and the smoothed results are output
+ *      after all data are processed. (exclusive with --back_propagate and --realtime)
+ *   --rts_spill=(file)
+ *      specifies the spill file of --rts_smoothing.
+ *      The default is a temporary file, which is removed automatically.
+ *   --debug=<KF_P|KF_FULL>
+ *      writes the covariance matrix P (KF_P), and additionally the matrices of the last
+ *      time or measurement update (KF_FULL) to --out_debug after every update.
+ *   --debug_binary=<off|on>
+ *      specifies whether the output of --debug=<KF_P|KF_FULL> is in a binary format
+ *      of fixed-size records, which is defined and readable with
+ *      navigation/INS_GPS_Debug_Dump.h, instead of text. A record contains the time stamp
+ *      and the upper triangle of P, and with KF_FULL, the transition matrix Phi,
+ *      the Kalman gain K and the residual in addition. The default is off.
+ *      It is an error to turn on without --debug=<KF_P|KF_FULL>.
+ *   --debug_interval=(seconds)
+ *      specifies the minimum interval of binary debug records, which is applied to
+ *      time and measurement updates independently of each other and of the navigation
+ *      output. The default is 0 (every update).
  *
  */
 
@@ -150,6 +206,11 @@
 #include <utility>
 #include <deque>
 #include <algorithm>
+#if __cplusplus >= 201103L
+#include <chrono>
+#else
+#include <ctime>
+#endif
 
 #define IS_LITTLE_ENDIAN 1
 #include "SylphideStream.h"
@@ -178,8 +239,11 @@ struct QuaternionData_TypeMapper<float_sylph_t> {
 #include "navigation/INS_GPS_Debug.h"
 
 #include "navigation/MagneticField.h"
+#include "navigation/MagneticFieldCache.h"
+#include "navigation/ConingSculling.h"
 
 #include "analyze_common.h"
+#include "StandardCalibration.h"
 
 struct Options : public GlobalOptions<float_sylph_t> {
   typedef GlobalOptions<float_sylph_t> super_t;
@@ -228,13 +292,39 @@ struct Options : public GlobalOptions<float_sylph_t> {
     INS_GPS_SYNC_OFFLINE,
     INS_GPS_SYNC_BACK_PROPAGATION, ///< a.k.a, smoothing
     INS_GPS_SYNC_REALTIME,
+    INS_GPS_SYNC_RTS_SMOOTHING, ///< fixed-interval smoothing over the whole log
   } ins_gps_sync_strategy;
   bool est_bias; ///< True for performing bias estimation
   bool use_udkf; ///< True for UD Kalman filtering
+  bool mixed_precision; ///< True for single precision covariance with double precision states
+  unsigned int cov_decimation; ///< Number of samples per covariance propagation
+  unsigned int imu_block; ///< Number of samples per mechanization
   bool use_egm; ///< True for precise Earth gravity model
+  struct egm_grid_t {
+    bool enabled; ///< True for lookup grid of gravity instead of direct evaluation of EGM
+    const char *file; ///< file from (or to, when box is given) which the grid is loaded (saved)
+    bool box_given; ///< True for generating the grid in advance
+    float_sylph_t lat_min, lng_min, lat_max, lng_max; ///< bounding box [deg]
+    float_sylph_t h_min, h_max; ///< bounding box [m]
+    egm_grid_t()
+        : enabled(true), file(NULL), box_given(false),
+        lat_min(0), lng_min(0), lat_max(0), lng_max(0),
+        h_min(-100), h_max(1000) {}
+    bool parse_box(const char *spec){
+      int converted(std::sscanf(spec, "%lf,%lf,%lf,%lf,%lf,%lf",
+          &lat_min, &lng_min, &lat_max, &lng_max, &h_min, &h_max));
+      return box_given = ((converted == 4) || (converted == 6));
+    }
+    friend std::ostream &operator<<(std::ostream &out, const egm_grid_t &grid){
+      return out << "(lat, lng, h) ["
+          << grid.lat_min << ", " << grid.lng_min << ", " << grid.h_min << "] - ["
+          << grid.lat_max << ", " << grid.lng_max << ", " << grid.h_max << "]";
+    }
+  } egm_grid;
 
   INS_GPS_Back_Propagate_Property<float_sylph_t> back_propagate_property;
   INS_GPS_RealTime_Property realttime_property;
+  INS_GPS_RTS_Smoother_Property rts_smoother_property;
 
   // GPS options
   bool gps_fake_lock; ///< true when gps dummy date is used.
@@ -283,6 +373,9 @@ struct Options : public GlobalOptions<float_sylph_t> {
 
   // Debug
   INS_GPS_Debug_Property debug_property;
+  bool debug_binary;
+  float_sylph_t debug_interval;
+  INS_GPS_Debug_Dump_Writer debug_dump;
 
   Options()
       : super_t(),
@@ -290,16 +383,17 @@ struct Options : public GlobalOptions<float_sylph_t> {
       out_is_N_packet(false),
       time_stamp(),
       ins_gps_sync_strategy(INS_GPS_SYNC_OFFLINE),
-      est_bias(true), use_udkf(false), use_egm(false),
+      est_bias(true), use_udkf(false), mixed_precision(false), cov_decimation(1), imu_block(1), use_egm(false), egm_grid(),
       back_propagate_property(),
       realttime_property(),
+      rts_smoother_property(),
       gps_fake_lock(false), gps_threshold(),
       use_magnet(false),
       mag_heading_accuracy_deg(3),
       yaw_correct_with_mag_when_speed_less_than_ms(5),
       initial_attitude(),
       init_misc_buf(), init_misc(&init_misc_buf),
-      debug_property() {
+      debug_property(), debug_binary(false), debug_interval(0), debug_dump() {
     realttime_property.rt_mode = INS_GPS_RealTime_Property::RT_LIGHT_WEIGHT;
   }
   ~Options(){}
@@ -355,9 +449,34 @@ CHECK_OPTION(target, true, target = is_true(value), (target ? "on" : "off"));
     CHECK_OPTION(realtime, true,
         if(is_true(value)){ins_gps_sync_strategy = INS_GPS_SYNC_REALTIME;},
         (ins_gps_sync_strategy == INS_GPS_SYNC_REALTIME ? "on" : "off"));
+    CHECK_OPTION(rt_max_delay, false,
+        realttime_property.max_delay = std::atof(value),
+        realttime_property.max_delay << " [s]");
+    CHECK_OPTION(rts_smoothing, true,
+        if(is_true(value)){ins_gps_sync_strategy = INS_GPS_SYNC_RTS_SMOOTHING;},
+        (ins_gps_sync_strategy == INS_GPS_SYNC_RTS_SMOOTHING ? "on" : "off"));
+    CHECK_OPTION(rts_spill, false,
+        rts_smoother_property.spill_file = value,
+        (rts_smoother_property.spill_file ? rts_smoother_property.spill_file : "(temporary)"));
     CHECK_OPTION_BOOL(est_bias);
     CHECK_OPTION_BOOL(use_udkf);
+    CHECK_OPTION_BOOL(mixed_precision);
+    CHECK_OPTION(cov_decimation, false,
+        cov_decimation = std::atoi(value),
+        cov_decimation);
+    CHECK_OPTION(imu_block, false,
+        imu_block = std::atoi(value),
+        imu_block);
     CHECK_OPTION_BOOL(use_egm);
+    CHECK_OPTION(egm_grid, true,
+        egm_grid.enabled = is_true(value),
+        (egm_grid.enabled ? "on" : "off"));
+    CHECK_OPTION(egm_grid_file, false,
+        egm_grid.file = value,
+        egm_grid.file);
+    CHECK_OPTION(egm_grid_box, false,
+        if(!egm_grid.parse_box(value)){return false;},
+        egm_grid);
     CHECK_OPTION(bp_depth, false,
         back_propagate_property.back_propagate_depth = std::atof(value),
         back_propagate_property.back_propagate_depth);
@@ -404,6 +523,10 @@ CHECK_OPTION(target, true, target = is_true(value), (target ? "on" : "off"));
     CHECK_OPTION(debug, false,
         if(!debug_property.check_debug_property_spec(value)){break;},
         debug_property.show_debug_property());
+    CHECK_OPTION_BOOL(debug_binary);
+    CHECK_OPTION(debug_interval, false,
+        debug_interval = std::atof(value),
+        debug_interval << " [s]");
 #undef CHECK_OPTION
     
     return super_t::check_spec(spec);
@@ -439,12 +562,22 @@ struct CalendarTimeStamp : public CalendarTime<FloatT> {
         << "sec";
   }
   friend std::ostream &operator<<(std::ostream &out, const CalendarTimeStamp &time){
-    out << time.year << ','
-        << time.month << ','
-        << time.mday << ','
-        << time.hour << ','
-        << time.min << ','
-        << time.sec;
+    // The text before sec is formatted again only when it is changed, i.e., once per minute.
+    static struct {
+      int year, month, mday, hour, min;
+      char str[0x40];
+    } cache = {-1};
+    if((time.min != cache.min) || (time.hour != cache.hour)
+        || (time.mday != cache.mday) || (time.month != cache.month) || (time.year != cache.year)){
+      cache.year = time.year;
+      cache.month = time.month;
+      cache.mday = time.mday;
+      cache.hour = time.hour;
+      cache.min = time.min;
+      std::sprintf(cache.str, "%d,%d,%d,%d,%d,",
+          time.year, time.month, time.mday, time.hour, time.min);
+    }
+    out << cache.str << time.sec;
     return out;
   }
 };
@@ -473,7 +606,15 @@ class NAV : public Updatable {
       return updated_items_t();
     }
     virtual void inspect(std::ostream &out) const {}
+    /**
+     * Write a binary debug record when the filter is updated with the last packet.
+     */
+    virtual void inspect_binary(INS_GPS_Debug_Dump_Writer &writer) const {}
     virtual float_sylph_t &operator[](const unsigned &index) = 0;
+    /**
+     * Invoked after all packets are processed.
+     */
+    virtual void finalize(){}
 
     template <class Container>
     static typename Container::const_iterator nearest(
@@ -491,6 +632,30 @@ class NAV : public Updatable {
       return it_head;
     }
 
+    typedef MagneticFieldCacheGeneric<float_sylph_t> mag_field_t;
+    /**
+     * Earth's magnetic field model with a lookup cache.
+     * Its epoch is that of the latest model (IGRF2015)
+     * until set_mag_epoch() is invoked with a valid GPS time.
+     */
+    static mag_field_t &mag_field(){
+      static mag_field_t field(IGRF12::IGRF2015.year);
+      return field;
+    }
+    /**
+     * Set the epoch of the magnetic field model with GPS time.
+     * Only the first call is effective, i.e., the epoch is fixed once per run.
+     *
+     * @param week GPS week number
+     * @param itow time of week [s]
+     */
+    static void set_mag_epoch(const int &week, const float_sylph_t &itow){
+      static bool fixed(false);
+      if(fixed){return;}
+      fixed = true;
+      mag_field().set_year(mag_field_t::gps2year(week, itow));
+    }
+
     /**
      * Estimate yaw correction angle by using magnetic sensor values
      *
@@ -509,9 +674,8 @@ class NAV : public Updatable {
       vec_t mag_horizontal((attitude * quat_t(0, mag) * attitude.conj()).vector());
 
       // Call Earth's magnetic field model
-      MagneticField::field_components_res_t mag_model(
-          MagneticField::field_components(IGRF12::IGRF2015,
-              latitude, longitude, altitude));
+      mag_field_t::field_components_res_t mag_model(
+          mag_field().field_components(latitude, longitude, altitude));
       vec_t mag_field(mag_model.north, mag_model.east, mag_model.down);
 
       // Get the correction angle with the model
@@ -562,18 +726,76 @@ class NAV : public Updatable {
     }
 };
 
+/**
+ * Histogram of processing latency, whose bins are spaced in powers of two [us].
+ */
+struct LatencyHistogram {
+  static const int bins = 24; ///< the last bin counts 2^23 [us] (about 8 [s]) or more
+  unsigned long counts[bins];
+  unsigned long samples;
+  double sum, max; ///< [s]
+
+  LatencyHistogram() : samples(0), sum(0), max(0) {
+    std::fill(counts, counts + bins, 0);
+  }
+
+  void add(const double &latency){
+    int i(0);
+    for(double us(latency * 1E6); (us >= 1) && (i < bins - 1); us /= 2, ++i);
+    ++counts[i];
+    ++samples;
+    sum += latency;
+    if(latency > max){max = latency;}
+  }
+
+  struct timer_t {
+#if __cplusplus >= 201103L
+    typedef std::chrono::steady_clock clock_t;
+    clock_t::time_point start;
+    timer_t() : start(clock_t::now()) {}
+    double elapsed() const {
+      return std::chrono::duration<double>(clock_t::now() - start).count();
+    }
+#else
+    std::clock_t start;
+    timer_t() : start(std::clock()) {}
+    double elapsed() const {
+      return (double)(std::clock() - start) / CLOCKS_PER_SEC;
+    }
+#endif
+  };
+
+  friend std::ostream &operator<<(std::ostream &out, const LatencyHistogram &hist){
+    if(hist.samples == 0){return out << "(no sample)";}
+    out << "samples: " << hist.samples
+        << ", mean: " << (hist.sum / hist.samples * 1E6) << " [us]"
+        << ", max: " << (hist.max * 1E6) << " [us]";
+    for(int i(0); i < bins; ++i){
+      if(hist.counts[i] == 0){continue;}
+      out << std::endl << "  < " << (1UL << i) << " [us]: " << hist.counts[i];
+    }
+    return out;
+  }
+};
+
 template <class BaseNAV>
 struct NAV_Factory {
   typedef BaseNAV self_t;
 
   struct NAVDisplay : public BaseNAV {
-    NAVDisplay() : BaseNAV() {}
+    LatencyHistogram latency_tu, latency_mu; ///< for time and measurement updates, respectively
+    NAVDisplay() : BaseNAV(), latency_tu(), latency_mu() {}
     void label(std::ostream &out = std::cout) const {
       if(options.out_is_N_packet){return;}
       BaseNAV::label(options.out());
       options.out() << std::endl;
     }
     void updated() const {
+      if(options.debug_dump.active()){
+        // Records are taken from the filter itself, and thinned only by --debug_interval.
+        BaseNAV::inspect_binary(options.debug_dump);
+      }
+
       const NAV::updated_items_t &items(BaseNAV::updated_items());
       if(items.empty()){return;}
 
@@ -589,19 +811,34 @@ struct NAV_Factory {
         }
       }
 
+      if(options.debug_dump.active()){return;}
       options.out_debug() << (**(items.rbegin())).time_stamp() << ',';
       BaseNAV::inspect(options.out_debug());
       options.out_debug() << std::endl;
     }
-#define update_func(type) \
+#define update_func(type, latency) \
 virtual void update(const type &packet){ \
+  LatencyHistogram::timer_t timer; \
   BaseNAV::update(packet); \
   updated(); \
+  if(options.ins_gps_sync_strategy == Options::INS_GPS_SYNC_REALTIME){ \
+    latency.add(timer.elapsed()); \
+  } \
 }
-    update_func(A_Packet);
-    update_func(G_Packet);
-    update_func(M_Packet);
+    update_func(A_Packet, latency_tu);
+    update_func(G_Packet, latency_mu);
 #undef update_func
+    virtual void update(const M_Packet &packet){
+      BaseNAV::update(packet);
+      updated();
+    }
+    void finalize(){
+      while(BaseNAV::finalize_1step()){updated();}
+      if(options.ins_gps_sync_strategy == Options::INS_GPS_SYNC_REALTIME){
+        std::cerr << "Latency (time update): " << latency_tu << std::endl;
+        std::cerr << "Latency (measurement update): " << latency_mu << std::endl;
+      }
+    }
   };
 
   typedef NAVDisplay disp_t;
@@ -711,6 +948,7 @@ class INS_GPS_NAV : public NAV {
   protected:
     ins_gps_t *ins_gps;
     Helper helper;
+    ConingScullingAccumulator<float_t> imu_block;
 
     void setup_filter(void *){}
 
@@ -756,6 +994,45 @@ class INS_GPS_NAV : public NAV {
         
         ins_gps->getFilter().setQ(Q);
       }
+
+      if(options.ins_gps_sync_strategy == Options::INS_GPS_SYNC_OFFLINE){
+        ins_gps->set_predict_decimation(options.cov_decimation);
+      }
+
+      setup_egm(ins_gps);
+    }
+
+    void setup_egm(void *){}
+
+    template <class PureINS, class EGM>
+    void setup_egm(INS_EGM<PureINS, EGM> *) {
+      if(!options.egm_grid.enabled){return;}
+      typedef INS_EGM<PureINS, EGM> ins_egm_t;
+      typename ins_egm_t::gravity_grid_t &grid(ins_egm_t::shared_gravity_grid());
+      if(options.egm_grid.box_given){
+        static const float_t deg2rad(M_PI / 180);
+        std::cerr << "egm_grid: generating ... ";
+        grid.prepare(
+            deg2rad * options.egm_grid.lat_min, deg2rad * options.egm_grid.lng_min, options.egm_grid.h_min,
+            deg2rad * options.egm_grid.lat_max, deg2rad * options.egm_grid.lng_max, options.egm_grid.h_max);
+        std::cerr << grid.tiles_generated() << " tiles ("
+            << grid.tiles_rejected() << " rejected)";
+        if(options.egm_grid.file){ // save
+          std::cerr << " => ";
+          std::ostream &out(options.spec2ostream(options.egm_grid.file, true));
+          grid.save(out);
+          out.flush();
+        }else{ // in memory only
+          std::cerr << std::endl;
+        }
+      }else if(options.egm_grid.file){
+        std::cerr << "egm_grid: loading ";
+        if(!grid.load(options.spec2istream(options.egm_grid.file, true))){
+          std::cerr << "egm_grid: Invalid grid file!!" << std::endl;
+          exit(-1);
+        }
+      }
+      ((ins_egm_t *)ins_gps)->set_gravity_grid(&grid);
     }
 
     void setup_filter(
@@ -810,6 +1087,12 @@ class INS_GPS_NAV : public NAV {
       ins_gps->setup_back_propagation(options.back_propagate_property);
     }
 
+    template <class Base_INS_GPS>
+    void setup_filter(INS_GPS_RTS_Smoother<Base_INS_GPS> *){
+      setup_filter((Base_INS_GPS *)ins_gps);
+      ins_gps->setup_rts_smoothing(options.rts_smoother_property);
+    }
+
     template <class Base_INS_GPS>
     void setup_filter(INS_GPS_RealTime<Base_INS_GPS> *){
       setup_filter((Base_INS_GPS *)ins_gps);
@@ -827,6 +1110,7 @@ class INS_GPS_NAV : public NAV {
         : NAV(),
         ins_gps(new INS_GPS()), helper(*this) {
       setup_filter(ins_gps);
+      ins_gps->set_attitude_by_rotation(options.imu_block > 1);
     }
     virtual ~INS_GPS_NAV() {
       delete ins_gps;
@@ -847,6 +1131,17 @@ class INS_GPS_NAV : public NAV {
       inspect(out, ins_gps);
     }
 
+    void inspect_binary(INS_GPS_Debug_Dump_Writer &writer, const float_sylph_t &t, void *) const {}
+    template <class INS_GPS_base>
+    void inspect_binary(INS_GPS_Debug_Dump_Writer &writer, const float_sylph_t &t,
+        INS_GPS_Debug<INS_GPS_base> *) const {
+      ins_gps->inspect_binary(writer, t);
+    }
+    void inspect_binary(INS_GPS_Debug_Dump_Writer &writer) const {
+      if(!helper.filter_updated()){return;}
+      inspect_binary(writer, ins_gps->time_stamp(), ins_gps);
+    }
+
   protected:
     static void set_matrix_full(mat_t &mat, const char *spec){
       char *_spec(const_cast<char *>(spec));
@@ -932,12 +1227,36 @@ class INS_GPS_NAV : public NAV {
         const vec3_t &accel,
         const vec3_t &gyro,
         const float_t &elapsedT){
-      ins_gps->update(accel, gyro, elapsedT);
+      if(options.imu_block <= 1){
+        ins_gps->update(accel, gyro, elapsedT);
+        return *this;
+      }
+      imu_block.add(accel, gyro, elapsedT);
+      if(imu_block.samples() >= (int)options.imu_block){
+        flush_imu_block();
+      }
       return *this;
     }
+
+    /**
+     * Perform the mechanization with the samples accumulated in the current block, if any.
+     */
+    void flush_imu_block(){
+      if(imu_block.samples() == 0){return;}
+      ins_gps->update(imu_block.accel(), imu_block.gyro(), imu_block.elapsed());
+      imu_block.reset();
+    }
+
+    /**
+     * @return (bool) true when some samples are accumulated but not yet reflected to the states
+     */
+    bool time_update_pending() const {
+      return imu_block.samples() > 0;
+    }
   
   public:
     NAV &correct(const G_Packet &gps){
+      flush_imu_block();
       ins_gps->correct(gps);
       return *this;
     }
@@ -946,6 +1265,7 @@ class INS_GPS_NAV : public NAV {
         const G_Packet &gps,
         const vec3_t &lever_arm_b,
         const vec3_t &omega_b2i_4b){
+      flush_imu_block();
       ins_gps->correct(gps, lever_arm_b, omega_b2i_4b);
       return *this;
     }
@@ -964,6 +1284,7 @@ class INS_GPS_NAV : public NAV {
     NAV &correct(
         const G_Packet &gps,
         const float_t &advanceT){
+      flush_imu_block();
       if(setup_correct(advanceT, ins_gps)){
         return correct(gps);
       }else{
@@ -976,6 +1297,7 @@ class INS_GPS_NAV : public NAV {
         const vec3_t &lever_arm_b,
         const vec3_t &omega_b2i_4b,
         const float_t &advanceT){
+      flush_imu_block();
       if(setup_correct(advanceT, ins_gps)){
         return correct(gps, lever_arm_b, omega_b2i_4b);
       }else{
@@ -984,6 +1306,7 @@ class INS_GPS_NAV : public NAV {
     }
 
     NAV &correct_yaw(const float_t &delta_yaw){
+      flush_imu_block();
       ins_gps->correct_yaw(delta_yaw, pow(deg2rad(options.mag_heading_accuracy_deg), 2));
       return *this;
     }
@@ -996,6 +1319,20 @@ class INS_GPS_NAV : public NAV {
       return helper.updated_items();
     }
 
+    /**
+     * Perform one step of post-processing after all packets are processed.
+     *
+     * @return (bool) true when items are updated by this step, otherwise false
+     */
+    bool finalize_1step(){
+      if(time_update_pending()){
+        // The last partial block is reflected before the post-processing of the helper.
+        flush_imu_block();
+        return true;
+      }
+      return helper.finalize_1step();
+    }
+
     void update(const A_Packet &packet){
       helper.before_any_update();
       helper.time_update(packet);
@@ -1009,6 +1346,9 @@ class INS_GPS_NAV : public NAV {
       helper.compass(packet);
     }
     void update(const TimePacket &packet){
+      if(packet.valid_week_num){
+        NAV::set_mag_epoch(packet.week_num, packet.itow);
+      }
       helper.t_stamp_generator.update(packet);
     }
 };
@@ -1046,6 +1386,8 @@ struct INS_GPS_NAV_Factory : public NAV_Factory<INS_GPS> {
           return Checker<INS_GPS_Back_Propagate<T> >::check_covariance(calibration);
         case Options::INS_GPS_SYNC_REALTIME:
           return Checker<INS_GPS_RealTime<T> >::check_covariance(calibration);
+        case Options::INS_GPS_SYNC_RTS_SMOOTHING:
+          return Checker<INS_GPS_RTS_Smoother<T> >::check_covariance(calibration);
         case Options::INS_GPS_SYNC_OFFLINE:
         default:
           return check_covariance(calibration);
@@ -1245,11 +1587,10 @@ class INS_GPS_NAVData : public INS_GPS {
         std::ostream &out, const Filtered_INS_BiasEstimated<BaseFINS> *fins) const {
       dump2(out, (const BaseFINS *)fins);
       if(options.dump_stddev){
-        const mat_t &P(
-            const_cast<Filtered_INS_BiasEstimated<BaseFINS> *>(fins)->getFilter().getP());
+        // const access, which does not flush decimated propagation
         for(int i(Filtered_INS_BiasEstimated<BaseFINS>::P_SIZE_WITHOUT_BIAS), j(0);
             j < Filtered_INS_BiasEstimated<BaseFINS>::P_SIZE_BIAS; ++i, ++j){
-          out << ',' << sqrt(P(i, i));
+          out << ',' << sqrt(fins->getFilter().getP(i, i));
         }
       }
     }
@@ -1266,169 +1607,6 @@ class INS_GPS_NAVData : public INS_GPS {
     }
 };
 
-struct StandardCalibration {
-
-  int index_base, index_temp_ch;
-  template <std::size_t N>
-  struct calibration_info_t {
-    float_sylph_t bias_tc[N];
-    float_sylph_t bias_base[N];
-    float_sylph_t sf[N];
-    float_sylph_t alignment[N][N];
-    float_sylph_t sigma[N];
-    static void set(char *spec, float_sylph_t target[N]){
-      for(int i(0); i < N; i++){
-        target[i] = std::strtod(spec, &spec);
-      }
-    }
-    static void set(char *spec, float_sylph_t target[N][N]){
-      for(int i(0); i < N; i++){
-        for(int j(0); j < N; j++){
-          target[i][j] = std::strtod(spec, &spec);
-        }
-      }
-    }
-    static std::ostream &dump(std::ostream &out, const float_sylph_t target[N]){
-      for(int i(0); i < N; i++){
-        out << " " << target[i];
-      }
-      return out;
-    }
-    static std::ostream &dump(std::ostream &out, const float_sylph_t target[N][N]){
-      for(int i(0); i < N; i++){
-        for(int j(0); j < N; j++){
-          out << " " << target[i][j];
-        }
-      }
-      return out;
-    }
-  };
-  typedef calibration_info_t<3> dof3_t;
-  dof3_t accel, gyro;
-
-  bool check_spec(const char *line){
-    const char *value;
-    if(value = Options::get_value2(line, "index_base")){
-      index_base = std::atoi(value);
-      return true;
-    }
-    if(value = Options::get_value2(line, "index_temp_ch")){
-      index_temp_ch = std::atoi(value);
-      return true;
-    }
-#define TO_STRING(name) # name
-#define check_proc(name, sensor, item) \
-if(value = Options::get_value2(line, TO_STRING(name))){ \
-  dof3_t::set(const_cast<char *>(value), sensor.item); \
-  return true; \
-}
-    check_proc(acc_bias_tc, accel, bias_tc);
-    check_proc(acc_bias, accel, bias_base);
-    check_proc(acc_sf, accel, sf);
-    check_proc(acc_mis, accel, alignment);
-    check_proc(gyro_bias_tc, gyro, bias_tc);
-    check_proc(gyro_bias, gyro, bias_base);
-    check_proc(gyro_sf, gyro, sf);
-    check_proc(gyro_mis, gyro, alignment);
-    check_proc(sigma_accel, accel, sigma);
-    check_proc(sigma_gyro, gyro, sigma);
-#undef check_proc
-#undef TO_STRING
-
-    return false;
-  }
-
-  friend std::ostream &operator<<(
-      std::ostream &out, const StandardCalibration &calib){
-    out << "index_base " << calib.index_base << std::endl;
-    out << "index_temp_ch " << calib.index_temp_ch << std::endl;
-#define TO_STRING(name) # name
-#define dump_proc(name, sensor, item) \
-  out << TO_STRING(name); \
-  dof3_t::dump(out, calib.sensor.item)
-    dump_proc(acc_bias_tc, accel, bias_tc) << std::endl;
-    dump_proc(acc_bias, accel, bias_base) << std::endl;
-    dump_proc(acc_sf, accel, sf) << std::endl;
-    dump_proc(acc_mis, accel, alignment) << std::endl;
-    dump_proc(gyro_bias_tc, gyro, bias_tc) << std::endl;
-    dump_proc(gyro_bias, gyro, bias_base) << std::endl;
-    dump_proc(gyro_sf, gyro, sf) << std::endl;
-    dump_proc(gyro_mis, gyro, alignment) << std::endl;
-    dump_proc(sigma_accel, accel, sigma) << std::endl;
-    dump_proc(sigma_gyro, gyro, sigma);
-#undef dump_proc
-#undef TO_STRING
-    return out;
-  }
-
-  template <class NumType, std::size_t N>
-  static void calibrate(
-      const NumType raw[],
-      const NumType &bias_mod,
-      const calibration_info_t<N> &info,
-      float_sylph_t (&res)[N]) {
-
-    // Temperature compensation
-    float_sylph_t bias[N];
-    for(int i(0); i < N; i++){
-      bias[i] = info.bias_base[i] + (info.bias_tc[i] * bias_mod);
-    }
-
-    // Convert raw values to physical quantity by using scale factor
-    float_sylph_t tmp[N];
-    for(int i(0); i < N; i++){
-      tmp[i] = (((float_sylph_t)raw[i] - bias[i]) / info.sf[i]);
-    }
-
-    // Misalignment compensation
-    for(int i(0); i < N; i++){
-      res[i] = 0;
-      for(int j(0); j < N; j++){
-        res[i] += info.alignment[i][j] * tmp[j];
-      }
-    }
-  }
-
-  StandardCalibration() {}
-  ~StandardCalibration() {}
-
-  /**
-   * Get acceleration in m/s^2
-   */
-  Vector3<float_sylph_t> raw2accel(const int *raw_data) const{
-    float_sylph_t res[3];
-    calibrate(
-        &raw_data[index_base], raw_data[index_temp_ch],
-        accel, res);
-    return Vector3<float_sylph_t>(res[0], res[1], res[2]);
-  }
-
-  /**
-   * Get angular speed in rad/sec
-   */
-  Vector3<float_sylph_t> raw2omega(const int *raw_data) const{
-    float_sylph_t res[3];
-    calibrate(
-        &raw_data[index_base + 3], raw_data[index_temp_ch],
-        gyro, res);
-    return Vector3<float_sylph_t>(res[0], res[1], res[2]);
-  }
-
-  /**
-   * Accelerometer output variance in [m/s^2]^2
-   */
-  Vector3<float_sylph_t> sigma_accel() const{
-    return Vector3<float_sylph_t>(accel.sigma[0], accel.sigma[1], accel.sigma[2]);
-  }
-
-  /**
-   * Angular speed output variance in X, Y, Z axes, [rad/s]^2
-   */
-  Vector3<float_sylph_t> sigma_gyro() const{
-    return Vector3<float_sylph_t>(gyro.sigma[0], gyro.sigma[1], gyro.sigma[2]);
-  }
-};
-
 using namespace std;
 
 class StreamProcessor
@@ -1468,22 +1646,7 @@ class StreamProcessor
 
         previous_seek_next = A_Observer_t::ready();
 
-        { // NinjaScan default calibration parameters
-#define config(spec) calibration.check_spec(spec);
-          config("index_base 0");
-          config("index_temp_ch 8");
-          config("acc_bias 32768 32768 32768");
-          config("acc_bias_tc 0 0 0"); // No temperature compensation
-          config("acc_sf 4.1767576e+2 4.1767576e+2 4.1767576e+2"); // MPU-6000/9250 8[G] full scale; (1<<15)/(8*9.80665) [1/(m/s^2)]
-          config("acc_mis 1 0 0 0 1 0 0 0 1"); // No misalignment compensation
-          config("gyro_bias 32768 32768 32768");
-          config("gyro_bias_tc 0 0 0"); // No temperature compensation
-          config("gyro_sf 9.3873405e+2 9.3873405e+2 9.3873405e+2"); // MPU-6000/9250 2000[dps] full scale; (1<<15)/(2000/180*PI) [1/(rad/s)]
-          config("gyro_mis 1 0 0 0 1 0 0 0 1"); // No misalignment compensation
-          config("sigma_accel 0.05 0.05 0.05"); // approx. 150[mG] ? standard deviation
-          config("sigma_gyro 5e-3 5e-3 5e-3"); // approx. 0.3[dps] standard deviation
-#undef config
-        }
+        calibration.setup_default();
       }
       ~AHandler(){}
       void operator()(const A_Observer_t &observer){
@@ -1599,6 +1762,7 @@ class StreamProcessor
             G_Observer_t::solution_t solution(observer.fetch_solution());
             if(solution.status_flags & G_Observer_t::solution_t::WN_VALID){
               week_number = solution.week;
+              NAV::set_mag_epoch(week_number, observer.fetch_ITOW());
               if(status.time_stamp == status_t::TIME_STAMP_INVALID){
                 status.time_stamp = status_t::TIME_STAMP_BEFORE_START;
               }
@@ -1833,7 +1997,7 @@ class StreamProcessor
         char buf[1024];
         while(!in.eof()){
           in.getline(buf, sizeof(buf));
-          if(!buf[0]){continue;}
+          if((!buf[0]) || (buf[0] == '#')){continue;} // empty or comment line
           if(!a_handler.calibration.check_spec(buf)){
             cerr << "unknown_calib_param! : " << buf << endl;
             return false;
@@ -1876,6 +2040,7 @@ class INS_GPS_NAV<INS_GPS>::Helper {
       TIME_UPDATED,
       MEASUREMENT_UPDATED,
       WAITING_UPDATE,
+      SMOOTHED,
     } status;
     INS_GPS_NAV<INS_GPS> &nav;
     const int min_a_packets_for_init; // must be greater than 0
@@ -1954,6 +2119,22 @@ class INS_GPS_NAV<INS_GPS>::Helper {
       }
     }
 
+    /**
+     * @return (bool) true when the filter is initialized or updated with the last packet,
+     * where samples pending in an IMU block are not regarded as an update.
+     */
+    bool filter_updated() const {
+      switch(status){
+        case JUST_INITIALIZED:
+        case MEASUREMENT_UPDATED:
+          return true;
+        case TIME_UPDATED:
+          return !nav.time_update_pending();
+        default:
+          return false;
+      }
+    }
+
     void compass(const M_Packet &packet){
       recent_m.push(packet);
     }
@@ -1977,38 +2158,55 @@ class INS_GPS_NAV<INS_GPS>::Helper {
         case MEASUREMENT_UPDATED: {
           float_t itow(recent_a.buf.back().itow);
           typedef typename INS_GPS_Back_Propagate<Base_INS_GPS>::snapshots_t snapshots_t;
+          typedef typename INS_GPS_Back_Propagate<Base_INS_GPS>::restored_t restored_t;
           const snapshots_t &snapshots(ins_gps->get_snapshots());
-          int index(0);
-          for(typename snapshots_t::const_iterator it(snapshots.begin());
-              it != snapshots.end();
-              ++it, index++){
-            if(it->elapsedT_from_last_correct >= options.back_propagate_property.back_propagate_depth){
+          typename snapshots_t::size_type n(0);
+          for(; n < snapshots.size(); ++n){
+            if(snapshots[n].elapsedT_from_last_correct >= options.back_propagate_property.back_propagate_depth){
               break;
             }
+          }
+          if((!options.dump_update) && (n > 1)){n = 1;}
 
+          // INS/GPS is rebuilt from snapshots only for output
+          const restored_t &restored(ins_gps->restore_snapshots(n));
+          for(typename snapshots_t::size_type index(0); index < n; ++index){
             if(index == 0){
               if(!options.dump_correct){continue;}
-              it->ins_gps.set_header("BP_MU", t_stamp_generator(itow + it->elapsedT_from_last_correct));
-              res.push_back(&(it->ins_gps));
+              restored[index].set_header("BP_MU", t_stamp_generator(itow + snapshots[index].elapsedT_from_last_correct));
+              res.push_back(&restored[index]);
             }else{
-              if(!options.dump_update){continue;}
-              it->ins_gps.set_header("BP_TU",  t_stamp_generator(itow + it->elapsedT_from_last_correct));
-              res.push_back(&(it->ins_gps));
+              restored[index].set_header("BP_TU",  t_stamp_generator(itow + snapshots[index].elapsedT_from_last_correct));
+              res.push_back(&restored[index]);
             }
           }
           break;
         }
+        default:
+          break;
       }
 
       return res;
     }
 
+    template <class Base_INS_GPS>
+    NAV::updated_items_t updated_items(
+        const INS_GPS_RTS_Smoother<Base_INS_GPS> *ins_gps) const {
+      NAV::updated_items_t res;
+
+      // Only smoothed results are output after all packets are processed.
+      if(status == SMOOTHED){
+        res.push_back(nav.ins_gps);
+      }
+      return res;
+    }
+
     NAV::updated_items_t updated_items(void *) const {
       NAV::updated_items_t res;
 
       switch(status){
         case TIME_UPDATED:
-          if(!options.dump_update){break;}
+          if((!options.dump_update) || nav.time_update_pending()){break;}
           res.push_back(nav.ins_gps);
           break;
         case JUST_INITIALIZED:
@@ -2016,6 +2214,8 @@ class INS_GPS_NAV<INS_GPS>::Helper {
           if(!options.dump_correct){break;}
           res.push_back(nav.ins_gps);
           break;
+        default:
+          break;
       }
       return res;
     }
@@ -2025,6 +2225,37 @@ class INS_GPS_NAV<INS_GPS>::Helper {
       return updated_items(nav.ins_gps);
     }
 
+  protected:
+    bool finalize_1step(void *){
+      return false;
+    }
+
+    template <class Base_INS_GPS>
+    bool finalize_1step(INS_GPS_RTS_Smoother<Base_INS_GPS> *ins_gps){
+      if(status < JUST_INITIALIZED){return false;}
+      if(status != SMOOTHED){
+        cerr << "RTS smoothing: " << ins_gps->records() << " records" << endl;
+        ins_gps->smooth();
+        ins_gps->replay_begin();
+        status = SMOOTHED;
+      }
+      if(!ins_gps->replay_next()){return false;}
+      ins_gps->set_header("RTS", t_stamp_generator(ins_gps->time_tag()));
+      return true;
+    }
+
+    void tag_time(const float_t &itow, void *){}
+
+    template <class Base_INS_GPS>
+    void tag_time(const float_t &itow, INS_GPS_RTS_Smoother<Base_INS_GPS> *ins_gps){
+      ins_gps->set_time_tag(itow);
+    }
+
+  public:
+    bool finalize_1step(){
+      return finalize_1step(nav.ins_gps);
+    }
+
   protected:
     void time_update(const A_Packet &a_packet, float_t deltaT){
 
@@ -2059,6 +2290,7 @@ class INS_GPS_NAV<INS_GPS>::Helper {
         float_t deltaT(previous.interval(a_packet));
         time_update(a_packet, deltaT);
         nav.ins_gps->set_header("TU",  t_stamp_generator(a_packet.itow));
+        tag_time(a_packet.itow, nav.ins_gps);
       }
 
       recent_a.push(a_packet);
@@ -2133,6 +2365,7 @@ class INS_GPS_NAV<INS_GPS>::Helper {
       nav.ins_gps->initPosition(latitude, longitude, height);
       nav.ins_gps->initVelocity(v_north, v_east, v_down);
       nav.ins_gps->initAttitude(yaw, pitch, roll);
+      tag_time(itow, nav.ins_gps);
 
       for(char buf[0x4000]; !options.init_misc->eof(); ){ // Miscellaneous setup
         options.init_misc->getline(buf, sizeof(buf));
@@ -2226,6 +2459,10 @@ class NAV_Generator {
     }
     template <class T>
     static NAV *check_udkf(){
+      if(options.mixed_precision){
+        return check_bias<typename T::template kf<
+            KalmanFilterMixedPrecision<KalmanFilterUD, float>::filter_t> >();
+      }
       return options.use_udkf
           ? check_bias<typename T::template kf<KalmanFilterUD> >()
           : check_bias<typename T::template kf<KalmanFilter> >();
@@ -2265,44 +2502,49 @@ void loop(){
     // Realtime mode supports only one stream.
     proc.update_target() = nav_manager.nav;
     while(proc.process_1page());
+    nav_manager.nav->finalize();
     return;
   }
 
-  struct buffer_t : public Updatable {
-    typedef deque<const Packet *> packet_pool_t;
-    packet_pool_t packet_pool;
-    NAV &nav;
-    void sort_and_apply(int packets){
-      stable_sort(packet_pool.begin(), packet_pool.end(), Packet::compare_rollover);
-      while(packets-- > 0){
-        packet_pool_t::reference front(packet_pool.front());
-        front->apply(nav);
-        delete front;
-        packet_pool.pop_front();
+  { // Sort packets in order of time before applying them
+    struct buffer_t : public Updatable {
+      typedef deque<const Packet *> packet_pool_t;
+      packet_pool_t packet_pool;
+      NAV &nav;
+      void sort_and_apply(int packets){
+        stable_sort(packet_pool.begin(), packet_pool.end(), Packet::compare_rollover);
+        while(packets-- > 0){
+          packet_pool_t::reference front(packet_pool.front());
+          front->apply(nav);
+          delete front;
+          packet_pool.pop_front();
+        }
+      }
+      void sort_and_apply2 () {
+        if(packet_pool.size() < 0x200){return;}
+        sort_and_apply(0x100);
+      }
+      buffer_t(NAV &_nav) : packet_pool(), nav(_nav) {}
+      ~buffer_t() {
+        sort_and_apply(packet_pool.size());
       }
-    }
-    void sort_and_apply2 () {
-      if(packet_pool.size() < 0x200){return;}
-      sort_and_apply(0x100);
-    }
-    buffer_t(NAV &_nav) : packet_pool(), nav(_nav) {}
-    ~buffer_t() {
-      sort_and_apply(packet_pool.size());
-    }
 #define update_func(type) \
 virtual void update(const type &packet){ \
   packet_pool.push_back(new type(packet)); \
   sort_and_apply2(); \
 }
-    update_func(A_Packet);
-    update_func(G_Packet);
-    update_func(M_Packet);
-    update_func(TimePacket);
+      update_func(A_Packet);
+      update_func(G_Packet);
+      update_func(M_Packet);
+      update_func(TimePacket);
 #undef update_func
-  } buffer(*nav_manager.nav);
-  proc.update_target() = &buffer;
+    } buffer(*nav_manager.nav);
+    proc.update_target() = &buffer;
 
-  while(proc.process_1page());
+    while(proc.process_1page());
+  } // The rest of packets are applied by the destructor of the buffer.
+
+  nav_manager.nav->finalize();
 }
 
 int main(int argc, char *argv[]){
@@ -2390,8 +2632,27 @@ int main(int argc, char *argv[]){
     options.out() << setprecision(10);
   }
   options.out_debug() << setprecision(16);
+  if(options.debug_binary){
+    switch(options.debug_property.debug_target){
+      case INS_GPS_Debug_Property::DEBUG_KF_P:
+        options.debug_dump.open(options.out_debug(), 0, options.debug_interval);
+        break;
+      case INS_GPS_Debug_Property::DEBUG_KF_FULL:
+        options.debug_dump.open(options.out_debug(),
+            INS_GPS_Debug_Dump_Format::CONTENT_PHI
+              | INS_GPS_Debug_Dump_Format::CONTENT_K
+              | INS_GPS_Debug_Dump_Format::CONTENT_RESIDUAL,
+            options.debug_interval);
+        break;
+      default:
+        cerr << "(error!) --debug_binary requires --debug=<KF_P|KF_FULL>." << endl;
+        exit(-1);
+    }
+  }
 
   loop();
 
+  options.debug_dump.flush();
+
   return 0;
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __MS5611_H__
+#define __MS5611_H__
+
+/** @file
+ * @brief Conversion of MS5611 barometric pressure sensor outputs
+ */
+
+#include <cmath>
+
+#include "std.h"
+
+struct MS5611 {
+  /**
+   * Compensation (Figures 2 and 3 of the datasheet) for an array of samples.
+   * The second order compensation is performed without branches
+   * so that the loop can be vectorized with 64-bit integer lanes.
+   *
+   * @param coef PROM coefficients C1-C6
+   * @param n number of samples
+   * @param d1 digital pressure values
+   * @param d2 digital temperature values
+   * @param pressure (output) compensated pressure [Pa]
+   * @param temperature (output) compensated temperature [0.01 degC]
+   */
+  static void convert(
+      const Uint16 (&coef)[6], const int &n,
+      const Uint32 *d1, const Uint32 *d2,
+      Int32 *pressure, Int32 *temperature){
+    const int64_t c1(coef[0]), c2(coef[1]), c3(coef[2]), c4(coef[3]),
+        t_ref((int64_t)coef[4] << 8), c6(coef[5]);
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+    for(int i = 0; i < n; ++i){
+      int64_t dT((int64_t)d2[i] - t_ref);
+      int64_t temp(2000 + ((dT * c6) >> 23));
+      int64_t off((c2 << 16) + ((c4 * dT) >> 7));
+      int64_t sens((c1 << 15) + ((c3 * dT) >> 8));
+
+      // Figure 3
+      int64_t low(temp < 2000), very_low(temp < -1500);
+      int64_t dT2(temp - 2000), dT2_2(dT2 * dT2);
+      int64_t dT3(temp + 1500), dT3_2(dT3 * dT3);
+      int64_t t2(low * ((dT * dT) >> 31));
+      int64_t off2(low * (((dT2_2 * 5) >> 1) + very_low * (dT3_2 * 7)));
+      int64_t sens2(low * (((dT2_2 * 5) >> 2) + very_low * ((dT3_2 * 11) >> 1)));
+
+      temperature[i] = (Int32)(temp - t2);
+      pressure[i] = (Int32)(((((int64_t)d1[i] * (sens - sens2)) >> 21) - (off - off2)) >> 15);
+    }
+  }
+
+  /**
+   * Barometric altitude of the standard atmosphere
+   *
+   * @param pressure [Pa]
+   * @param pressure_sea_level [Pa]
+   * @return altitude [m]
+   */
+  template <class FloatT>
+  static FloatT altitude(const FloatT &pressure, const FloatT &pressure_sea_level){
+    return 44330.77 * (1. - std::pow(pressure / pressure_sea_level, 0.190263));
+  }
+};
+
+#endif /* __MS5611_H__ */
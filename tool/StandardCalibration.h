@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __STANDARD_CALIBRATION_H__
+#define __STANDARD_CALIBRATION_H__
+
+/** @file
+ * @brief Calibration of NinjaScan IMU outputs shared among tools
+ *
+ * float_sylph_t must be defined before inclusion.
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include "param/vector3.h"
+#include "analyze_common.h"
+
+struct StandardCalibration {
+
+  int index_base, index_temp_ch;
+  template <std::size_t N>
+  struct calibration_info_t {
+    float_sylph_t bias_tc[N];
+    float_sylph_t bias_base[N];
+    float_sylph_t sf[N];
+    float_sylph_t alignment[N][N];
+    float_sylph_t sigma[N];
+    static void set(char *spec, float_sylph_t target[N]){
+      for(int i(0); i < N; i++){
+        target[i] = std::strtod(spec, &spec);
+      }
+    }
+    static void set(char *spec, float_sylph_t target[N][N]){
+      for(int i(0); i < N; i++){
+        for(int j(0); j < N; j++){
+          target[i][j] = std::strtod(spec, &spec);
+        }
+      }
+    }
+    static std::ostream &dump(std::ostream &out, const float_sylph_t target[N]){
+      for(int i(0); i < N; i++){
+        out << " " << target[i];
+      }
+      return out;
+    }
+    static std::ostream &dump(std::ostream &out, const float_sylph_t target[N][N]){
+      for(int i(0); i < N; i++){
+        for(int j(0); j < N; j++){
+          out << " " << target[i][j];
+        }
+      }
+      return out;
+    }
+  };
+  typedef calibration_info_t<3> dof3_t;
+  dof3_t accel, gyro;
+
+  /**
+   * Calibration compiled into an affine transform
+   * @f[
+   *    \vec{y} = M \vec{x}_{\mathrm{raw}} - \left( \vec{c}_{0} + \vec{c}_{1} T \right),
+   * @f]
+   * where @f$ M = A S^{-1} @f$, @f$ \vec{c}_{0} = M \vec{b}_{\mathrm{base}} @f$,
+   * @f$ \vec{c}_{1} = M \vec{b}_{\mathrm{tc}} @f$, and @f$ T @f$ is the temperature channel.
+   */
+  template <std::size_t N>
+  struct compiled_t {
+    float_sylph_t matrix[N][N];
+    float_sylph_t offset_base[N];
+    float_sylph_t offset_tc[N];
+    void compile(const calibration_info_t<N> &info){
+      for(int i(0); i < N; i++){
+        offset_base[i] = offset_tc[i] = 0;
+        for(int j(0); j < N; j++){
+          matrix[i][j] = info.alignment[i][j] / info.sf[j];
+          offset_base[i] += matrix[i][j] * info.bias_base[j];
+          offset_tc[i] += matrix[i][j] * info.bias_tc[j];
+        }
+      }
+    }
+  };
+  compiled_t<3> accel_compiled, gyro_compiled;
+  /**
+   * If true, conversion follows the step-by-step reference calculation, calibrate(),
+   * whose results are bitwise reproducible; otherwise, the compiled transform is used,
+   * whose results differ in rounding errors.
+   */
+  bool strict;
+
+  /**
+   * Compile the current parameters, which is invoked whenever they are changed by check_spec().
+   */
+  void compile(){
+    accel_compiled.compile(accel);
+    gyro_compiled.compile(gyro);
+  }
+
+  bool check_spec(const char *line){
+    bool res(check_spec_raw(line));
+    if(res){compile();}
+    return res;
+  }
+
+protected:
+  bool check_spec_raw(const char *line){
+    const char *value;
+    if(value = GlobalOptions<float_sylph_t>::get_value2(line, "index_base")){
+      index_base = std::atoi(value);
+      return true;
+    }
+    if(value = GlobalOptions<float_sylph_t>::get_value2(line, "index_temp_ch")){
+      index_temp_ch = std::atoi(value);
+      return true;
+    }
+    if(value = GlobalOptions<float_sylph_t>::get_value2(line, "strict")){
+      strict = GlobalOptions<float_sylph_t>::is_true(value);
+      return true;
+    }
+#define TO_STRING(name) # name
+#define check_proc(name, sensor, item) \
+if(value = GlobalOptions<float_sylph_t>::get_value2(line, TO_STRING(name))){ \
+  dof3_t::set(const_cast<char *>(value), sensor.item); \
+  return true; \
+}
+    check_proc(acc_bias_tc, accel, bias_tc);
+    check_proc(acc_bias, accel, bias_base);
+    check_proc(acc_sf, accel, sf);
+    check_proc(acc_mis, accel, alignment);
+    check_proc(gyro_bias_tc, gyro, bias_tc);
+    check_proc(gyro_bias, gyro, bias_base);
+    check_proc(gyro_sf, gyro, sf);
+    check_proc(gyro_mis, gyro, alignment);
+    check_proc(sigma_accel, accel, sigma);
+    check_proc(sigma_gyro, gyro, sigma);
+#undef check_proc
+#undef TO_STRING
+
+    return false;
+  }
+
+public:
+  friend std::ostream &operator<<(
+      std::ostream &out, const StandardCalibration &calib){
+    out << "index_base " << calib.index_base << std::endl;
+    out << "index_temp_ch " << calib.index_temp_ch << std::endl;
+    out << "strict " << (calib.strict ? "on" : "off") << std::endl;
+#define TO_STRING(name) # name
+#define dump_proc(name, sensor, item) \
+  out << TO_STRING(name); \
+  dof3_t::dump(out, calib.sensor.item)
+    dump_proc(acc_bias_tc, accel, bias_tc) << std::endl;
+    dump_proc(acc_bias, accel, bias_base) << std::endl;
+    dump_proc(acc_sf, accel, sf) << std::endl;
+    dump_proc(acc_mis, accel, alignment) << std::endl;
+    dump_proc(gyro_bias_tc, gyro, bias_tc) << std::endl;
+    dump_proc(gyro_bias, gyro, bias_base) << std::endl;
+    dump_proc(gyro_sf, gyro, sf) << std::endl;
+    dump_proc(gyro_mis, gyro, alignment) << std::endl;
+    dump_proc(sigma_accel, accel, sigma) << std::endl;
+    dump_proc(sigma_gyro, gyro, sigma);
+#undef dump_proc
+#undef TO_STRING
+    return out;
+  }
+
+  template <class NumType, std::size_t N>
+  static void calibrate(
+      const NumType raw[],
+      const NumType &bias_mod,
+      const calibration_info_t<N> &info,
+      float_sylph_t (&res)[N]) {
+
+    // Temperature compensation
+    float_sylph_t bias[N];
+    for(int i(0); i < N; i++){
+      bias[i] = info.bias_base[i] + (info.bias_tc[i] * bias_mod);
+    }
+
+    // Convert raw values to physical quantity by using scale factor
+    float_sylph_t tmp[N];
+    for(int i(0); i < N; i++){
+      tmp[i] = (((float_sylph_t)raw[i] - bias[i]) / info.sf[i]);
+    }
+
+    // Misalignment compensation
+    for(int i(0); i < N; i++){
+      res[i] = 0;
+      for(int j(0); j < N; j++){
+        res[i] += info.alignment[i][j] * tmp[j];
+      }
+    }
+  }
+
+  template <class NumType, std::size_t N>
+  static void calibrate(
+      const NumType raw[],
+      const NumType &bias_mod,
+      const compiled_t<N> &compiled,
+      float_sylph_t (&res)[N]) {
+    for(int i(0); i < N; i++){
+      res[i] = -(compiled.offset_base[i] + (compiled.offset_tc[i] * bias_mod));
+      for(int j(0); j < N; j++){
+        res[i] += compiled.matrix[i][j] * raw[j];
+      }
+    }
+  }
+
+  /**
+   * Convert multiple records at once.
+   *
+   * @param raw_data the first record, each of which consists of channels
+   * @param stride number of channels per record
+   * @param offset index of the first channel of the sensor in a record
+   * @param n number of records
+   * @param info parameters used in strict mode
+   * @param compiled parameters used otherwise
+   * @param res (output) converted values
+   */
+  void calibrate_batch(
+      const int *raw_data, const std::size_t &stride, const int &offset, const std::size_t &n,
+      const dof3_t &info, const compiled_t<3> &compiled,
+      float_sylph_t (*res)[3]) const {
+    if(strict){
+      for(std::size_t k(0); k < n; ++k){
+        const int *raw(&raw_data[stride * k]);
+        calibrate(&raw[offset], raw[index_temp_ch], info, res[k]);
+      }
+      return;
+    }
+    const float_sylph_t
+        m00(compiled.matrix[0][0]), m01(compiled.matrix[0][1]), m02(compiled.matrix[0][2]),
+        m10(compiled.matrix[1][0]), m11(compiled.matrix[1][1]), m12(compiled.matrix[1][2]),
+        m20(compiled.matrix[2][0]), m21(compiled.matrix[2][1]), m22(compiled.matrix[2][2]),
+        c00(compiled.offset_base[0]), c01(compiled.offset_base[1]), c02(compiled.offset_base[2]),
+        c10(compiled.offset_tc[0]), c11(compiled.offset_tc[1]), c12(compiled.offset_tc[2]);
+    const int ch_temp(index_temp_ch);
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+    for(std::size_t k = 0; k < n; ++k){
+      const int *raw(&raw_data[stride * k]);
+      float_sylph_t x((float_sylph_t)raw[offset]),
+          y((float_sylph_t)raw[offset + 1]),
+          z((float_sylph_t)raw[offset + 2]),
+          t((float_sylph_t)raw[ch_temp]);
+      res[k][0] = m00 * x + m01 * y + m02 * z - (c00 + c10 * t);
+      res[k][1] = m10 * x + m11 * y + m12 * z - (c01 + c11 * t);
+      res[k][2] = m20 * x + m21 * y + m22 * z - (c02 + c12 * t);
+    }
+  }
+
+  StandardCalibration() : index_base(0), index_temp_ch(0), strict(false) {}
+  ~StandardCalibration() {}
+
+  /**
+   * Set NinjaScan default calibration parameters
+   */
+  void setup_default(){
+#define config(spec) check_spec(spec);
+    config("index_base 0");
+    config("index_temp_ch 8");
+    config("acc_bias 32768 32768 32768");
+    config("acc_bias_tc 0 0 0"); // No temperature compensation
+    config("acc_sf 4.1767576e+2 4.1767576e+2 4.1767576e+2"); // MPU-6000/9250 8[G] full scale; (1<<15)/(8*9.80665) [1/(m/s^2)]
+    config("acc_mis 1 0 0 0 1 0 0 0 1"); // No misalignment compensation
+    config("gyro_bias 32768 32768 32768");
+    config("gyro_bias_tc 0 0 0"); // No temperature compensation
+    config("gyro_sf 9.3873405e+2 9.3873405e+2 9.3873405e+2"); // MPU-6000/9250 2000[dps] full scale; (1<<15)/(2000/180*PI) [1/(rad/s)]
+    config("gyro_mis 1 0 0 0 1 0 0 0 1"); // No misalignment compensation
+    config("sigma_accel 0.05 0.05 0.05"); // approx. 150[mG] ? standard deviation
+    config("sigma_gyro 5e-3 5e-3 5e-3"); // approx. 0.3[dps] standard deviation
+#undef config
+  }
+
+  /**
+   * Get acceleration in m/s^2
+   */
+  Vector3<float_sylph_t> raw2accel(const int *raw_data) const{
+    float_sylph_t res[3];
+    if(strict){
+      calibrate(
+          &raw_data[index_base], raw_data[index_temp_ch],
+          accel, res);
+    }else{
+      calibrate(
+          &raw_data[index_base], raw_data[index_temp_ch],
+          accel_compiled, res);
+    }
+    return Vector3<float_sylph_t>(res[0], res[1], res[2]);
+  }
+
+  /**
+   * Get angular speed in rad/sec
+   */
+  Vector3<float_sylph_t> raw2omega(const int *raw_data) const{
+    float_sylph_t res[3];
+    if(strict){
+      calibrate(
+          &raw_data[index_base + 3], raw_data[index_temp_ch],
+          gyro, res);
+    }else{
+      calibrate(
+          &raw_data[index_base + 3], raw_data[index_temp_ch],
+          gyro_compiled, res);
+    }
+    return Vector3<float_sylph_t>(res[0], res[1], res[2]);
+  }
+
+  /**
+   * Get acceleration in m/s^2 of multiple records
+   *
+   * @param raw_data the first record
+   * @param n number of records
+   * @param res (output) acceleration
+   * @param stride number of channels per record
+   */
+  void raw2accel(const int *raw_data, const std::size_t &n, float_sylph_t (*res)[3],
+      const std::size_t &stride = 9) const {
+    calibrate_batch(raw_data, stride, index_base, n, accel, accel_compiled, res);
+  }
+
+  /**
+   * Get angular speed in rad/sec of multiple records
+   *
+   * @param raw_data the first record
+   * @param n number of records
+   * @param res (output) angular speed
+   * @param stride number of channels per record
+   */
+  void raw2omega(const int *raw_data, const std::size_t &n, float_sylph_t (*res)[3],
+      const std::size_t &stride = 9) const {
+    calibrate_batch(raw_data, stride, index_base + 3, n, gyro, gyro_compiled, res);
+  }
+
+  /**
+   * Accelerometer output variance in [m/s^2]^2
+   */
+  Vector3<float_sylph_t> sigma_accel() const{
+    return Vector3<float_sylph_t>(accel.sigma[0], accel.sigma[1], accel.sigma[2]);
+  }
+
+  /**
+   * Angular speed output variance in X, Y, Z axes, [rad/s]^2
+   */
+  Vector3<float_sylph_t> sigma_gyro() const{
+    return Vector3<float_sylph_t>(gyro.sigma[0], gyro.sigma[1], gyro.sigma[2]);
+  }
+};
+
+#endif /* __STANDARD_CALIBRATION_H__ */
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __ALLAN_VARIANCE_H__
+#define __ALLAN_VARIANCE_H__
+
+/** @file
+ * @brief Streaming calculation of overlapping Allan variance
+ */
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Overlapping Allan variance of a rate signal calculated in a single pass
+ *
+ * Cluster sizes are octave-spaced, i.e., m = 1, 2, 4, ..., m_max.
+ * With the cumulative sum @f$ x_{k} = \sum_{i < k} y_{i} @f$ of samples @f$ y_{i} @f$,
+ * the overlapping Allan variance of cluster size m is
+ * @f[
+ *    \sigma^{2}(m \tau_{0}) = \frac{1}{2 m^{2} (n - 2m + 1)}
+ *      \sum_{k = 2m}^{n} \left( x_{k} - 2 x_{k - m} + x_{k - 2m} \right)^{2},
+ * @f]
+ * where n is the number of samples. Each sample updates all cluster sizes
+ * in O(log(m_max)), and the memory is bounded by a ring buffer of the last 2 m_max
+ * cumulative sums, regardless of the number of samples.
+ * The first sample is subtracted from all samples before summation,
+ * which does not change the variance, in order to keep the precision
+ * of the cumulative sum in a long log.
+ *
+ * @param FloatT precision
+ */
+template <class FloatT = double>
+class AllanVariance {
+  public:
+    typedef FloatT float_t;
+  protected:
+    std::vector<float_t> history; ///< ring buffer of cumulative sums
+    float_t offset, x, sum2_total;
+    unsigned long n; ///< number of samples
+    struct cluster_t {
+      unsigned long m;
+      float_t sum2;
+      unsigned long terms;
+    };
+    std::vector<cluster_t> clusters;
+
+    const float_t &history_at(const unsigned long &k) const {
+      return history[k % history.size()];
+    }
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param m_max maximum cluster size; the largest power of 2 not exceeding it is used.
+     */
+    AllanVariance(const unsigned long &m_max)
+        : history(), offset(0), x(0), sum2_total(0), n(0), clusters() {
+      cluster_t c = {1, 0, 0};
+      while(c.m <= m_max){
+        clusters.push_back(c);
+        if(c.m > m_max / 2){break;}
+        c.m <<= 1;
+      }
+      history.resize((clusters.empty() ? 0 : clusters.back().m * 2) + 1);
+      history[0] = 0;
+    }
+
+    /**
+     * Add a sample.
+     *
+     * @param y sample
+     */
+    void add(const float_t &y){
+      if(n == 0){offset = y;}
+      float_t dy(y - offset);
+      x += dy;
+      sum2_total += dy * dy;
+      history[(++n) % history.size()] = x;
+      for(typename std::vector<cluster_t>::iterator it(clusters.begin());
+          it != clusters.end(); ++it){
+        if(it->m * 2 > n){break;}
+        float_t d(x - history_at(n - it->m) * 2 + history_at(n - it->m * 2));
+        it->sum2 += d * d;
+        ++(it->terms);
+      }
+    }
+
+    /**
+     * Add samples.
+     *
+     * @param y the first sample
+     * @param count number of samples
+     * @param stride interval of samples in the array
+     */
+    void add(const float_t *y, const unsigned long &count, const unsigned long &stride = 1){
+      for(unsigned long i(0); i < count; ++i, y += stride){
+        add(*y);
+      }
+    }
+
+    unsigned long samples() const {return n;}
+    float_t mean() const {return n ? (x / n + offset) : 0;}
+    float_t variance() const {
+      return (n > 1) ? ((sum2_total - x * x / n) / (n - 1)) : 0;
+    }
+
+    /**
+     * @return (int) number of cluster sizes having at least one term
+     */
+    int clusters_available() const {
+      int res(0);
+      for(; (res < (int)clusters.size()) && (clusters[res].terms > 0); ++res);
+      return res;
+    }
+
+    /**
+     * @param i index of cluster size, i.e., m = 2^i
+     * @return (unsigned long) cluster size
+     */
+    unsigned long cluster_size(const int &i) const {return clusters[i].m;}
+
+    /**
+     * @param i index of cluster size, i.e., m = 2^i
+     * @return (float_t) Allan deviation in the unit of the samples
+     */
+    float_t deviation(const int &i) const {
+      const cluster_t &c(clusters[i]);
+      if(c.terms == 0){return 0;}
+      return std::sqrt(c.sum2 / (2 * c.terms) / ((float_t)c.m * c.m));
+    }
+};
+
+#endif /* __ALLAN_VARIANCE_H__ */
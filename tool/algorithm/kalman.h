@@ -32,6 +32,8 @@
 #ifndef __KALMAN_H__
 #define __KALMAN_H__
 
+#include <vector>
+
 #include "param/matrix.h"
 
 /** @file
@@ -188,6 +190,15 @@ class KalmanFilter{
      */
     virtual const Matrix<FloatT> &getP() const {return m_P;}
 
+    /**
+     * Return an element of @f$ P @f$.
+     *
+     * @param i row index
+     * @param j column index
+     * @return (FloatT) @f$ P_{ij} @f$
+     */
+    virtual FloatT getP(const unsigned int &i, const unsigned int &j) const {return m_P(i, j);}
+
     /**
      * 덷Us@f$ P @f$ݒ肵܂B
      *
@@ -252,6 +263,10 @@ class InformationFilter : public KalmanFilter<FloatT>{
       return KalmanFilter<FloatT>::m_P;
     }
 
+    FloatT getP(const unsigned int &i, const unsigned int &j) const {
+      return getP()(i, j);
+    }
+
     /**
      * 덷Us@f$ P @f$ݒ肵܂B
      *
@@ -382,219 +397,275 @@ class InformationFilter : public KalmanFilter<FloatT>{
 template <class FloatT>
 class KalmanFilterUD : public KalmanFilter<FloatT>{
   protected:
-    Matrix<FloatT> m_U, m_D;
+    typedef KalmanFilter<FloatT> super_t;
+
+    /**
+     * Factors of @f$ P = U D U^{T} @f$.
+     * The strictly upper triangular part of the unit upper triangular matrix @f$ U @f$
+     * is packed in column-major order, i.e., @f$ U_{ij} (i < j) @f$ is located at
+     * @f$ j (j - 1) / 2 + i @f$, and the diagonal matrix @f$ D @f$ is stored as a vector.
+     */
+    unsigned int m_n;
+    std::vector<FloatT> m_U, m_D;
+    std::vector<FloatT> m_work; ///< work space for time update, reused
+    mutable std::vector<FloatT> m_P_diag; ///< cache of the diagonal of @f$ P @f$
     bool need_update_P;
-    
+    mutable bool need_update_P_diag;
+
+    static unsigned int u_index(const unsigned int &i, const unsigned int &j){
+      return ((j * (j - 1)) >> 1) + i;
+    }
+    FloatT &u(const unsigned int &i, const unsigned int &j){
+      return m_U[u_index(i, j)];
+    }
+    const FloatT &u(const unsigned int &i, const unsigned int &j) const {
+      return m_U[u_index(i, j)];
+    }
+
     /**
-     * 덷Us@f$ P @f$XV܂B
-     * @f$ P @f$UDs񂩂@f$ P @f$𕜌Ă܂B
-     * sƂɂătB^[̐ۂ܂B
-     * 
+     * Reconstruct @f$ P @f$ from the factors.
+     * Because the reconstruction costs @f$ O(n^{3}) @f$, this is performed only when
+     * the whole @f$ P @f$ is explicitly requested by getP().
      */
     void updateP(){
       if(!need_update_P){return;}
-      //PXV
-      KalmanFilter<FloatT>::m_P = m_U * m_D * m_U.transpose();
+      Matrix<FloatT> P(Matrix<FloatT>::blank(m_n, m_n));
+      for(unsigned int i(0); i < m_n; ++i){
+        for(unsigned int j(i); j < m_n; ++j){
+          P(i, j) = P(j, i) = getP(i, j);
+        }
+      }
+      super_t::m_P = P;
       need_update_P = false;
 #if DEBUG
-      std::cerr << "P:" << KalmanFilter<FloatT>::m_P << std::endl;
+      std::cerr << "P:" << super_t::m_P << std::endl;
 #endif
     }
-    
+
+    void invalidate_P(){
+      need_update_P = true;
+      need_update_P_diag = true;
+    }
+
   public:
     /**
-     * 덷Us@f$ P @f$Ԃ܂B
-     * 
-     * @return (Matrix<FloatT>) ݂@f$ P @f$s
+     * Return @f$ P @f$, which is reconstructed from the factors if needed.
+     *
+     * @return (Matrix<FloatT>) current @f$ P @f$
      */
     const Matrix<FloatT> &getP(){
-      const_cast<KalmanFilterUD *>(this)->updateP();
-        return KalmanFilter<FloatT>::m_P;
+      updateP();
+      return super_t::m_P;
     }
 
     /**
-     * 덷Us@f$ P @f$ݒ肵܂B
-     * Iɂ͌덷Us@f$ P @f$UDsǍvZɔ܂B
+     * Return an element of @f$ P @f$ without reconstruction of the whole @f$ P @f$,
+     * @f$ P_{ij} = \sum_{k \ge \max(i, j)} U_{ik} D_{k} U_{jk} @f$.
+     * Diagonal elements are returned from the cache.
      *
-     * @param P V@f$ P @f$s
+     * @param i row index
+     * @param j column index
+     * @return (FloatT) @f$ P_{ij} @f$
      */
-    void setP(const Matrix<FloatT> &P){
-      m_U = Matrix<FloatT>(P.rows(), P.columns());
-      m_D = Matrix<FloatT>(P.rows(), P.columns());
+    FloatT getP(const unsigned int &i, const unsigned int &j) const {
+      if(i == j){
+        if(need_update_P_diag){
+          for(unsigned int k(0); k < m_n; ++k){
+            FloatT v(m_D[k]);
+            for(unsigned int l(k + 1); l < m_n; ++l){
+              v += u(k, l) * u(k, l) * m_D[l];
+            }
+            m_P_diag[k] = v;
+          }
+          need_update_P_diag = false;
+        }
+        return m_P_diag[i];
+      }
+      const unsigned int &i_min(i < j ? i : j), &i_max(i < j ? j : i);
+      FloatT v(u(i_min, i_max) * m_D[i_max]);
+      for(unsigned int k(i_max + 1); k < m_n; ++k){
+        v += u(i_min, k) * u(i_max, k) * m_D[k];
+      }
+      return v;
+    }
 
-      // UD
-      Matrix<FloatT> UD(P.decomposeUD(false));
+    /**
+     * Set @f$ P @f$, which is internally factorized into @f$ U @f$ and @f$ D @f$.
+     *
+     * @param P new @f$ P @f$
+     */
+    void setP(const Matrix<FloatT> &P){
+      m_n = P.rows();
+      m_U.assign((m_n * (m_n - 1)) >> 1, FloatT(0));
+      m_D.assign(m_n, FloatT(0));
+      m_P_diag.resize(m_n);
 
-      for(int i = 0; i < m_U.rows(); i++){
-        m_D(i, i) = UD(i, i + m_U.columns());
-        for(int j = 0; j < m_U.columns(); j++){
-          m_U(i, j) = UD(i, j);
+      // UD factorization, column by column from the last
+      for(int j(m_n - 1); j >= 0; --j){
+        FloatT d(P(j, j));
+        for(unsigned int k(j + 1); k < m_n; ++k){
+          d -= m_D[k] * u(j, k) * u(j, k);
+        }
+        m_D[j] = d;
+        for(int i(0); i < j; ++i){
+          FloatT v(P(i, j));
+          for(unsigned int k(j + 1); k < m_n; ++k){
+            v -= m_D[k] * u(i, k) * u(j, k);
+          }
+          u(i, j) = (d != 0) ? (v / d) : FloatT(0);
         }
       }
+      invalidate_P();
 #if DEBUG
-      std::cerr << "U:" << m_U << std::endl;
-      std::cerr << "D:" << m_D << std::endl;
+      std::cerr << "U:" << getU() << std::endl;
+      std::cerr << "D:" << getD() << std::endl;
 #endif
     }
-  
+
     /**
-     * UDKalmanFilter̃RXgN^B
-     * 덷Us@f$ P @f$, @f$ Q @f$w肷Kv܂B
-     * 
-     * @param P @f$ P @f$s
-     * @param Q @f$ Q @f$s
+     * UD factorized Kalman filter constructor.
+     *
+     * @param P @f$ P @f$
+     * @param Q @f$ Q @f$
      */
     KalmanFilterUD(const Matrix<FloatT> &P,
                    const Matrix<FloatT> &Q)
-        : KalmanFilter<FloatT>(P, Q), m_U(), m_D(), need_update_P(false){
+        : super_t(P, Q), m_n(0), m_U(), m_D(), m_work(), m_P_diag(),
+        need_update_P(false), need_update_P_diag(true){
       setP(P);
+      need_update_P = false;
     }
-    
+
     /**
-     * Rs[RXgN^
-     * 
-     * @param orig Rs[
-     * @param deepcopy fB[vRs[쐬邩ǂ
+     * Copy constructor.
+     * The factors are always copied, because they are held in value.
+     *
+     * @param orig original
+     * @param deepcopy if true, deep copy will be made
      */
     KalmanFilterUD(const KalmanFilterUD &orig, const bool &deepcopy = false) :
-      KalmanFilter<FloatT>(orig, deepcopy),
-      m_U(deepcopy ? orig.m_U.copy() : orig.m_U), 
-      m_D(deepcopy ? orig.m_D.copy() : orig.m_D),
-      need_update_P(orig.need_update_P){
-      //std::cerr << "KFUD" << std::endl;
+      super_t(orig, deepcopy),
+      m_n(orig.m_n),
+      m_U(orig.m_U), m_D(orig.m_D), m_work(), m_P_diag(orig.m_P_diag),
+      need_update_P(orig.need_update_P), need_update_P_diag(orig.need_update_P_diag){
     }
-    
+
     /**
-     * KalmanFilter̃fXgN^B
-     * 
+     * Destructor
      */
     ~KalmanFilterUD(){}
-    
-    using KalmanFilter<FloatT>::predict;
+
+    using super_t::predict;
 
     /**
-     * tB^[ԍXV܂B
-     * IUDpĂ܂B
-     * Uno[W
-     * @f[
-     *   x_{k+1} = \Phi_{k+1,K} * x_{k} + \Gamma_{k} * u_{k}
-     * @f]
-     * 
-     * @param Phi @f$ \Phi @f$s
-     * @param Gamma @f$ \Gamma @f$s
+     * Time update with the Thornton's modified weighted Gram-Schmidt (MWGS) method.
+     * @f$ U D U^{T} \leftarrow \Phi U D U^{T} \Phi^{T} + \Gamma Q \Gamma^{T} @f$
+     * is calculated in place on the factors; @f$ Q @f$ is assumed to be diagonal.
+     *
+     * @param Phi @f$ \Phi @f$
+     * @param Gamma @f$ \Gamma @f$
      */
     void predict(const Matrix<FloatT> &Phi, const Matrix<FloatT> &Gamma){
-     
-#if DEBUG     
-      KalmanFilter<FloatT>::predict(Phi, Gamma);
-      std::cerr << "predict_KF_P:" << KalmanFilter<FloatT>::m_P << std::endl;
-#endif
+      const unsigned int n(m_n), q(Gamma.columns()), w(n + q);
+      m_work.resize(n * w + w);
+      FloatT *W(&m_work[0]), *Dw(&m_work[n * w]);
 
-      // sFU
-      Matrix<FloatT> FU(Phi * m_U);
-      
-      // sW
-      Matrix<FloatT> W(Phi.rows(), KalmanFilter<FloatT>::m_P.columns() + Gamma.columns());
-      W.pivotMerge(0, 0, FU);
-      W.pivotMerge(0, Phi.rows(), Gamma);
-      
-      // sQ
-      Matrix<FloatT> Q(W.columns(), W.columns());
-      for(int i = 0; i < m_D.rows(); i++){
-        Q(i, i) = m_D(i, i);
-      }
-      for(int i = m_D.rows(); i < Q.rows(); i++){
-        Q(i, i) = KalmanFilter<FloatT>::m_Q(i - m_D.rows(), i - m_D.rows());
+      // W = [Phi U, Gamma], Dw = [D, diag(Q)]
+      for(unsigned int i(0); i < n; ++i){
+        FloatT *W_i(&W[i * w]);
+        for(unsigned int k(0); k < n; ++k){
+          FloatT v(Phi(i, k));
+          for(unsigned int l(0); l < k; ++l){
+            v += Phi(i, l) * u(l, k);
+          }
+          W_i[k] = v;
+        }
+        for(unsigned int k(0); k < q; ++k){
+          W_i[n + k] = Gamma(i, k);
+        }
       }
+      for(unsigned int k(0); k < n; ++k){Dw[k] = m_D[k];}
+      for(unsigned int k(0); k < q; ++k){Dw[n + k] = super_t::m_Q(k, k);}
 
-#if DEBUG
-      std::cerr << "W:" << W << std::endl;
-      std::cerr << "Q:" << Q << std::endl;
-#endif
-      
-      for(int j = W.rows() - 1; j > 0; j--){
-        typename Matrix<FloatT>::partial_t V(W.rowVector(j));
-        
-        Matrix<FloatT> Z(1, Q.columns()); // = V * QÂߓWJď
-        for(int i = 0; i < Z.columns(); i++){
-          Z(0, i) = V(0, i) * Q(i, i); 
+      // MWGS orthogonalization from the last row
+      for(int j(n - 1); j >= 0; --j){
+        const FloatT *W_j(&W[j * w]);
+        FloatT d(0);
+        for(unsigned int k(0); k < w; ++k){
+          d += W_j[k] * W_j[k] * Dw[k];
         }
-        
-        m_D(j, j) = (Z * V.transpose())(0, 0);
-        for(int i = 0; i < j; i++){
-          m_U(i, j) = (W.rowVector(i) * Z.transpose())(0, 0) / m_D(j, j);
-          W.rowVector(i) -= m_U(i, j) * V;
+        m_D[j] = d;
+        for(int i(0); i < j; ++i){
+          FloatT *W_i(&W[i * w]);
+          FloatT v(0);
+          for(unsigned int k(0); k < w; ++k){
+            v += W_i[k] * Dw[k] * W_j[k];
+          }
+          if(d != 0){v /= d;}else{v = 0;}
+          u(i, j) = v;
+          for(unsigned int k(0); k < w; ++k){
+            W_i[k] -= v * W_j[k];
+          }
         }
       }
-      
-      // m_D(0, 0) = (W.rowVector(0) * Q * W.rowVector(0).transpose())(0, 0);
-      m_D(0, 0) = 0;
-      for(int j = 0; j < W.columns(); j++){
-        m_D(0, 0) += W(0, j) * W(0, j) * Q(j, j);
-      }
 
-      //sP̍XV
-      need_update_P = true;
+      invalidate_P();
 
 #if DEBUG
-      std::cerr << "predict_UDKF_U:" << m_U << std::endl;
-      std::cerr << "predict_UDKF_D:" << m_D << std::endl;
-      std::cerr << "predict_UDKF_P:" << getP() << std::endl;
+      std::cerr << "predict_UDKF_U:" << getU() << std::endl;
+      std::cerr << "predict_UDKF_D:" << getD() << std::endl;
 #endif
     }
-    
+
     /**
-     * tB^[ϑXV(C)A̍ۂ̃J}QC߂܂B
-     * IUD𗘗pĂ܂B
-     * 
-     * @param H @f$ H @f$s(ϑs)
-     * @param R ϑľ덷Us@f$ R @f$
-     * @return (Matrix<FloatT>) J}QC@f$ K @f$
+     * Measurement update with the Bierman's sequential scalar method,
+     * which works in place on the factors.
+     * @f$ R @f$ is assumed to be diagonal.
+     *
+     * @param H @f$ H @f$ (observation matrix)
+     * @param R @f$ R @f$ (observation noise covariance)
+     * @return (Matrix<FloatT>) Kalman gain @f$ K @f$
      */
     Matrix<FloatT> correct(const Matrix<FloatT> &H, const Matrix<FloatT> &R){
-#if DEBUG
-      std::cerr << "correct_KF_K:" << KalmanFilter<FloatT>::correct(H, R) << std::endl;
-      std::cerr << "correct_KF_P:" << KalmanFilter<FloatT>::m_P << std::endl;
-#endif
-      
-      // J}QC
-      Matrix<FloatT> K(KalmanFilter<FloatT>::m_P.rows(), R.rows());
-      
-      for(int k = 0; k < R.rows(); k++){
-        Matrix<FloatT> f(m_U.columns(), H.rows());
-        Matrix<FloatT> g(m_D.rows(), f.columns());
-        
-        // f̐
-        for(int i = 0; i < f.rows(); i++){
-          for(int j = 0; j <= i; j++){
-            f(i, 0) += H(k, j) * m_U(j, i);
+      const unsigned int n(m_n);
+      Matrix<FloatT> K(n, R.rows());
+      m_work.resize(n * 3);
+      FloatT *f(&m_work[0]), *g(&m_work[n]), *k_col(&m_work[n * 2]);
+
+      for(unsigned int m(0); m < R.rows(); ++m){
+        // f = U^{T} h, g = D f
+        for(unsigned int j(0); j < n; ++j){
+          FloatT v(H(m, j));
+          for(unsigned int i(0); i < j; ++i){
+            v += H(m, i) * u(i, j);
           }
+          f[j] = v;
+          g[j] = m_D[j] * v;
         }
-        
-        // g̐
-        for(int i = 0; i < g.rows(); i++){
-          g(i, 0) = m_D(i, i) * f(i, 0);
+
+        FloatT alpha(R(m, m) + f[0] * g[0]);
+        m_D[0] *= (R(m, m) / alpha);
+        k_col[0] = g[0];
+
+        for(unsigned int j(1); j < n; ++j){
+          FloatT alpha_next(alpha + f[j] * g[j]);
+          m_D[j] *= (alpha / alpha_next);
+          FloatT lambda(f[j] / alpha);
+          for(unsigned int i(0); i < j; ++i){
+            FloatT &u_ij(u(i, j));
+            FloatT u_ij_old(u_ij);
+            u_ij -= lambda * k_col[i];
+            k_col[i] += g[j] * u_ij_old;
+          }
+          k_col[j] = g[j];
+          alpha = alpha_next;
         }
-        
-        FloatT r(R(k, k));
-        FloatT alpha = r + f(0, 0) * g(0, 0);
-        K(0, k) = g(0, 0);
-        m_D(0, 0) *= (r / alpha);
-        
-        for(int j = 1; j < f.rows(); j++){
-          FloatT _alpha(alpha + f(j, 0) * g(j, 0));
-          m_D(j, j) *= (alpha / _alpha);
-          FloatT lambda(f(j, 0) / alpha);
-          Matrix<FloatT> _u(m_U.columnVector(j).copy());
-          m_U.columnVector(j) -= lambda * K.columnVector(k);
-          K.columnVector(k) += g(j, 0) * _u;
-          alpha = _alpha;
+        for(unsigned int i(0); i < n; ++i){
+          K(i, m) = k_col[i] / alpha;
         }
-        K.columnVector(k) /= alpha;
       }
-      
-      //sP̍XV
-      need_update_P = true;
+
+      invalidate_P();
 
 #if DEBUG
       std::cerr << "correct_UDKF_K:" << K << std::endl;
@@ -603,20 +674,166 @@ class KalmanFilterUD : public KalmanFilter<FloatT>{
 
       return K;
     }
-    
+
     /**
-     * 덷Us@f$ P @f$UD̍s@f$ U @f$Ԃ܂B
-     * 
-     * @return (Matrix<FloatT>) s@f$ U @f$
+     * Return @f$ U @f$ of UD factorized @f$ P @f$, which is expanded from the packed form.
+     *
+     * @return (Matrix<FloatT>) @f$ U @f$
      */
-    const Matrix<FloatT> &getU() const {return m_U;}
-    
+    Matrix<FloatT> getU() const {
+      Matrix<FloatT> U(Matrix<FloatT>::getI(m_n));
+      for(unsigned int j(1); j < m_n; ++j){
+        for(unsigned int i(0); i < j; ++i){
+          U(i, j) = u(i, j);
+        }
+      }
+      return U;
+    }
+
     /**
-     * 덷Us@f$ P @f$UD̍s@f$ D @f$Ԃ܂B
-     * 
-     * @return (Matrix<FloatT>) s@f$ D @f$
+     * Return @f$ D @f$ of UD factorized @f$ P @f$.
+     *
+     * @return (Matrix<FloatT>) @f$ D @f$
      */
-    const Matrix<FloatT> &getD() const {return m_D;}
+    Matrix<FloatT> getD() const {
+      Matrix<FloatT> D(m_n, m_n);
+      for(unsigned int i(0); i < m_n; ++i){
+        D(i, i) = m_D[i];
+      }
+      return D;
+    }
+};
+
+/**
+ * @brief Mixed precision adaptor of Kalman filters
+ *
+ * The adaptor keeps the interface of the underlying filter in FloatT,
+ * which is the precision of the navigation states (typically double),
+ * while the covariance matrices are stored, propagated and corrected
+ * in FloatT_Cov (typically float).
+ * Because the conversion is performed only at the interface,
+ * the states requiring wide dynamic range such as latitude, longitude and
+ * quaternions are kept in FloatT, and correction amounts are also applied in FloatT.
+ * UD factorized filter ( KalmanFilterUD ) is recommended to be combined,
+ * because it preserves positive definiteness of the covariance even in single precision.
+ *
+ * The adaptor is given to the users of template template parameter
+ * (for example, Filtered_INS2) as
+ * KalmanFilterMixedPrecision<KalmanFilterUD>::filter_t .
+ *
+ * @param Filter underlying filter
+ * @param FloatT_Cov precision of the covariance matrices
+ */
+template <
+    template <class> class Filter,
+    class FloatT_Cov = float>
+struct KalmanFilterMixedPrecision {
+  template <class FloatT>
+  class filter_t {
+    public:
+      typedef Filter<FloatT_Cov> base_t;
+      typedef FloatT_Cov float_cov_t;
+
+      template <class T_Out, class T_In>
+      static Matrix<T_Out> cast(const Matrix<T_In> &in){
+        Matrix<T_Out> res(Matrix<T_Out>::blank(in.rows(), in.columns()));
+        for(unsigned int i(0); i < in.rows(); ++i){
+          for(unsigned int j(0); j < in.columns(); ++j){
+            res(i, j) = static_cast<T_Out>(in(i, j));
+          }
+        }
+        return res;
+      }
+
+    protected:
+      base_t m_base;
+      mutable Matrix<FloatT> m_P, m_Q; ///< caches of P and Q in FloatT
+      mutable bool need_update_P, need_update_Q;
+
+    public:
+      filter_t(const Matrix<FloatT> &P, const Matrix<FloatT> &Q)
+          : m_base(cast<FloatT_Cov>(P), cast<FloatT_Cov>(Q)),
+          m_P(), m_Q(), need_update_P(true), need_update_Q(true) {}
+
+      /**
+       * Copy constructor
+       *
+       * @param orig original
+       * @param deepcopy if true, deep copy will be made
+       */
+      filter_t(const filter_t &orig, const bool &deepcopy = false)
+          : m_base(orig.m_base, deepcopy),
+          m_P(), m_Q(), need_update_P(true), need_update_Q(true) {}
+
+      ~filter_t(){}
+
+      filter_t &operator=(const filter_t &another){
+        if(this != &another){
+          m_base = another.m_base;
+          need_update_P = need_update_Q = true;
+        }
+        return *this;
+      }
+
+      void predict(const Matrix<FloatT> &Phi, const Matrix<FloatT> &Gamma){
+        m_base.predict(cast<FloatT_Cov>(Phi), cast<FloatT_Cov>(Gamma));
+        need_update_P = true;
+      }
+
+      void predict(const Matrix<FloatT> &A, const Matrix<FloatT> &B, const FloatT &delta){
+        m_base.predict(cast<FloatT_Cov>(A), cast<FloatT_Cov>(B), static_cast<FloatT_Cov>(delta));
+        need_update_P = true;
+      }
+
+      /**
+       * Correct the filter, and return the Kalman gain.
+       * The gain is returned in FloatT, therefore the correction amount (K z)
+       * is calculated in FloatT.
+       *
+       * @param H observation matrix
+       * @param R observation noise covariance
+       * @return (Matrix<FloatT>) Kalman gain
+       */
+      Matrix<FloatT> correct(const Matrix<FloatT> &H, const Matrix<FloatT> &R){
+        need_update_P = true;
+        return cast<FloatT>(m_base.correct(cast<FloatT_Cov>(H), cast<FloatT_Cov>(R)));
+      }
+
+      const Matrix<FloatT> &getP() const {
+        if(need_update_P){
+          m_P = cast<FloatT>(const_cast<base_t &>(m_base).getP());
+          need_update_P = false;
+        }
+        return m_P;
+      }
+      FloatT getP(const unsigned int &i, const unsigned int &j) const {
+        return need_update_P
+            ? static_cast<FloatT>(m_base.getP(i, j))
+            : m_P(i, j);
+      }
+      void setP(const Matrix<FloatT> &P){
+        m_base.setP(cast<FloatT_Cov>(P));
+        need_update_P = true;
+      }
+      const Matrix<FloatT> &getQ() const {
+        if(need_update_Q){
+          m_Q = cast<FloatT>(m_base.getQ());
+          need_update_Q = false;
+        }
+        return m_Q;
+      }
+      void setQ(const Matrix<FloatT> &Q){
+        m_base.setQ(cast<FloatT_Cov>(Q));
+        need_update_Q = true;
+      }
+
+      /**
+       * Return the underlying filter working in FloatT_Cov.
+       *
+       * @return (base_t &) filter
+       */
+      base_t &base(){return m_base;}
+  };
 };
 
 /**
@@ -447,10 +447,24 @@ struct CalendarTime {
     std::time_t utc_time; ///< corresponding base UTC time in time_t
     int correction_sec;
     static const std::time_t gps_time_zero;
+    /**
+     * Calendar date of the recently converted day.
+     * Because POSIX time has exactly 86400 seconds per day,
+     * a time within the day is converted arithmetically
+     * without std::gmtime(), regardless of the leap seconds applied to utc_time.
+     */
+    mutable struct {
+      bool valid;
+      std::time_t begin; ///< time of 00:00:00 of the day
+      int year, month, mday;
+    } day_cache;
     Converter()
         : gps_time(0),
         leap_seconds(LEAP_SECONDS_UNKNOWN),
-        correction_sec(0) {}
+        correction_sec(0) {
+      day_cache.valid = false;
+      day_cache.begin = 0;
+    }
 
     CalendarTime convert(const FloatT &itow) const {
       if(gps_time.wn != gps_time_t::WN_INVALID){
@@ -461,14 +475,25 @@ struct CalendarTime {
         }
         int gap_sec(std::floor(gap));
         std::time_t current(utc_time + gap_sec + correction_sec);
-        tm *t(std::gmtime(&current));
+        static const int one_day(60 * 60 * 24);
+        std::time_t sec_of_day(current - day_cache.begin);
+        if((!day_cache.valid) || (sec_of_day < 0) || (sec_of_day >= one_day)){
+          tm *t(std::gmtime(&current));
+          day_cache.year = t->tm_year + 1900;
+          day_cache.month = t->tm_mon + 1;
+          day_cache.mday = t->tm_mday;
+          sec_of_day = (t->tm_hour * 60 + t->tm_min) * 60 + t->tm_sec;
+          day_cache.begin = current - sec_of_day;
+          day_cache.valid = true;
+        }
+        int hms((int)sec_of_day);
         CalendarTime res = {
-            t->tm_year + 1900,
-            t->tm_mon + 1,
-            t->tm_mday,
-            t->tm_hour,
-            t->tm_min,
-            gap - gap_sec + t->tm_sec};
+            day_cache.year,
+            day_cache.month,
+            day_cache.mday,
+            hms / (60 * 60),
+            (hms / 60) % 60,
+            gap - gap_sec + (hms % 60)};
         return res;
       }else{
         CalendarTime res = {0, 0, 0, 0, 0, itow};
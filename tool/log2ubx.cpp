@@ -40,6 +40,8 @@
 #include <string>
 #include <exception>
 #include <cstring>
+#include <cstdlib>
+#include <vector>
 
 #define DEBUG 1
 
@@ -51,12 +53,52 @@ typedef double float_sylph_t;
 
 #include "analyze_common.h"
 
+/**
+ * Filter of UBX messages by class and ID, which is compiled into a lookup table.
+ * Its spec is a comma separated list of CLASS[:ID] in hexadecimal, for example, "01,02:10".
+ */
+struct UBXFilter {
+  bool active;
+  bool table[0x100][0x100];
+  UBXFilter() : active(false) {
+    std::memset(table, 0, sizeof(table));
+  }
+  bool parse(const char *spec){
+    while(true){
+      char *end;
+      long mclass(std::strtol(spec, &end, 16));
+      if((end == spec) || (mclass < 0) || (mclass > 0xFF)){return false;}
+      if(*end == ':'){
+        spec = end + 1;
+        long mid(std::strtol(spec, &end, 16));
+        if((end == spec) || (mid < 0) || (mid > 0xFF)){return false;}
+        table[mclass][mid] = true;
+      }else{
+        for(int i(0); i < 0x100; i++){table[mclass][i] = true;}
+      }
+      active = true;
+      if(*end == '\0'){return true;}
+      if(*end != ','){return false;}
+      spec = end + 1;
+    }
+  }
+  bool accept(const unsigned char &mclass, const unsigned char &mid) const {
+    return (!active) || table[mclass][mid];
+  }
+};
+
 struct Options : public GlobalOptions<float_sylph_t> {
   typedef GlobalOptions<float_sylph_t> super_t;
   bool log_is_ubx; ///< ubx2ubx邽߂̃tO
+  bool passthrough; ///< True when payloads of G pages are extracted without the packet observer
+  bool validate; ///< True when checksums are validated in passthrough mode
+  bool time_limited; ///< True when start or end time is specified
+  UBXFilter filter;
   
   Options()
-      : super_t(), log_is_ubx(false) {}
+      : super_t(), log_is_ubx(false),
+      passthrough(false), validate(false), time_limited(false),
+      filter() {}
   ~Options(){}
   
   /**
@@ -81,11 +123,30 @@ struct Options : public GlobalOptions<float_sylph_t> {
       std::cerr << "log_is_ubx" << ": " << (log_is_ubx ? "true" : "false") << std::endl;
       return true;
     }
+    if(value = get_value(spec, "passthrough")){
+      passthrough = is_true(value);
+      std::cerr << "passthrough" << ": " << (passthrough ? "true" : "false") << std::endl;
+      return true;
+    }
+    if(value = get_value(spec, "validate")){
+      validate = is_true(value);
+      std::cerr << "validate" << ": " << (validate ? "true" : "false") << std::endl;
+      return true;
+    }
+    if(value = get_value(spec, "ubx_filter", false)){
+      if(!filter.parse(value)){
+        std::cerr << "(error!) Invalid ubx_filter: " << value << std::endl;
+        return false;
+      }
+      std::cerr << "ubx_filter" << ": " << value << std::endl;
+      return true;
+    }
 
     for(int i(0); 
         i < sizeof(available_keys) / sizeof(available_keys[0]);
         i++){
       if(value = get_value(spec, available_keys[i])){
+        if(i < 4){time_limited = true;}
         return super_t::check_spec(spec);
       }
     }
@@ -107,6 +168,24 @@ int bad_packet(0);
 Options::gps_time_t gps_time_0x0106(0);
 bool read_continue(true);
 
+/**
+ * Update GPS time with NAV-SOL, and stop reading after the end time.
+ */
+void update_gps_time(
+    const unsigned int &status_flags, const float_sylph_t &itow, const int &week){
+  if(status_flags & G_Observer_t::solution_t::TOW_VALID){
+    gps_time_0x0106.sec = itow;
+  }
+  if(status_flags & G_Observer_t::solution_t::WN_VALID){
+    gps_time_0x0106.wn = week;
+  }else{
+    gps_time_0x0106.wn = Options::gps_time_t::WN_INVALID;
+  }
+  if(!options.is_time_before_end(gps_time_0x0106.sec, gps_time_0x0106.wn)){
+    read_continue = false;
+  }
+}
+
 /**
  * Gy[W(u-bloxGPS)̏p֐
  * Gy[W̓evalidateŊmFAsƁB
@@ -129,33 +208,130 @@ void g_packet_handler(const G_Observer_t &observer){
   G_Observer_t::packet_type_t packet_type(observer.packet_type());
   if((packet_type.mclass == 0x01) && (packet_type.mid == 0x06)){
     G_Observer_t::solution_t solution(observer.fetch_solution());
-    if(solution.status_flags & G_Observer_t::solution_t::TOW_VALID){
-      gps_time_0x0106.sec = observer.fetch_ITOW();
-    }
-    if(solution.status_flags & G_Observer_t::solution_t::WN_VALID){
-      gps_time_0x0106.wn = solution.week;
-    }else{
-      gps_time_0x0106.wn = Options::gps_time_t::WN_INVALID;
-    }
-    if(!options.is_time_before_end(gps_time_0x0106.sec, gps_time_0x0106.wn)){
-      read_continue = false;
-      return;
-    }
+    update_gps_time(solution.status_flags, observer.fetch_ITOW(), solution.week);
+    if(!read_continue){return;}
   }
 
   if(!options.is_time_after_start(gps_time_0x0106.sec, gps_time_0x0106.wn)){return;}
+  if(!options.filter.accept(packet_type.mclass, packet_type.mid)){return;}
   good_packet++;
   for(int i = 0; i < observer.current_packet_size(); i++){
     options.out() << observer[i];
   }
 }
 
+/**
+ * Extractor of UBX stream from payloads of G pages without the packet observer.
+ * If none of validation, filtering, and time range is required,
+ * the payloads are copied to the output as they are.
+ * Otherwise, packets are framed in a contiguous buffer, and whole packets are copied.
+ * Outputs are accumulated and written in large blocks.
+ */
+class UBXPassthrough {
+  protected:
+    std::ostream &out;
+    std::vector<char> out_buf;
+    std::size_t out_size;
+    std::vector<char> in_buf;
+    std::size_t in_begin, in_end;
+    bool framing;
+    static const std::size_t max_packet_size = 0x2000;
+
+    void write(const char *data, const std::size_t &size){
+      if(out_size + size > out_buf.size()){
+        flush_out();
+        if(size > out_buf.size()){
+          out.write(data, size);
+          return;
+        }
+      }
+      std::memcpy(&out_buf[out_size], data, size);
+      out_size += size;
+    }
+    void flush_out(){
+      if(out_size > 0){out.write(&out_buf[0], out_size);}
+      out_size = 0;
+    }
+    static bool valid_checksum(const unsigned char *packet, const std::size_t &size){
+      unsigned char ck_a(0), ck_b(0);
+      for(std::size_t i(2); i < size - 2; i++){
+        ck_a += packet[i];
+        ck_b += ck_a;
+      }
+      return (packet[size - 2] == ck_a) && (packet[size - 1] == ck_b);
+    }
+    void scan(){
+      const unsigned char *buf((const unsigned char *)&in_buf[0]);
+      while(read_continue){
+        while((in_end - in_begin >= 2)
+            && !((buf[in_begin] == 0xB5) && (buf[in_begin + 1] == 0x62))){
+          in_begin++;
+        }
+        if(in_end - in_begin < 8){break;}
+        const unsigned char *packet(buf + in_begin);
+        std::size_t size(le_char2_2_num<unsigned short>(*(const char *)(packet + 4)) + 8);
+        if(size > max_packet_size){in_begin++; continue;} // false sync
+        if(in_end - in_begin < size){break;}
+        if(options.validate && !valid_checksum(packet, size)){
+          bad_packet++;
+          in_begin++;
+          continue;
+        }
+        if((packet[2] == 0x01) && (packet[3] == 0x06) && (size >= 6 + 12 + 2)){ // NAV-SOL
+          update_gps_time(
+              packet[6 + 11],
+              1E-3 * le_char4_2_num<unsigned int>(*(const char *)(packet + 6)),
+              le_char2_2_num<short>(*(const char *)(packet + 6 + 8)));
+          if(!read_continue){break;}
+        }
+        if(options.is_time_after_start(gps_time_0x0106.sec, gps_time_0x0106.wn)
+            && options.filter.accept(packet[2], packet[3])){
+          good_packet++;
+          write((const char *)packet, size);
+        }
+        in_begin += size;
+      }
+      // Unprocessed bytes are moved to the head.
+      std::memmove(&in_buf[0], &in_buf[in_begin], in_end - in_begin);
+      in_end -= in_begin;
+      in_begin = 0;
+    }
+  public:
+    UBXPassthrough(std::ostream &out_)
+        : out(out_), out_buf(0x100000), out_size(0),
+        in_buf(0x100000), in_begin(0), in_end(0),
+        framing(options.validate || options.filter.active || options.time_limited) {}
+    ~UBXPassthrough(){
+      finish();
+    }
+    /**
+     * @param payload payload of a G page
+     * @param size size of payload, which must be less than a half of the buffer
+     */
+    void feed(const char *payload, const std::size_t &size){
+      if(!framing){
+        write(payload, size);
+        return;
+      }
+      if(in_end + size > in_buf.size()){
+        scan();
+        if(!read_continue){return;}
+      }
+      std::memcpy(&in_buf[in_end], payload, size);
+      in_end += size;
+    }
+    void finish(){
+      if(framing){scan();}
+      flush_out();
+    }
+};
+
 /**
  * t@C̃Xg[y[WPʂŐ؂o֐
  * 
  * @param in Xg[
  */
-void stream_processor(istream &in){
+void stream_processor(istream &in, const int &pages_per_read = 1){
   char buffer[SYLPHIDE_PAGE_SIZE];
   char *buffer_head(buffer);
   int read_count_max(sizeof(buffer));
@@ -168,19 +344,30 @@ void stream_processor(istream &in){
 
   Processor_t processor(OBSERVER_SIZE);       // Xg[@𐶐
   processor.set_g_handler(g_packet_handler);  // Gy[W̍ۂ̏o^
+  UBXPassthrough passthrough(options.out());
   
-  int count(0);
+  // Multiple pages are read at once, and processed one by one.
+  std::vector<char> chunk(read_count_max * pages_per_read);
 
   while(read_continue && (!in.eof())){
-    count++;
+    in.read(&chunk[0], chunk.size());
+    int pages(in.gcount() / read_count_max); // An incomplete page is skipped.
 
-    in.read(buffer_head, read_count_max);
-    if(in.gcount() < read_count_max){
-      continue;
+    for(int i(0); read_continue && (i < pages); i++){
+      char *page(&chunk[read_count_max * i]);
+      if(options.passthrough){
+        if(options.log_is_ubx){
+          passthrough.feed(page, read_count_max);
+        }else if(page[0] == 'G'){
+          passthrough.feed(page + 1, read_count_max - 1);
+        }
+        continue;
+      }
+      std::memcpy(buffer_head, page, read_count_max);
+      processor.process(buffer, sizeof(buffer));
     }
-
-    processor.process(buffer, sizeof(buffer));
   }
+  passthrough.finish();
 }
 
 int main(int argc, char *argv[]){
@@ -224,7 +411,9 @@ int main(int argc, char *argv[]){
     SylphideIStream sylphide_in(options.spec2istream(argv[log_index]), SYLPHIDE_PAGE_SIZE);
     stream_processor(sylphide_in);
   }else{
-    stream_processor(options.spec2istream(argv[log_index]));
+    // A file is read in large blocks, while a serial port is read page by page.
+    bool is_comport(std::strstr(argv[log_index], COMPORT_PREFIX) == argv[log_index]);
+    stream_processor(options.spec2istream(argv[log_index]), is_comport ? 1 : 0x1000);
   }
   
   cerr << "Good, Bad = " 
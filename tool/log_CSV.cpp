@@ -40,13 +40,17 @@ typedef __int64 int64_t;
 #include <iomanip>
 #include <sstream>
 #include <exception>
+#include <vector>
 
 #define IS_LITTLE_ENDIAN 1
 #include "SylphideStream.h"
 #include "SylphideProcessor.h"
+#include "MS5611.h"
 
 typedef double float_sylph_t;
 #include "analyze_common.h"
+#include "util/async_ostream.h"
+#include "util/ordered_formatter.h"
 
 using namespace std;
 
@@ -59,6 +63,20 @@ struct Options : public GlobalOptions<float_sylph_t> {
   bool page_M;
   bool page_N;
   bool page_other;
+  /**
+   * Per-page output specified with --out_X=(spec), where X is a page type.
+   * If target is NULL, out() is used. stream is the buffered front of target.
+   */
+  struct page_out_t {
+    std::ostream *target;
+    AsyncOStream *stream;
+  } page_out['Z' - 'A' + 1];
+  bool out_threaded; ///< True when each per-page output is written by its own thread
+  int threads; ///< Number of threads for formatting; if more than one, formatter is used
+  OrderedFormatter *formatter;
+  std::vector<OrderedFormatter::writer_t> writers; ///< Output of each page type
+  float_sylph_t summary_window; ///< Window [s] of summary; if positive, summary is written instead of rows
+  float_sylph_t page_P_altitude; ///< Sea level pressure [Pa] for barometric altitude; if positive, altitude is written
   int page_P_mode, page_F_mode, page_M_mode;
   int debug_level;
   typedef CalendarTime<float_sylph_t> calendar_time_t;
@@ -78,6 +96,10 @@ struct Options : public GlobalOptions<float_sylph_t> {
       page_A(false), page_G(false), page_F(false), 
       page_P(false), page_M(false), page_N(false),
       page_other(false),
+      out_threaded(true),
+      threads(1), formatter(NULL), writers(),
+      summary_window(0),
+      page_P_altitude(0),
       page_P_mode(5),
       page_F_mode(3),
       page_M_mode(0),
@@ -90,13 +112,109 @@ struct Options : public GlobalOptions<float_sylph_t> {
     physical_converter.accel.zero = (1 << 15);
     physical_converter.gyro.sf = 2000.0 / (1 << 15);
     physical_converter.gyro.zero = (1 << 15);
+
+    for(std::size_t i(0); i < sizeof(page_out) / sizeof(page_out[0]); i++){
+      page_out[i].target = NULL;
+      page_out[i].stream = NULL;
+    }
+  }
+  ~Options(){
+    close_page_out();
+  }
+
+  using super_t::out;
+  /**
+   * Return output stream for a page type
+   *
+   * @param page page type
+   */
+  std::ostream &out_stream(const char &page) const {
+    const page_out_t &selected(page_out[page - 'A']);
+    return selected.stream ? *selected.stream
+        : (selected.target ? *selected.target : out());
+  }
+  /**
+   * Check whether two page types are written to the same output
+   *
+   * @param a page type
+   * @param b page type
+   */
+  bool shares_out(const char &a, const char &b) const {
+    return out_stream(a).rdbuf() == out_stream(b).rdbuf();
+  }
+  /**
+   * Return output for a page type, which is formatted on multiple threads
+   * when the formatter is active. open_page_out() must be called in advance.
+   *
+   * @param page page type
+   */
+  OrderedFormatter::writer_t &out(const char &page) {
+    return writers[page - 'A'];
+  }
+
+  /**
+   * Start per-page outputs, each of which is buffered in a large block
+   * and, if out_threaded is true, written by its own thread.
+   */
+  void open_page_out(){
+    for(std::size_t i(0); i < sizeof(page_out) / sizeof(page_out[0]); i++){
+      if((!page_out[i].target) || page_out[i].stream){continue;}
+      bool shared(page_out[i].target->rdbuf() == out().rdbuf());
+      for(std::size_t j(0); (!shared) && (j < sizeof(page_out) / sizeof(page_out[0])); j++){
+        shared = (j != i) && page_out[j].target
+            && (page_out[j].target->rdbuf() == page_out[i].target->rdbuf());
+      }
+      if(shared){ // A target shared with another output is written directly to keep the order.
+        page_out[i].target->precision(out().precision());
+        continue;
+      }
+      page_out[i].stream = new AsyncOStream(*page_out[i].target, out_threaded);
+      page_out[i].stream->precision(out().precision());
+    }
+    if((threads > 1) && (!formatter)){
+      formatter = new OrderedFormatter(threads);
+    }
+    writers.clear();
+    for(char page('A'); page <= 'Z'; page++){
+      writers.push_back(OrderedFormatter::writer_t(out_stream(page), formatter));
+    }
+  }
+
+  /**
+   * Finish per-page outputs, which must be performed before the targets are closed.
+   */
+  void close_page_out(){
+    if(formatter){
+      delete formatter; // Remaining values are written.
+      formatter = NULL;
+    }
+    writers.clear();
+    for(std::size_t i(0); i < sizeof(page_out) / sizeof(page_out[0]); i++){
+      if(!page_out[i].stream){continue;}
+      page_out[i].stream->close();
+      delete page_out[i].stream;
+      page_out[i].stream = NULL;
+    }
+  }
+
+  bool enable_page(const char &page){
+    switch(page){
+      case 'A': page_A = true; break;
+      case 'G': page_G = true; break;
+      case 'F': page_F = true; break;
+      case 'M': page_M = true; break;
+      case 'N': page_N = true; break;
+      case 'P': page_P = true; break;
+      default: return false;
+    }
+    return true;
   }
-  ~Options(){}
   
   struct formatted_time_t {
     const Options &options;
     float_sylph_t itow;
-    friend ostream &operator<<(ostream &out, const formatted_time_t &t){
+    template <class StreamT>
+    friend StreamT &operator<<(StreamT &out, const formatted_time_t &t){
       if(t.options.use_calendar_time){ // year, month, mday, hour, min, sec
         calendar_time_t t2(
             t.options.time_gps2local.convert(t.itow));
@@ -148,6 +266,9 @@ struct Options : public GlobalOptions<float_sylph_t> {
     CHECK_OPTION(page_M_mode, false,
         page_M_mode = atoi(value),
         page_M_mode);
+    CHECK_OPTION(page_P_altitude, true,
+        page_P_altitude = (is_true(value) ? 101325 : atof(value)),
+        "sea level pressure " << page_P_altitude << " [Pa]");
     CHECK_OPTION(page_other, true,
         page_other = is_true(value),
         (page_other ? "on" : "off"));
@@ -170,18 +291,28 @@ struct Options : public GlobalOptions<float_sylph_t> {
     do{
       const char *value(GlobalOptions::get_value(spec, "page", false));
       if(!value){break;}
-      switch(*value){
-        case 'A': page_A = true; break;
-        case 'G': page_G = true; break;
-        case 'F': page_F = true; break;
-        case 'M': page_M = true; break;
-        case 'N': page_N = true; break;
-        case 'P': page_P = true; break;
-        default: return false;
-      }
+      return enable_page(*value);
+    }while(false);
+
+    do{ // Per-page output, for example, --out_A=a.csv
+      if((std::strncmp(spec, "--out_", 6) != 0)
+          || (spec[6] < 'A') || (spec[6] > 'Z') || (spec[7] != '=')){break;}
+      if(!enable_page(spec[6])){return false;}
+      cerr << "out_" << spec[6] << ": ";
+      page_out[spec[6] - 'A'].target = &(spec2ostream(spec + 8));
       return true;
     }while(false);
 
+    CHECK_OPTION(out_threaded, true,
+        out_threaded = is_true(value),
+        (out_threaded ? "on" : "off"));
+    CHECK_OPTION(threads, false,
+        threads = atoi(value),
+        threads);
+    CHECK_OPTION(summary, false,
+        summary_window = atof(value),
+        summary_window << " [s]");
+
     CHECK_OPTION(debug, false,
         debug_level = atoi(value),
         debug_level);
@@ -194,6 +325,128 @@ struct Options : public GlobalOptions<float_sylph_t> {
   }
 } options;
 
+/**
+ * Per-window statistics of page contents, which are computed in a single pass
+ * and written instead of every row when --summary=(window) is specified.
+ * Each row is "time, page, channel, count, min, max, mean, stddev",
+ * where time is the beginning of the window.
+ * In addition to the channels of page contents, intervals of time stamps are checked
+ * for each page type; "dt" is a positive interval, "duplicated" is a non-positive one,
+ * and "gap" is one exceeding 1.5 times the nominal (minimum positive) interval.
+ */
+struct IntervalSummary {
+  struct stat_t { ///< Welford's online algorithm
+    int count;
+    float_sylph_t min, max, mean, m2;
+    stat_t() : count(0), min(0), max(0), mean(0), m2(0) {}
+    void add(const float_sylph_t &v){
+      if(count++ == 0){
+        min = max = v;
+      }else if(v < min){
+        min = v;
+      }else if(v > max){
+        max = v;
+      }
+      float_sylph_t delta(v - mean);
+      mean += delta / count;
+      m2 += delta * (v - mean);
+    }
+    float_sylph_t stddev() const {
+      return (count > 1) ? std::sqrt(m2 / (count - 1)) : 0;
+    }
+  };
+  struct page_t {
+    std::vector<const char *> labels;
+    std::vector<stat_t> channels;
+    stat_t dt, duplicated, gap;
+    bool has_previous;
+    float_sylph_t previous_itow, period;
+    page_t() : labels(), channels(), has_previous(false), previous_itow(0), period(0) {}
+  } pages['Z' - 'A' + 1];
+  float_sylph_t window, begin;
+  bool has_begin;
+
+  IntervalSummary() : window(0), begin(0), has_begin(false) {}
+
+  bool is_active() const {return window > 0;}
+
+  template <std::size_t N>
+  void set_labels(const char &page, const char *(&labels)[N]){
+    page_t &target(pages[page - 'A']);
+    target.labels.assign(labels, labels + N);
+    target.channels.resize(N);
+  }
+
+  /**
+   * Move to the window including the specified time.
+   * A time earlier than the current window by less than its width is regarded as late arrival.
+   */
+  void advance(const float_sylph_t &t){
+    if(has_begin && (t < begin + window) && (t >= begin - window)){return;}
+    if(has_begin){flush();}
+    begin = std::floor(t / window) * window;
+    has_begin = true;
+  }
+
+  /**
+   * Register time stamp of a page to check its interval.
+   */
+  void sample(const char &page, const float_sylph_t &itow){
+    advance(itow);
+    page_t &target(pages[page - 'A']);
+    if(target.has_previous){
+      float_sylph_t delta(itow - target.previous_itow);
+      if(delta <= 0){
+        target.duplicated.add(delta);
+      }else{
+        target.dt.add(delta);
+        if((target.period > 0) && (delta > target.period * 1.5)){
+          target.gap.add(delta);
+        }
+        if((target.period <= 0) || (delta < target.period)){
+          target.period = delta;
+        }
+      }
+    }
+    target.has_previous = true;
+    target.previous_itow = itow;
+  }
+
+  void add(const char &page, const int &channel, const float_sylph_t &v){
+    pages[page - 'A'].channels[channel].add(v);
+  }
+
+  void print(const char &page, const char *label, const stat_t &stat){
+    if(stat.count == 0){return;}
+    options.out(page) << options.format_time(begin) << ", "
+        << page << ", " << label << ", "
+        << stat.count << ", "
+        << stat.min << ", "
+        << stat.max << ", "
+        << stat.mean << ", "
+        << stat.stddev() << endl;
+  }
+
+  /**
+   * Write statistics of the current window, and reset them.
+   */
+  void flush(){
+    if(!has_begin){return;}
+    for(std::size_t i(0); i < sizeof(pages) / sizeof(pages[0]); i++){
+      page_t &target(pages[i]);
+      char page('A' + i);
+      for(std::size_t j(0); j < target.channels.size(); j++){
+        print(page, target.labels[j], target.channels[j]);
+        target.channels[j] = stat_t();
+      }
+      print(page, "dt", target.dt);
+      print(page, "duplicated", target.duplicated);
+      print(page, "gap", target.gap);
+      target.dt = target.duplicated = target.gap = stat_t();
+    }
+  }
+} summary;
+
 class StreamProcessor : public SylphideProcessor<float_sylph_t> {
   protected:
     int invoked;
@@ -228,30 +481,47 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
         float_sylph_t current(StreamProcessor::get_corrected_ITOW(observer));
         if(!options.is_time_in_range(current)){return;}
         
+        if(summary.is_active()){summary.sample('A', current);}
+        
         A_Observer_t::values_t values(observer.fetch_values());
         (this->*formatter)(current, values);
         count++;
       }
       void dump_raw(const float_sylph_t &current, const A_Observer_t::values_t &values) const {
-        options.out() 
+        options.out('A') 
             << count << ", "
             << options.format_time(current) << ", ";
         
         for(int i(0); i < 8; i++){
-          options.out() << values.values[i] << ", ";
+          options.out('A') << values.values[i] << ", ";
         }
-        options.out() << values.temperature << endl;
+        options.out('A') << values.temperature << endl;
       }
       void dump_physical(const float_sylph_t &current, const A_Observer_t::values_t &values) const {
-        options.out() << options.format_time(current);
+        options.out('A') << options.format_time(current);
 
         for(int i(0); i < 3; i++){ // accelerometer
-          options.out() << ", " << (values.values[i] - options.physical_converter.accel.zero) * options.physical_converter.accel.sf;
+          options.out('A') << ", " << (values.values[i] - options.physical_converter.accel.zero) * options.physical_converter.accel.sf;
         }
         for(int i(3); i < 6; i++){ // gyro
-          options.out() << ", " << (values.values[i] - options.physical_converter.gyro.zero) * options.physical_converter.gyro.sf;
+          options.out('A') << ", " << (values.values[i] - options.physical_converter.gyro.zero) * options.physical_converter.gyro.sf;
+        }
+        options.out('A') << endl;
+      }
+      void summarize(const float_sylph_t &current, const A_Observer_t::values_t &values) const {
+        if(options.physical_converter.is_active){
+          for(int i(0); i < 3; i++){ // accelerometer
+            summary.add('A', i, (values.values[i] - options.physical_converter.accel.zero) * options.physical_converter.accel.sf);
+          }
+          for(int i(3); i < 6; i++){ // gyro
+            summary.add('A', i, (values.values[i] - options.physical_converter.gyro.zero) * options.physical_converter.gyro.sf);
+          }
+        }else{
+          for(int i(0); i < 8; i++){
+            summary.add('A', i, values.values[i]);
+          }
+          summary.add('A', 8, values.temperature);
         }
-        options.out() << endl;
       }
       HandlerA() : count(0), formatter(&HandlerA::dump_raw) {}
     } handler_A;
@@ -318,6 +588,16 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
                 }
                 break;
               }
+              case 0x06: { // NAV-SOL
+                if(!(options.page_G && summary.is_active())){break;}
+                super_t::G_Observer_t::solution_t solution(observer.fetch_solution());
+                float_sylph_t current(observer.fetch_ITOW());
+                if(!options.is_time_in_range(current)){break;}
+                summary.advance(current);
+                summary.add('G', 3, solution.fix_type);
+                summary.add('G', 4, solution.satellites_used);
+                break;
+              }
             }
             break;
           }
@@ -333,7 +613,15 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
           float_sylph_t current(1E-3 * itow_ms_0x0102);
           if(!options.is_time_in_range(current)){return;}
           
-          options.out() << options.format_time(current) << ", "
+          if(summary.is_active()){
+            summary.sample('G', current);
+            summary.add('G', 0, position_acc.horizontal);
+            summary.add('G', 1, position_acc.vertical);
+            summary.add('G', 2, velocity_acc.acc);
+            return;
+          }
+          
+          options.out('G') << options.format_time(current) << ", "
               << position.latitude << ", "
               << position.longitude << ", "
               << position.altitude << ", "
@@ -361,20 +649,25 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
         float_sylph_t current(StreamProcessor::get_corrected_ITOW(observer));
         if(!options.is_time_in_range(current)){return;}
         
-        options.out() << (count++)
+        if(summary.is_active()){
+          summary.sample('F', current);
+          return;
+        }
+        
+        options.out('F') << (count++)
              << ", " << options.format_time(current);
         
         F_Observer_t::values_t values(observer.fetch_values());
         for(int i = 0; i < 8; i++){
           //if(values.servo_in[i] < 1000){values.servo_in[i] += 1000;}
           if(options.page_F_mode & 0x01){ // bit 0 for input
-            options.out() << ", " << values.servo_in[i];
+            options.out('F') << ", " << values.servo_in[i];
           }
           if(options.page_F_mode & 0x02){ // bit 1 for output
-            options.out() << ", " << values.servo_out[i];
+            options.out('F') << ", " << values.servo_out[i];
           }
         }
-        options.out() << endl;
+        options.out('F') << endl;
       }
     } handler_F;
     
@@ -382,38 +675,47 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
     struct HandlerP {
       void (HandlerP::*formatter)(
           const float_sylph_t &current, const int &index,
-          const Int32 &pressure, const Int32 &temperature) const;
-      void ms5611_convert(
-          const Int32 &d1, const Int32 &d2,
-          Int32 &pressure, Int32 &temperature,
-          const Uint16 (&coef)[6]) const {
-        Int32 dT(d2 - (coef[4] << 8));
-        temperature = (Int32)2000 + (((int64_t)dT * coef[5]) >> 23);
-
-        int64_t off(((int64_t)coef[1] << 16) + (((int64_t)coef[3] * dT) >> 7));
-        int64_t sens(((int64_t)coef[0] << 15) + (((int64_t)coef[2] * dT) >> 8));
-
-        // Figure 3
-        if(temperature < 2000){
-          Int32 t2(((int64_t)dT * dT) << 31);
-          Int32 dT2(temperature - 2000), dT2_2(dT2 * dT2);
-          Int32 off2((dT2_2 * 5) >> 1);
-          Int32 sens2((dT2_2 * 5) >> 2);
-          if(temperature < -1500){
-            Int32 dT3(temperature + 1500), dT3_2(dT3 * dT3);
-            off2 += dT3_2 * 7;
-            sens2 += (dT3_2 * 11) >> 1;
+          const Int32 &pressure, const Int32 &temperature,
+          const float_sylph_t &altitude) const;
+
+      static const int batch_capacity = 0x200;
+      struct {
+        float_sylph_t current[batch_capacity];
+        Uint32 d1[batch_capacity], d2[batch_capacity];
+        Int32 pressure[batch_capacity], temperature[batch_capacity];
+        float_sylph_t altitude[batch_capacity];
+        int size;
+      } batch;
+      char prom[12]; ///< raw PROM coefficients of the recent page
+      Uint16 coef[6];
+
+      bool pending() const {return batch.size > 0;}
+
+      /**
+       * Convert and output the batched samples.
+       * Each page has two samples, whose indices are -1 and 0.
+       */
+      void flush(){
+        if(batch.size <= 0){return;}
+        MS5611::convert(coef, batch.size, batch.d1, batch.d2, batch.pressure, batch.temperature);
+        if(options.page_P_altitude > 0){
+          for(int i(0); i < batch.size; ++i){
+            batch.altitude[i] = MS5611::altitude<float_sylph_t>(batch.pressure[i], options.page_P_altitude);
           }
-          temperature -= t2;
-          off -= off2;
-          sens -= sens2;
         }
-
-        pressure = (Int32)(((((int64_t)d1 * sens) >> 21) - off) >> 15);
+        for(int i(0); i < batch.size; ++i){
+          int index(i % 2 - 1);
+          if((index < 0) && summary.is_active()){summary.sample('P', batch.current[i]);}
+          (this->*formatter)(batch.current[i], index,
+              batch.pressure[i], batch.temperature[i], batch.altitude[i]);
+        }
+        batch.size = 0;
       }
 
       /**
        * check P page (pressure sensor)
+       * Samples are batched until flush(), which must be invoked
+       * before other pages generate outputs ordered with them or update local time.
        * 
        * @param observer F page observer
        */
@@ -425,45 +727,70 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
         
         switch(options.page_P_mode){
           case 5: { // MS5611 with coefficients
-            Uint16 coef[6];
-            char buf[sizeof(Uint16)];
-            for(int i(0); i < sizeof(coef) / sizeof(coef[0]); i++){
-              observer.inspect(&buf[0], sizeof(buf), 19 + (sizeof(buf) * i));
-              coef[i] = be_char2_2_num<Uint16>(*buf);
+            char buf[sizeof(prom)];
+            observer.inspect(buf, sizeof(buf), 19);
+            if(std::memcmp(buf, prom, sizeof(prom)) != 0){ // PROM is decoded only when it changes.
+              flush();
+              std::memcpy(prom, buf, sizeof(prom));
+              for(int i(0); i < sizeof(coef) / sizeof(coef[0]); i++){
+                coef[i] = be_char2_2_num<Uint16>(prom[sizeof(Uint16) * i]);
+              }
             }
 
-            for(int i(0), j(-1); i < 2; i++, j++){
+            for(int i(0); i < 2; i++){
               char buf[2][4];
               buf[0][0] = buf[1][0] = 0;
               observer.inspect(&buf[0][1], 3, 7 + 6 * i);
               observer.inspect(&buf[1][1], 3, 10 + 6 * i);
-              Uint32
-                  d1(be_char4_2_num<Uint32>(buf[0][0])),
-                  d2(be_char4_2_num<Uint32>(buf[1][0]));
-              Int32 pressure, temperature;
-              ms5611_convert(d1, d2, pressure, temperature, coef);
-              (this->*formatter)(current, j, pressure, temperature);
+              batch.current[batch.size] = current;
+              batch.d1[batch.size] = be_char4_2_num<Uint32>(buf[0][0]);
+              batch.d2[batch.size] = be_char4_2_num<Uint32>(buf[1][0]);
+              batch.size++;
             }
+            if(batch.size >= batch_capacity){flush();}
             break;
           }
         }
       }
       void dump_raw(
           const float_sylph_t &current, const int &index,
-          const Int32 &pressure, const Int32 &temperature) const {
-        options.out()
-            << options.format_time(current) << ", " << index << ", "
-            << pressure << ", " << temperature << endl;
+          const Int32 &pressure, const Int32 &temperature,
+          const float_sylph_t &altitude) const {
+        OrderedFormatter::writer_t &out(options.out('P'));
+        out << options.format_time(current) << ", " << index << ", "
+            << pressure << ", " << temperature;
+        if(options.page_P_altitude > 0){out << ", " << altitude;} // [m]
+        out << endl;
       }
       void dump_physical(
           const float_sylph_t &current, const int &index,
-          const Int32 &pressure, const Int32 &temperature) const {
-        options.out()
-            << options.format_time(current) << ", " << index << ", "
+          const Int32 &pressure, const Int32 &temperature,
+          const float_sylph_t &altitude) const {
+        OrderedFormatter::writer_t &out(options.out('P'));
+        out << options.format_time(current) << ", " << index << ", "
             << (float_sylph_t)pressure << ", "  // [Pa]
-            << (float_sylph_t)temperature / 100 << endl; // [degC]
+            << (float_sylph_t)temperature / 100; // [degC]
+        if(options.page_P_altitude > 0){out << ", " << altitude;} // [m]
+        out << endl;
+      }
+      void summarize(
+          const float_sylph_t &current, const int &index,
+          const Int32 &pressure, const Int32 &temperature,
+          const float_sylph_t &altitude) const {
+        if(options.physical_converter.is_active){
+          summary.add('P', 0, (float_sylph_t)pressure); // [Pa]
+          summary.add('P', 1, (float_sylph_t)temperature / 100); // [degC]
+        }else{
+          summary.add('P', 0, pressure);
+          summary.add('P', 1, temperature);
+        }
+        if(options.page_P_altitude > 0){summary.add('P', 2, altitude);}
+      }
+      HandlerP() : formatter(&HandlerP::dump_raw) {
+        batch.size = 0;
+        std::memset(prom, 0, sizeof(prom));
+        std::memset(coef, 0, sizeof(coef));
       }
-      HandlerP() : formatter(&HandlerP::dump_raw) {}
     } handler_P;
     
     /**
@@ -479,12 +806,14 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
         float_sylph_t current(StreamProcessor::get_corrected_ITOW(observer));
         if(!options.is_time_in_range(current)){return;}
         
+        if(summary.is_active()){summary.sample('M', current);}
+        
         M_Observer_t::values_t values(observer.fetch_values());
 
-        switch(options.page_M_mode){
+        switch(summary.is_active() ? 0 : options.page_M_mode){
           case 1: // -atan2(y, x)[deg]\
             for(int i(0), j(-3); i < 4; i++, j++){
-              options.out() << options.format_time(current) << ", "
+              options.out('M') << options.format_time(current) << ", "
                    << j << ", "
                    << rad2deg(-atan2((double)values.y[i], (double)values.x[i])) << endl;
             }
@@ -495,7 +824,7 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
       }
       void dump_raw(const float_sylph_t &current, const M_Observer_t::values_t &values) const {
         for(int i(0), j(-3); i < 4; i++, j++){
-          options.out() << options.format_time(current) << ", "
+          options.out('M') << options.format_time(current) << ", "
                << j << ", "
                << values.x[i] << ", "
                << values.y[i] << ", "
@@ -510,6 +839,13 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
          */
         dump_raw(current, values);
       }
+      void summarize(const float_sylph_t &current, const M_Observer_t::values_t &values) const {
+        for(int i(0); i < 4; i++){
+          summary.add('M', 0, values.x[i]);
+          summary.add('M', 1, values.y[i]);
+          summary.add('M', 2, values.z[i]);
+        }
+      }
       HandlerM() : formatter(&HandlerM::dump_raw) {}
     } handler_M;
     /**
@@ -525,11 +861,16 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
         float_sylph_t current(StreamProcessor::get_corrected_ITOW(observer));
         if(!options.is_time_in_range(current)){return;}
         
+        if(summary.is_active()){
+          summary.sample('N', current);
+          return;
+        }
+        
         switch(observer.kind()){
           case 0: {
             N_Observer_t::navdata_t values(observer.fetch_navdata());
             
-            options.out() << options.format_time(values.itow) << ", "
+            options.out('N') << options.format_time(values.itow) << ", "
                 << values.longitude << ", "
                 << values.latitude << ", "
                 << values.altitude << ", "
@@ -599,12 +940,41 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
             "for acceleration, angular speed, pressure, and temperature, respectively."
             << endl;
       }
+      if(summary.is_active()){
+        handler_A.formatter = &HandlerA::summarize;
+        handler_P.formatter = &HandlerP::summarize;
+        handler_M.formatter = &HandlerM::summarize;
+        if(options.physical_converter.is_active){
+          static const char *labels_A[] = {
+              "accel_x", "accel_y", "accel_z", "gyro_x", "gyro_y", "gyro_z"};
+          summary.set_labels('A', labels_A);
+        }else{
+          static const char *labels_A[] = {
+              "ch0", "ch1", "ch2", "ch3", "ch4", "ch5", "ch6", "ch7", "temperature"};
+          summary.set_labels('A', labels_A);
+        }
+        static const char *labels_G[] = {
+            "h_acc", "v_acc", "speed_acc", "fix_type", "satellites"};
+        summary.set_labels('G', labels_G);
+        static const char *labels_M[] = {"x", "y", "z"};
+        summary.set_labels('M', labels_M);
+        if(options.page_P_altitude > 0){
+          static const char *labels_P[] = {"pressure", "temperature", "altitude"};
+          summary.set_labels('P', labels_P);
+        }else{
+          static const char *labels_P[] = {"pressure", "temperature"};
+          summary.set_labels('P', labels_P);
+        }
+      }
 
         int read_count;
       while(true){
         in.read(buffer, SYLPHIDE_PAGE_SIZE);
         read_count = in.gcount();
-        if(in.fail() || (read_count == 0)){return;}
+        if(in.fail() || (read_count == 0)){
+          handler_P.flush();
+          return;
+        }
         invoked++;
       
         if(options.debug_level){
@@ -623,6 +993,26 @@ class StreamProcessor : public SylphideProcessor<float_sylph_t> {
           }
         }
       
+        if(handler_P.pending()){
+          /* Batched P samples are flushed only when the page output
+           * must be ordered with them, i.e., the page is written to the same stream
+           * or the summary is taken, or when the local time conversion may be updated.
+           */
+          bool enabled(false);
+          switch(buffer[0]){
+            case 'A': enabled = options.page_A; break;
+            case 'G': enabled = options.page_G; break;
+            case 'F': enabled = options.page_F; break;
+            case 'M': enabled = options.page_M; break;
+            case 'N': enabled = options.page_N; break;
+            case 'T': enabled = options.page_other; break;
+          }
+          if((enabled && (summary.is_active() || options.shares_out('P', buffer[0])))
+              || ((buffer[0] == 'G') && options.use_calendar_time)){
+            handler_P.flush();
+          }
+        }
+      
         switch(buffer[0]){
 #define assign_case_cnd(type, mark, cnd) \
 case mark: if(cnd){ \
@@ -657,7 +1047,7 @@ break;
                     << (unsigned int)((unsigned char)buffer[i]) << ' ';
               }
               ss << endl;
-              options.out() << ss.str();
+              options.out('T') << ss.str();
             }
           }
           break;
@@ -702,12 +1092,16 @@ int main(int argc, char *argv[]){
   }
   
   options.out().precision(10);
+  options.open_page_out();
+  summary.window = options.summary_window;
   if(options.in_sylphide){
     SylphideIStream sylph_in(options.spec2istream(argv[log_index]), SYLPHIDE_PAGE_SIZE);
     processor.process(sylph_in);
   }else{
     processor.process(options.spec2istream(argv[log_index]));
   }
+  summary.flush();
+  options.close_page_out();
   
   return 0;
 }
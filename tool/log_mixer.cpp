@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Log mixer, which merges external UBX data into a NinjaScan log in GPS time order.
+ *
+ * Usage: log_mixer [options] log.dat [gps.ubx ...]
+ *
+ * Pages of log.dat and UBX packets of the external streams are merged
+ * in the order of GPS time of week, and written as a new log.
+ * UBX packets are grouped into epochs by their time stamps,
+ * and each epoch is repackaged into G pages (a 'G' header and 31 bytes payload),
+ * whose last page is padded with zeros.
+ * A packet without time stamp belongs to the epoch of the preceding packet.
+ * A page of the log without time stamp, such as a G page, takes the time of the preceding page.
+ * For the same time, the log is prior to the external streams,
+ * which are prior in the order of the arguments.
+ * All inputs are read in large blocks, and the memory usage is bounded
+ * regardless of their length.
+ * This is a native replacement of log_mixer.rb for UBX inputs.
+ *
+ * Options:
+ *   --ubx=(file)
+ *      adds an external UBX stream. It is equivalent to the 2nd and later arguments.
+ *   --ubx_log=(file)
+ *      adds UBX data in G pages of another log.
+ *   --ubx_sylphide=(file)
+ *      adds UBX data in G pages of another log, which is encapsulated in SylphideProtocol.
+ *   --delay=(sec)
+ *      specifies the delay added to time stamps of the external streams following it.
+ *      The default is 0.
+ *   --base_G=(on|off)
+ *      specifies whether G pages of log.dat are retained. The default is on.
+ *   --in_sylphide, --out=(file), etc.
+ *      are common with other tools. The default output is (log)_mixed.dat.
+ */
+
+#if defined(_MSC_VER) && _MSC_VER >= 1400
+#define _USE_MATH_DEFINES
+#endif
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cfloat>
+#include <exception>
+
+#define IS_LITTLE_ENDIAN 1
+#include "SylphideStream.h"
+#include "SylphideProcessor.h"
+
+typedef double float_sylph_t;
+#include "analyze_common.h"
+
+using namespace std;
+
+struct Options : public GlobalOptions<float_sylph_t> {
+  typedef GlobalOptions<float_sylph_t> super_t;
+
+  struct external_t {
+    enum kind_t {UBX, LOG, SYLPHIDE} kind;
+    const char *spec;
+    float_sylph_t delay; ///< [s]
+  };
+  std::vector<external_t> externals;
+  float_sylph_t delay; ///< delay applied to externals specified after it
+  bool base_G; ///< True when G pages of the base log are retained
+
+  Options()
+      : super_t(), externals(), delay(0), base_G(true) {}
+  ~Options(){}
+
+  void add_external(const external_t::kind_t &kind, const char *spec){
+    external_t external = {kind, spec, delay};
+    externals.push_back(external);
+  }
+
+  /**
+   * Check the specification given by the command line
+   *
+   * @param spec command
+   * @return (bool) true when the spec is accepted, otherwise false
+   */
+  bool check_spec(const char *spec){
+    using std::cerr;
+    using std::endl;
+
+    static const char *available_keys[] = {
+        "out",
+        "in_sylphide"};
+
+    const char *value;
+    if((value = get_value(spec, "ubx", false))){
+      add_external(external_t::UBX, value);
+      return true;
+    }
+    if((value = get_value(spec, "ubx_log", false))){
+      add_external(external_t::LOG, value);
+      return true;
+    }
+    if((value = get_value(spec, "ubx_sylphide", false))){
+      add_external(external_t::SYLPHIDE, value);
+      return true;
+    }
+    if((value = get_value(spec, "delay", false))){
+      delay = std::atof(value);
+      cerr << "delay" << ": " << delay << endl;
+      return true;
+    }
+    if((value = get_value(spec, "base_G"))){
+      base_G = is_true(value);
+      cerr << "base_G" << ": " << (base_G ? "true" : "false") << endl;
+      return true;
+    }
+
+    for(std::size_t i(0);
+        i < sizeof(available_keys) / sizeof(available_keys[0]);
+        i++){
+      if((value = get_value(spec, available_keys[i]))){
+        return super_t::check_spec(spec);
+      }
+    }
+
+    return false;
+  }
+} options;
+
+/**
+ * Source of pages, which are ordered by GPS time within the source.
+ * next() prepares the next chunk of pages, which is valid until the next call.
+ */
+class PageSource {
+  protected:
+    static bool time_reference_valid;
+    static float_sylph_t time_reference;
+    bool time_valid;
+    float_sylph_t time_last;
+
+    /**
+     * Convert time of week to the continuous time across week rollovers.
+     * The first time stamp of a source is aligned with the first one among all sources.
+     */
+    float_sylph_t unwrap(float_sylph_t t){
+      static const float_sylph_t week(60 * 60 * 24 * 7);
+      if(time_valid || time_reference_valid){
+        float_sylph_t base(time_valid ? time_last : time_reference);
+        while(t < base - week / 2){t += week;}
+        while(t > base + week / 2){t -= week;}
+      }else{
+        time_reference = t;
+        time_reference_valid = true;
+      }
+      time_valid = true;
+      return (time_last = t);
+    }
+
+  public:
+    float_sylph_t time; ///< GPS time of the current chunk [s]
+    const char *data; ///< current chunk of pages
+    std::size_t size; ///< size of the current chunk in bytes
+    int pages; ///< number of pages supplied so far
+
+    PageSource()
+        : time_valid(false), time_last(0),
+        time(-DBL_MAX), data(NULL), size(0), pages(0) {}
+    virtual ~PageSource(){}
+    /**
+     * @return (bool) true when a chunk is available, otherwise false (end of the stream)
+     */
+    virtual bool next() = 0;
+};
+bool PageSource::time_reference_valid(false);
+float_sylph_t PageSource::time_reference(0);
+
+/**
+ * Pages of a NinjaScan log, each of which is a chunk.
+ * Time of a page is taken from its ITOW field.
+ */
+class LogSource : public PageSource {
+  protected:
+    std::istream &in;
+    std::vector<char> block;
+    int block_pages, index;
+    bool with_G;
+
+  public:
+    LogSource(std::istream &in_, const bool &with_G_ = true)
+        : PageSource(), in(in_),
+        block(SYLPHIDE_PAGE_SIZE * 0x1000), block_pages(0), index(0),
+        with_G(with_G_) {
+      size = SYLPHIDE_PAGE_SIZE;
+    }
+    bool next(){
+      while(true){
+        if(index >= block_pages){
+          if(in.eof()){return false;}
+          in.read(&block[0], block.size());
+          block_pages = in.gcount() / SYLPHIDE_PAGE_SIZE; // An incomplete page is skipped.
+          index = 0;
+          if(block_pages == 0){return false;}
+        }
+        data = &block[SYLPHIDE_PAGE_SIZE * index++];
+        switch(data[0]){
+          case 'A':
+            time = unwrap(1E-3 * le_char4_2_num<unsigned int>(data[2]));
+            break;
+          case 'F':
+          case 'P':
+          case 'M':
+          case 'N':
+            time = unwrap(1E-3 * le_char4_2_num<unsigned int>(data[4]));
+            break;
+          case 'G':
+            if(!with_G){continue;}
+            break;
+        }
+        pages++;
+        return true;
+      }
+    }
+};
+
+/**
+ * UBX packets of an external stream, which are framed by G_Packet_Observer.
+ * Packets are grouped into an epoch by their time stamps,
+ * and each epoch is repackaged into a chunk of G pages.
+ * The input is either raw UBX or payloads of G pages in a log.
+ */
+class UBXSource : public PageSource {
+  protected:
+    typedef SylphideProcessor<float_sylph_t>::G_Observer_t G_Observer_t;
+    std::istream &in;
+    bool paged; ///< True when the input is a log
+    float_sylph_t delay;
+    std::vector<char> block;
+    std::size_t block_begin, block_end;
+    G_Observer_t observer;
+    std::vector<char> packet; ///< a packet to be processed
+    bool packet_pending; ///< True when packet belongs to the next epoch
+    std::vector<char> epoch; ///< packets of an epoch
+    std::vector<char> chunk; ///< G pages of an epoch
+
+    static const unsigned int payload_size = SYLPHIDE_PAGE_SIZE - 1;
+
+    bool fill(){
+      if(block_begin >= block_end){
+        if(in.eof()){return false;}
+        in.read(&block[0], block.size());
+        block_begin = 0;
+        block_end = in.gcount();
+        if(paged){ // payloads of G pages are gathered.
+          std::size_t pages(block_end / SYLPHIDE_PAGE_SIZE);
+          block_end = 0;
+          for(std::size_t i(0); i < pages; i++){
+            const char *page(&block[SYLPHIDE_PAGE_SIZE * i]);
+            if(page[0] != 'G'){continue;}
+            std::memmove(&block[block_end], page + 1, payload_size);
+            block_end += payload_size;
+          }
+        }
+        if(block_end == 0){return !in.eof();}
+      }
+      block_begin += observer.write(&block[block_begin], block_end - block_begin);
+      return true;
+    }
+
+    /**
+     * Extract the next valid packet.
+     *
+     * @return (bool) true when extracted, otherwise false (end of the stream)
+     */
+    bool fetch_packet(){
+      while(true){
+        if(observer.ready()){
+          bool valid(observer.validate());
+          if(valid){
+            packet.resize(observer.current_packet_size());
+            observer.inspect(&packet[0], packet.size());
+          }
+          observer.seek_next(); // The packet, or a byte of a broken one, is skipped.
+          if(valid){return true;}
+          continue;
+        }
+        observer.seek_next(); // Leading garbage is skipped.
+        if(!fill()){return false;}
+      }
+    }
+
+    /**
+     * @param itow_ms (output) time stamp [ms]
+     * @return (bool) true when packet has a time stamp
+     */
+    bool packet_time(unsigned int &itow_ms) const {
+      if(packet.size() < 6 + 4 + 2){return false;}
+      switch(((unsigned char)packet[2] << 8) | (unsigned char)packet[3]){
+        case 0x0101: case 0x0102: case 0x0103: case 0x0104:
+        case 0x0106: case 0x0108: case 0x0111: case 0x0112:
+        case 0x0120: case 0x0121: case 0x0122:
+        case 0x0130: case 0x0131: case 0x0132:
+        case 0x0210: case 0x0220:
+          itow_ms = le_char4_2_num<unsigned int>(packet[6]);
+          return true;
+      }
+      return false;
+    }
+
+  public:
+    UBXSource(std::istream &in_, const bool &paged_, const float_sylph_t &delay_)
+        : PageSource(), in(in_), paged(paged_), delay(delay_),
+        block(SYLPHIDE_PAGE_SIZE * 0x800), block_begin(0), block_end(0),
+        observer(0x10000),
+        packet(), packet_pending(false), epoch(), chunk() {}
+    bool next(){
+      epoch.clear();
+      bool timed(false);
+      unsigned int itow_ms(0);
+      if(packet_pending){
+        timed = packet_time(itow_ms);
+        epoch.insert(epoch.end(), packet.begin(), packet.end());
+        packet_pending = false;
+      }
+      while(fetch_packet()){
+        unsigned int itow_ms_new;
+        if(packet_time(itow_ms_new)){
+          if(!timed){
+            timed = true;
+            itow_ms = itow_ms_new;
+          }else if(itow_ms_new != itow_ms){
+            packet_pending = true;
+            break;
+          }
+        }
+        epoch.insert(epoch.end(), packet.begin(), packet.end());
+      }
+      if(epoch.empty()){return false;}
+      if(timed){ // Otherwise, the trailing packets take the previous time.
+        time = unwrap(1E-3 * itow_ms + delay);
+      }
+
+      // Repackage to G pages
+      std::size_t n((epoch.size() + payload_size - 1) / payload_size);
+      chunk.assign(SYLPHIDE_PAGE_SIZE * n, 0);
+      for(std::size_t i(0); i < n; i++){
+        std::size_t offset(payload_size * i);
+        chunk[SYLPHIDE_PAGE_SIZE * i] = 'G';
+        std::memcpy(&chunk[SYLPHIDE_PAGE_SIZE * i + 1], &epoch[offset],
+            min_macro(payload_size, epoch.size() - offset));
+      }
+      data = &chunk[0];
+      size = chunk.size();
+      pages += n;
+      return true;
+    }
+};
+
+/**
+ * Merge sources in the order of time, and write chunks in large blocks.
+ * For the same time, a source having a smaller index is prior.
+ */
+void mix(std::vector<PageSource *> &sources, std::ostream &out){
+  std::vector<char> buf(0x100000);
+  std::size_t buf_size(0);
+
+  std::vector<PageSource *> active;
+  for(std::vector<PageSource *>::iterator it(sources.begin()); it != sources.end(); ++it){
+    if((*it)->next()){active.push_back(*it);}
+  }
+
+  while(!active.empty()){
+    // Find the first source, and the limit until which it can be written successively.
+    std::size_t first(0);
+    for(std::size_t i(1); i < active.size(); i++){
+      if(active[i]->time < active[first]->time){first = i;}
+    }
+    std::size_t second(active.size()); // active.size() means no other source
+    for(std::size_t i(0); i < active.size(); i++){
+      if(i == first){continue;}
+      if((second == active.size()) || (active[i]->time < active[second]->time)){second = i;}
+    }
+
+    PageSource &src(*active[first]);
+    bool available(true);
+    do{
+      if(buf_size + src.size > buf.size()){
+        out.write(&buf[0], buf_size);
+        buf_size = 0;
+        if(src.size > buf.size()){
+          out.write(src.data, src.size);
+          continue;
+        }
+      }
+      std::memcpy(&buf[buf_size], src.data, src.size);
+      buf_size += src.size;
+    }while((available = src.next())
+        && ((second == active.size())
+          || (src.time < active[second]->time)
+          || ((src.time == active[second]->time) && (first < second))));
+
+    if(!available){active.erase(active.begin() + first);}
+  }
+  out.write(&buf[0], buf_size);
+  out.flush();
+}
+
+int main(int argc, char *argv[]){
+
+  cerr << "NinjaScan log mixer to merge external UBX data." << endl;
+  cerr << "Usage: " << argv[0] << " [options] log.dat [gps.ubx ...]" << endl;
+  if(argc < 2){
+    cerr << "Error: too few arguments; " << argc << " < min(2)" << endl;
+    return -1;
+  }
+
+  int log_index(0);
+  options._out = NULL;
+
+  // check options
+  for(int i(1); i < argc; i++){
+    if(options.check_spec(argv[i])){continue;}
+    if(std::strstr(argv[i], "--") == argv[i]){
+      cerr << "Unknown option!! : " << argv[i] << endl;
+      return -1;
+    }
+    if(log_index == 0){
+      log_index = i;
+    }else{ // the 2nd and later arguments are external UBX streams
+      options.add_external(Options::external_t::UBX, argv[i]);
+    }
+  }
+  if(log_index == 0){
+    cerr << "Error: no log file!!" << endl;
+    return -1;
+  }
+
+  if(!options._out){
+    string out_fname(argv[log_index]);
+    string::size_type index = out_fname.find_last_of('.');
+    if(index != string::npos){
+      out_fname.erase(index);
+    }
+    out_fname.append("_mixed.dat");
+    cerr << "Output: ";
+    options._out = &(options.spec2ostream(out_fname.c_str(), true));
+  }
+
+  std::vector<SylphideIStream *> sylphide_ins;
+  std::vector<PageSource *> sources;
+
+  cerr << "Log: ";
+  if(options.in_sylphide){
+    sylphide_ins.push_back(new SylphideIStream(
+        options.spec2istream(argv[log_index]), SYLPHIDE_PAGE_SIZE));
+    sources.push_back(new LogSource(*sylphide_ins.back(), options.base_G));
+  }else{
+    sources.push_back(new LogSource(
+        options.spec2istream(argv[log_index]), options.base_G));
+  }
+  for(std::vector<Options::external_t>::const_iterator it(options.externals.begin());
+      it != options.externals.end();
+      ++it){
+    cerr << "UBX (delay " << it->delay << " [s]): ";
+    std::istream &in(options.spec2istream(it->spec));
+    switch(it->kind){
+      case Options::external_t::UBX:
+        sources.push_back(new UBXSource(in, false, it->delay));
+        break;
+      case Options::external_t::LOG:
+        sources.push_back(new UBXSource(in, true, it->delay));
+        break;
+      case Options::external_t::SYLPHIDE:
+        sylphide_ins.push_back(new SylphideIStream(in, SYLPHIDE_PAGE_SIZE));
+        sources.push_back(new UBXSource(*sylphide_ins.back(), true, it->delay));
+        break;
+    }
+  }
+
+  mix(sources, options.out());
+
+  cerr << "Pages (log, external...) = ";
+  for(std::size_t i(0); i < sources.size(); i++){
+    cerr << (i > 0 ? ", " : "") << sources[i]->pages;
+    delete sources[i];
+  }
+  cerr << endl;
+  for(std::size_t i(0); i < sylphide_ins.size(); i++){
+    delete sylphide_ins[i];
+  }
+
+  return 0;
+}
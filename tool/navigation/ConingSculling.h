@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __CONING_SCULLING_H__
+#define __CONING_SCULLING_H__
+
+/** @file
+ * @brief Accumulation of IMU samples with coning and sculling compensation
+ */
+
+#include "param/vector3.h"
+
+/**
+ * @brief Accumulator of IMU samples with coning and sculling compensation
+ *
+ * Increments of angle and velocity of the samples in a block are accumulated
+ * in the body frame at the beginning of the block,
+ * where the non-commutativity of rotation (coning),
+ * and the rotation of the specific force during the block (rotation and sculling,
+ * including the second order term of the rotation) are compensated with the algorithm using the previous sample
+ * (Savage, "Strapdown Inertial Navigation Integration Algorithm Design", 1998).
+ * The resultant rotation vector and velocity increment are converted to
+ * equivalent angular speed and acceleration, i.e., divided by the block interval,
+ * in order to be fed to INS::update(accel, gyro, deltaT) once per block.
+ *
+ * @param FloatT precision
+ */
+template <class FloatT>
+class ConingScullingAccumulator {
+  public:
+    typedef FloatT float_t;
+    typedef Vector3<float_t> vec3_t;
+  protected:
+    vec3_t alpha;       ///< accumulated angle increment
+    vec3_t upsilon;     ///< accumulated velocity increment
+    vec3_t beta;        ///< coning compensation
+    vec3_t sculling;    ///< sculling compensation
+    vec3_t rotation2;   ///< second order term of the rotation of the specific force
+    vec3_t d_theta_prev, d_v_prev; ///< increments of the previous sample
+    float_t m_elapsed;
+    int m_samples;
+  public:
+    ConingScullingAccumulator() {reset();}
+
+    /**
+     * Start a new block.
+     * The previous sample is kept to be used in the compensation of the next block,
+     * unless keep_previous is false.
+     */
+    void reset(const bool &keep_previous = true){
+      alpha = vec3_t();
+      upsilon = vec3_t();
+      beta = vec3_t();
+      sculling = vec3_t();
+      rotation2 = vec3_t();
+      if(!keep_previous){
+        d_theta_prev = vec3_t();
+        d_v_prev = vec3_t();
+      }
+      m_elapsed = 0;
+      m_samples = 0;
+    }
+
+    /**
+     * Add a sample.
+     *
+     * @param accel specific force [m/s^2]
+     * @param gyro angular speed [rad/s]
+     * @param deltaT interval of the sample [s]
+     */
+    void add(const vec3_t &accel, const vec3_t &gyro, const float_t &deltaT){
+      vec3_t d_theta(gyro * deltaT), d_v(accel * deltaT);
+      vec3_t alpha_ref(alpha + d_theta_prev / 6), upsilon_ref(upsilon + d_v_prev / 6);
+      beta = beta + (alpha_ref * d_theta) / 2;
+      sculling = sculling + ((alpha_ref * d_v) + (upsilon_ref * d_theta)) / 2;
+      vec3_t alpha_mid(alpha + d_theta / 2);
+      rotation2 = rotation2 + (alpha_mid * (alpha_mid * d_v)) / 2;
+      alpha = alpha + d_theta;
+      upsilon = upsilon + d_v;
+      d_theta_prev = d_theta;
+      d_v_prev = d_v;
+      m_elapsed += deltaT;
+      ++m_samples;
+    }
+
+    int samples() const {return m_samples;}
+    const float_t &elapsed() const {return m_elapsed;}
+
+    /**
+     * @return (vec3_t) rotation vector over the block
+     */
+    vec3_t delta_theta() const {return alpha + beta;}
+    /**
+     * @return (vec3_t) velocity increment over the block
+     * in the body frame at the beginning of the block
+     */
+    vec3_t delta_v() const {
+      return upsilon + (alpha * upsilon) / 2 + sculling + rotation2;
+    }
+
+    vec3_t gyro() const {return delta_theta() / m_elapsed;} ///< equivalent angular speed
+    vec3_t accel() const {return delta_v() / m_elapsed;} ///< equivalent acceleration
+};
+
+#endif /* __CONING_SCULLING_H__ */
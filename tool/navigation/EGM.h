@@ -56,10 +56,61 @@ struct EGM_Generic {
 
   protected:
 
+  /**
+   * Coefficients of the recursion of the fully normalized associated Legendre functions,
+   * which depend only on degree and order, therefore are computed once per N_MAX on first use.
+   * P_bar(n, m) = a * cos(phi) * P_bar(n-1, m-1) + b * sin(phi) * P_bar(n-1, m) - c * P_bar(n-2, m),
+   * and its latitude derivative is -m * tan(phi) * P_bar(n, m) + d * P_bar(n, m+1).
+   */
+  template <int N_MAX>
+  struct recursion_t {
+    struct item_t {
+      FloatT a, b, c, d;
+    };
+    item_t items[(N_MAX + 1) * (N_MAX + 2) / 2]; ///< ordered by degree, then order
+    static int index(const int &n, const int &m){
+      return n * (n + 1) / 2 + m;
+    }
+    const item_t &operator()(const int &n, const int &m) const {
+      return items[index(n, m)];
+    }
+    recursion_t(){
+      for(int n(0); n <= N_MAX; ++n){
+        for(int m(0); m <= n; ++m){
+          item_t &item(items[index(n, m)]);
+          item.a = item.b = item.c = 0;
+          item.d = (m == n) ? 0 : std::sqrt(FloatT(n - m) * (n + m + 1) / (m == 0 ? 2 : 1));
+          if(n < 2){continue;}
+          if(m == n){
+            item.a = std::sqrt(0.5 / n + 1);
+          }else if(m == n - 1){
+            item.a = std::sqrt(FloatT((2 * n + 1) * (n - 1)) / 2) * std::sqrt(n == 2 ? 2.0 : 1.0) / n;
+            item.b = std::sqrt(FloatT(2 * n + 1)) / n;
+          }else if(m == 0){
+            item.b = std::sqrt(FloatT(2 * n + 1) / (2 * n - 1)) * (2 * n - 1) / n;
+            item.c = std::sqrt(FloatT(2 * n + 1) / (2 * n - 3)) * (n - 1) / n;
+          }else{ // 0 < m < n-1
+            FloatT k(std::sqrt(FloatT(2 * n + 1) / (n + m)) / n);
+            item.a = std::pow(FloatT((2 * n - 1) * (n + m - 1)), -0.5) * std::sqrt(m == 1 ? 2.0 : 1.0)
+                * m * (2 * n - 1) * k;
+            item.b = std::sqrt(FloatT(n - m) / (2 * n - 1)) * (2 * n - 1) * k;
+            item.c = std::sqrt(FloatT((n - m) * (n - m - 1)) / ((2 * n - 3) * (n + m - 1)))
+                * (n - 1) * k;
+          }
+        }
+      }
+    }
+    static const recursion_t &get(){
+      static const recursion_t res;
+      return res;
+    }
+  };
+
   template <int N_MAX>
   struct p_bar_nm_t{
     unsigned int n_current;
     const FloatT sp, cp;
+    const recursion_t<N_MAX> &recursion;
     FloatT p_bar_cache[3][N_MAX + 1];
     FloatT *p_bar[3];
 
@@ -68,26 +119,21 @@ struct EGM_Generic {
         FloatT *p_bar_n,
         const FloatT *p_bar_n1, const FloatT *p_bar_n2) const {
 
+      const typename recursion_t<N_MAX>::item_t *item(&recursion(n, 0));
       { // m = 0
-        FloatT b(std::sqrt(FloatT(2 * n + 1) / (2 * n - 1)));
-        FloatT c(std::sqrt(FloatT(2 * n + 1) / (2 * n - 3)));
-        p_bar_n[0] = (p_bar_n1[0] * sp * (2 * n - 1) * b - p_bar_n2[0] * (n - 1) * c) / n;
+        p_bar_n[0] = item->b * sp * p_bar_n1[0] - item->c * p_bar_n2[0];
+        ++item;
       }
-      for(int m(1); m <= n - 2; ++m){ // 0 < m < n-1
-        FloatT a(std::pow(((2 * n - 1) * (n + m - 1)), -0.5) * std::sqrt(m == 1 ? 2.0 : 1.0));
-        FloatT b(std::sqrt(FloatT(n - m) / (2 * n - 1)));
-        FloatT c(std::sqrt(FloatT((n - m) * (n - m - 1)) / ((2 * n - 3) * (n + m - 1))));
-        p_bar_n[m] = (p_bar_n1[m - 1] * m * (2 * n - 1) * cp * a
-            + (p_bar_n1[m] * sp * (2 * n - 1) * b - p_bar_n2[m] * (n - 1) * c))
-              / n * std::sqrt(FloatT(2 * n + 1) / (n + m));
+      for(int m(1); m <= n - 2; ++m, ++item){ // 0 < m < n-1
+        p_bar_n[m] = item->a * cp * p_bar_n1[m - 1]
+            + item->b * sp * p_bar_n1[m] - item->c * p_bar_n2[m];
       }
       { // m = n-1
-        FloatT a(std::sqrt(FloatT((2 * n + 1) * (n - 1)) / 2) * std::sqrt(n == 2 ? 2.0 : 1.0));
-        FloatT b(std::sqrt(FloatT(2 * n + 1)));
-        p_bar_n[n - 1] = (p_bar_n1[n - 2] * cp * a + p_bar_n1[n - 1] * sp * b) / n;
+        p_bar_n[n - 1] = item->a * cp * p_bar_n1[n - 2] + item->b * sp * p_bar_n1[n - 1];
+        ++item;
       }
       { // m = n
-        p_bar_n[n] = p_bar_n1[n - 1] * cp * std::sqrt(0.5 / n + 1);
+        p_bar_n[n] = item->a * cp * p_bar_n1[n - 1];
       }
     }
     p_bar_nm_t<N_MAX> &operator++(){
@@ -101,7 +147,8 @@ struct EGM_Generic {
       return *this;
     }
     p_bar_nm_t(const FloatT &phi)
-        : n_current(0), sp(std::sin(phi)), cp(std::cos(phi)) {
+        : n_current(0), sp(std::sin(phi)), cp(std::cos(phi)),
+        recursion(recursion_t<N_MAX>::get()) {
       p_bar[0] = p_bar_cache[0];
       p_bar[1] = p_bar_cache[1];
       p_bar[2] = p_bar_cache[2];
@@ -126,6 +173,7 @@ struct EGM_Generic {
     unsigned int n_max;
     FloatT a_r_n[N_MAX + 1];
     FloatT p_bar[N_MAX + 1][N_MAX + 1];
+    FloatT tan_phi;
     FloatT c_ml[N_MAX + 1], s_ml[N_MAX + 1];
     cache_t() : n_max(N_MAX) {}
     cache_t &update_a_r(const FloatT &a_r){
@@ -141,6 +189,7 @@ struct EGM_Generic {
       for(int n(4); n <= N_MAX; n++){
         p_bar_gen.next(n, p_bar[n], p_bar[n - 1], p_bar[n - 2]);
       }
+      tan_phi = std::tan(phi);
       return *this;
     }
     cache_t &update_lambda(const FloatT &lambda){
@@ -162,9 +211,10 @@ struct EGM_Generic {
   struct buffer_t : public p_bar_nm_t<N_MAX> {
     const FloatT &a_r_orig;
     FloatT a_r_n;
+    FloatT tan_phi;
     FloatT c_ml[N_MAX + 1], s_ml[N_MAX + 1];
     buffer_t(const FloatT &a_r, const FloatT &phi, const FloatT &lambda)
-        : p_bar_nm_t<N_MAX>(phi), a_r_orig(a_r), a_r_n(a_r) {
+        : p_bar_nm_t<N_MAX>(phi), a_r_orig(a_r), a_r_n(a_r), tan_phi(std::tan(phi)) {
       for(int m(0); m <= N_MAX; ++m){
         c_ml[m] = std::cos(lambda * m);
         s_ml[m] = std::sin(lambda * m);
@@ -177,6 +227,50 @@ struct EGM_Generic {
     }
   };
 
+  /**
+   * Coefficients rearranged by order, then degree, with the recursion coefficients
+   * along degree, for Clenshaw summation.
+   * Each column of order m consists of degree m to N_MAX + 2, whose last two items are zero
+   * in order to terminate the summation without branch.
+   */
+  template <int N_MAX>
+  struct clenshaw_table_t {
+    struct item_t {
+      FloatT c_bar, s_bar; ///< C_bar(n, m), S_bar(n, m)
+      FloatT dc_bar, ds_bar; ///< d(n, m-1) * C_bar(n, m-1), d(n, m-1) * S_bar(n, m-1) for latitude derivative
+      FloatT alpha, beta; ///< P_bar(n, m) = alpha * sin(phi) * P_bar(n-1, m) - beta * P_bar(n-2, m)
+    };
+    item_t items[(N_MAX + 1) * (N_MAX + 6) / 2];
+    int offset[N_MAX + 1]; ///< index of the item of (n, m) is offset[m] + (n - m)
+    FloatT sectoral[N_MAX + 1]; ///< P_bar(m, m) = sectoral[m] * cos(phi) * P_bar(m-1, m-1)
+    clenshaw_table_t(const coefficients_t coefs[]){
+      const recursion_t<N_MAX> &recursion(recursion_t<N_MAX>::get());
+      for(int m(0), i(0); m <= N_MAX; ++m){
+        offset[m] = i;
+        sectoral[m] = (m == 0) ? 1 : std::sqrt(FloatT(2 * m + 1) / (m == 1 ? 1 : (2 * m)));
+        for(int n(m); n <= N_MAX + 2; ++n, ++i){
+          item_t &item(items[i]);
+          item.c_bar = item.s_bar = item.dc_bar = item.ds_bar = item.alpha = item.beta = 0;
+          if(n > N_MAX){continue;}
+          if(n > m){
+            item.alpha = std::sqrt(FloatT((2 * n - 1) * (2 * n + 1)) / ((n - m) * (n + m)));
+            item.beta = std::sqrt(FloatT((2 * n + 1) * (n + m - 1) * (n - m - 1))
+                / ((n - m) * (n + m) * (2 * n - 3)));
+          }
+          if(n < 2){continue;}
+          const coefficients_t *coef(&coefs[n * (n + 1) / 2 - 3 + m]);
+          item.c_bar = coef->c_bar;
+          item.s_bar = coef->s_bar;
+          if(m > 0){
+            FloatT d(recursion(n, m - 1).d);
+            item.dc_bar = d * coef[-1].c_bar;
+            item.ds_bar = d * coef[-1].s_bar;
+          }
+        }
+      }
+    }
+  };
+
   struct calc_res_t {
     FloatT potential, gravity_r, gravity_phi, gravity_lambda;
   };
@@ -188,6 +282,7 @@ struct EGM_Generic {
       const cache_t<N_MAX> &x) {
 
     calc_res_t sum_n = {1, 1, 0, 0}, sum_m;
+    const recursion_t<N_MAX> &recursion(recursion_t<N_MAX>::get());
     for(int n(2), coef_i(0); n <= x.n_max; n++){
       calc_res_t sum_m = {0, 0, 0, 0};
       for(int m(0); m <= n; m++, coef_i++){
@@ -200,8 +295,8 @@ struct EGM_Generic {
               * (coefs[coef_i].c_bar * x.c_ml[m] + coefs[coef_i].s_bar * x.s_ml[m]);
         }
         if(GravityPhi){
-          sum_m.gravity_phi += (-x.p_bar[n][m] * m * x.c_ml[1] * x.s_ml[1]
-                + ((m == n) ? 0 : std::sqrt(FloatT(n - m) * (n + m + 1)) * x.p_bar[n][m+1]))
+          sum_m.gravity_phi += (-x.p_bar[n][m] * m * x.tan_phi
+                + ((m == n) ? 0 : recursion(n, m).d * x.p_bar[n][m+1]))
               * (coefs[coef_i].c_bar * x.c_ml[m] + coefs[coef_i].s_bar * x.s_ml[m]);
         }
         if(GravityLambda){
@@ -223,6 +318,7 @@ struct EGM_Generic {
       const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
 
     calc_res_t sum_n = {1, 1, 0, 0}, sum_m; buffer_t<N_MAX> x(a_r, phi, lambda);
+    const recursion_t<N_MAX> &recursion(recursion_t<N_MAX>::get());
     for(int n(2), coef_i(0); n <= N_MAX; n++){
       calc_res_t sum_m = {0, 0, 0, 0}; ++x;
       for(int m(0); m <= n; m++, coef_i++){
@@ -235,8 +331,8 @@ struct EGM_Generic {
               * (coefs[coef_i].c_bar * x.c_ml[m] + coefs[coef_i].s_bar * x.s_ml[m]);
         }
         if(GravityPhi){
-          sum_m.gravity_phi += (-x.p_bar[0][m] * m * x.c_ml[1] * x.s_ml[1]
-                + ((m == n) ? 0 : std::sqrt(FloatT(n - m) * (n + m + 1)) * x.p_bar[0][m+1]))
+          sum_m.gravity_phi += (-x.p_bar[0][m] * m * x.tan_phi
+                + ((m == n) ? 0 : recursion(n, m).d * x.p_bar[0][m+1]))
               * (coefs[coef_i].c_bar * x.c_ml[m] + coefs[coef_i].s_bar * x.s_ml[m]);
         }
         if(GravityLambda){
@@ -252,6 +348,101 @@ struct EGM_Generic {
     return sum_n;
   }
 
+  /**
+   * Clenshaw summation along degree for each order, which needs neither
+   * the associated Legendre functions nor trigonometric functions of each order.
+   * BLOCK points are processed simultaneously in order to share coefficients loaded from memory,
+   * and the innermost loops over the points are subject to vectorization.
+   */
+  template <int N_MAX, int BLOCK,
+      bool Potential, bool GravityR, bool GravityPhi, bool GravityLambda>
+  static void calc_dimless_block(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT a_r[], const FloatT phi[], const FloatT lambda[],
+      calc_res_t res[]) {
+
+    static const bool use_v(Potential || GravityPhi || GravityLambda);
+    FloatT t_q[BLOCK], u_q[BLOCK], q2[BLOCK], tan_phi[BLOCK], cl2[BLOCK];
+    FloatT c_m[BLOCK], s_m[BLOCK], c_m1[BLOCK], s_m1[BLOCK]; // cos(m lambda), ..., sin((m-1) lambda)
+    FloatT p_mm[BLOCK]; // (a/r)^m * P_bar(m, m)
+    for(int k(0); k < BLOCK; ++k){
+      FloatT sp(std::sin(phi[k])), cp(std::cos(phi[k]));
+      t_q[k] = sp * a_r[k];
+      u_q[k] = cp * a_r[k];
+      q2[k] = a_r[k] * a_r[k];
+      tan_phi[k] = sp / cp;
+      FloatT cl(std::cos(lambda[k])), sl(std::sin(lambda[k]));
+      cl2[k] = cl * 2;
+      c_m[k] = 1; s_m[k] = 0;
+      c_m1[k] = cl; s_m1[k] = -sl;
+      p_mm[k] = 1;
+      calc_res_t sum = {1, 1, 0, 0};
+      res[k] = sum;
+    }
+    for(int m(0); m <= N_MAX; ++m){
+      if(m > 0){
+        for(int k(0); k < BLOCK; ++k){
+          p_mm[k] *= table.sectoral[m] * u_q[k];
+          FloatT c(cl2[k] * c_m[k] - c_m1[k]), s(cl2[k] * s_m[k] - s_m1[k]);
+          c_m1[k] = c_m[k]; s_m1[k] = s_m[k];
+          c_m[k] = c; s_m[k] = s;
+        }
+      }
+
+      // y(n) = w(n) + alpha(n+1) * t * q * y(n+1) - beta(n+2) * q^2 * y(n+2), from n = N_MAX to m
+      FloatT y1[6][BLOCK], y2[6][BLOCK];
+      for(int j(0); j < 6; ++j){
+        for(int k(0); k < BLOCK; ++k){y1[j][k] = y2[j][k] = 0;}
+      }
+      const typename clenshaw_table_t<N_MAX>::item_t *item(
+          &table.items[table.offset[m] + (N_MAX - m)]);
+      for(int n(N_MAX); n >= m; --n, --item){
+        const FloatT alpha(item[1].alpha), beta(item[2].beta);
+        const FloatT w[6] = {
+            item->c_bar, item->s_bar,
+            item->c_bar * (n + 1), item->s_bar * (n + 1),
+            item->dc_bar, item->ds_bar};
+        for(int j(0); j < 6; ++j){
+          if(((j < 2) && !use_v)
+              || ((j >= 2) && (j < 4) && !GravityR)
+              || ((j >= 4) && !GravityPhi)){continue;}
+          for(int k(0); k < BLOCK; ++k){
+            FloatT y(w[j] + alpha * t_q[k] * y1[j][k] - beta * q2[k] * y2[j][k]);
+            y2[j][k] = y1[j][k];
+            y1[j][k] = y;
+          }
+        }
+      }
+
+      for(int k(0); k < BLOCK; ++k){
+        FloatT v_c(p_mm[k] * y1[0][k]), v_s(p_mm[k] * y1[1][k]);
+        if(Potential){
+          res[k].potential += v_c * c_m[k] + v_s * s_m[k];
+        }
+        if(GravityR){
+          res[k].gravity_r += p_mm[k] * (y1[2][k] * c_m[k] + y1[3][k] * s_m[k]);
+        }
+        if(GravityPhi){
+          res[k].gravity_phi += -m * tan_phi[k] * (v_c * c_m[k] + v_s * s_m[k])
+              + p_mm[k] * (y1[4][k] * c_m1[k] + y1[5][k] * s_m1[k]);
+        }
+        if(GravityLambda){
+          res[k].gravity_lambda += m * (-v_c * s_m[k] + v_s * c_m[k]);
+        }
+      }
+    }
+  }
+  template <int N_MAX,
+      bool Potential, bool GravityR, bool GravityPhi, bool GravityLambda>
+  static calc_res_t calc_dimless(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
+    calc_res_t res;
+    calc_dimless_block<N_MAX, 1,
+        Potential, GravityR, GravityPhi, GravityLambda>(
+        table, &a_r, &phi, &lambda, &res);
+    return res;
+  }
 
   template <int N_MAX>
   static FloatT potential_dimless(
@@ -272,6 +463,15 @@ struct EGM_Generic {
         coefs, a_r, phi, lambda).potential;
   }
   template <int N_MAX>
+  static FloatT potential_dimless(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
+
+    return calc_dimless<N_MAX,
+        true, false, false, false>(
+        table, a_r, phi, lambda).potential;
+  }
+  template <int N_MAX>
   static FloatT gravity_r_dimless(
       const coefficients_t coefs[],
       const cache_t<N_MAX> &x) {
@@ -290,6 +490,15 @@ struct EGM_Generic {
         coefs, a_r, phi, lambda).gravity_r;
   }
   template <int N_MAX>
+  static FloatT gravity_r_dimless(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
+
+    return calc_dimless<N_MAX,
+        false, true, false, false>(
+        table, a_r, phi, lambda).gravity_r;
+  }
+  template <int N_MAX>
   static FloatT gravity_phi_dimless(
       const coefficients_t coefs[],
       const cache_t<N_MAX> &x) {
@@ -308,6 +517,15 @@ struct EGM_Generic {
         coefs, a_r, phi, lambda).gravity_phi;
   }
   template <int N_MAX>
+  static FloatT gravity_phi_dimless(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
+
+    return calc_dimless<N_MAX,
+        false, false, true, false>(
+        table, a_r, phi, lambda).gravity_phi;
+  }
+  template <int N_MAX>
   static FloatT gravity_lambda_dimless(
       const coefficients_t coefs[],
       const cache_t<N_MAX> &x) {
@@ -325,6 +543,15 @@ struct EGM_Generic {
         false, false, false, true>(
         coefs, a_r, phi, lambda).gravity_lambda;
   }
+  template <int N_MAX>
+  static FloatT gravity_lambda_dimless(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
+
+    return calc_dimless<N_MAX,
+        false, false, false, true>(
+        table, a_r, phi, lambda).gravity_lambda;
+  }
 
   struct gravity_res_t {
     FloatT r, phi, lambda;
@@ -351,25 +578,81 @@ struct EGM_Generic {
     gravity_res_t g = {res.gravity_r, res.gravity_phi, res.gravity_lambda};
     return g;
   }
+  template <int N_MAX>
+  static gravity_res_t gravity_dimless(
+      const clenshaw_table_t<N_MAX> &table,
+      const FloatT &a_r, const FloatT &phi, const FloatT &lambda) {
+
+    calc_res_t res(calc_dimless<N_MAX,
+        false, true, true, true>(
+        table, a_r, phi, lambda));
+    gravity_res_t g = {res.gravity_r, res.gravity_phi, res.gravity_lambda};
+    return g;
+  }
+
+  struct position_t {
+    FloatT r, phi, lambda; ///< geocentric distance, latitude, and longitude
+  };
+  static const int batch_block = 8;
 
+  /**
+   * Batch version of gravity_dimless.
+   *
+   * @param r_ref reference radius to make the distance dimensionless
+   * @param points positions
+   * @param n number of positions
+   * @param res (output) results
+   */
+  template <int N_MAX>
+  static void gravity_dimless(
+      const clenshaw_table_t<N_MAX> &table, const FloatT &r_ref,
+      const position_t points[], const int &n,
+      gravity_res_t res[]) {
+    for(int i(0); i < n; i += batch_block){
+      FloatT a_r[batch_block], phi[batch_block], lambda[batch_block];
+      calc_res_t res_block[batch_block];
+      int n_block(((n - i) < batch_block) ? (n - i) : batch_block);
+      for(int k(0); k < batch_block; ++k){
+        const position_t &p(points[i + ((k < n_block) ? k : (n_block - 1))]); // padding
+        a_r[k] = r_ref / p.r;
+        phi[k] = p.phi;
+        lambda[k] = p.lambda;
+      }
+      calc_dimless_block<N_MAX, batch_block,
+          false, true, true, true>(
+          table, a_r, phi, lambda, res_block);
+      for(int k(0); k < n_block; ++k){
+        gravity_res_t g = {res_block[k].gravity_r, res_block[k].gravity_phi, res_block[k].gravity_lambda};
+        res[i + k] = g;
+      }
+    }
+  }
 };
 
 template <class FloatT>
 struct EGM2008_70_Generic : public EGM_Generic<FloatT> {
   static const typename EGM_Generic<FloatT>::coefficients_t coefficients[];
   typedef typename EGM_Generic<FloatT>::template cache_t<70> cache_t;
+  typedef typename EGM_Generic<FloatT>::template clenshaw_table_t<70> clenshaw_table_t;
 #if defined(__GNUC__) && (__GNUC__ < 5)
   typedef typename EGM_Generic<FloatT>::gravity_res_t gravity_res_t;
+  typedef typename EGM_Generic<FloatT>::position_t position_t;
 #else
   using typename EGM_Generic<FloatT>::gravity_res_t;
+  using typename EGM_Generic<FloatT>::position_t;
 #endif
 
+  static const clenshaw_table_t &table(){
+    static const clenshaw_table_t res(coefficients);
+    return res;
+  }
+
 
 #define make_func(fname, sf) \
 static FloatT fname( \
     const FloatT &r, const FloatT &phi, const FloatT &lambda){ \
   return (sf) * EGM_Generic<FloatT>::template fname ## _dimless<70>( \
-      coefficients, \
+      table(), \
       WGS84Generic<FloatT>::R_e / r, phi, lambda); \
 } \
 static FloatT fname( \
@@ -399,7 +682,7 @@ static FloatT fname( \
       const FloatT &r, const FloatT &phi, const FloatT &lambda){
     FloatT sf(WGS84Generic<FloatT>::mu_Earth_refined / std::pow(r, 2));
     gravity_res_t res(EGM_Generic<FloatT>::template gravity_dimless<70>(
-        coefficients,
+        table(),
         WGS84Generic<FloatT>::R_e / r, phi, lambda));
     res.r *= -sf;
     res.phi *= sf;
@@ -407,6 +690,25 @@ static FloatT fname( \
     return res;
   }
 
+  /**
+   * Batch version of gravity
+   *
+   * @param points positions in geocentric distance, latitude, and longitude
+   * @param n number of positions
+   * @param res (output) results
+   */
+  static void gravity(
+      const position_t points[], const int &n, gravity_res_t res[]){
+    EGM_Generic<FloatT>::template gravity_dimless<70>(
+        table(), WGS84Generic<FloatT>::R_e,
+        points, n, res);
+    for(int i(0); i < n; ++i){
+      FloatT sf(WGS84Generic<FloatT>::mu_Earth_refined / std::pow(points[i].r, 2));
+      res[i].r *= -sf;
+      res[i].phi *= sf;
+      res[i].lambda *= (sf / std::cos(points[i].phi));
+    }
+  }
 };
 
 template<class FloatT>
@@ -158,6 +158,36 @@ class Filtered_INS2
       }
     };
 
+    /**
+     * Accumulator for decimated covariance propagation.
+     * A and B are integrated over samples as @f$ \int A dt @f$ and @f$ \int B dt @f$,
+     * then the filter is propagated once per block.
+     */
+    struct predict_accumulator_t {
+      getAB_res AB_dt; ///< integrals of A and B
+      float_t deltaT;
+      unsigned int samples;
+      unsigned int block_length; ///< number of samples per block, 0 or 1 means no decimation
+      predict_accumulator_t() : AB_dt(), deltaT(0), samples(0), block_length(1) {}
+      void add(const getAB_res &AB, const float_t &dt){
+        for(int i(0); i < sizeof(AB.A) / sizeof(AB.A[0]); ++i){
+          for(int j(0); j < sizeof(AB.A[0]) / sizeof(AB.A[0][0]); ++j){
+            AB_dt.A[i][j] += AB.A[i][j] * dt;
+          }
+          for(int j(0); j < sizeof(AB.B[0]) / sizeof(AB.B[0][0]); ++j){
+            AB_dt.B[i][j] += AB.B[i][j] * dt;
+          }
+        }
+        deltaT += dt;
+        ++samples;
+      }
+      void clear(){
+        AB_dt = getAB_res();
+        deltaT = 0;
+        samples = 0;
+      }
+    } m_predict_acc;
+
     /**
      * q@(VXe)ɂāA
      * ̏ԗʂ̌덷ɑ΂Đ`ꍇ̎A
@@ -180,8 +210,9 @@ class Filtered_INS2
         getAB_res &res) const {
 
       // ]švZ
-      mat_t dcm_e2n((this->q_e2n).getDCM()); ///< @f$ \mathrm{DCM} \left( \Tilde{q}_{e}^{n} \right) @f$
-      mat_t dcm_n2b((this->q_n2b).getDCM()); ///< @f$ \mathrm{DCM} \left( \Tilde{q}_{n}^{b} \right) @f$
+      const typename BaseINS::frame_t::dcm_t
+          &dcm_e2n(this->frame.dcm_e2n), ///< @f$ \mathrm{DCM} \left( \Tilde{q}_{e}^{n} \right) @f$
+          &dcm_n2b(this->frame.dcm_n2b); ///< @f$ \mathrm{DCM} \left( \Tilde{q}_{n}^{b} \right) @f$
       
 #ifndef pow2
 #define pow2(x) ((x) * (x))
@@ -197,8 +228,8 @@ class Filtered_INS2
         vec3_t omega_1(this->omega_e2i_4n * 2 + this->omega_n2e_4n);
 
 #ifdef R_STRICT
-        float_t Rn_1(Earth::R_normal(this->phi) + get(7));
-        float_t Rm_1(Earth::R_meridian(this->phi) + get(7));
+        float_t Rn_1(this->frame.R_normal + get(7));
+        float_t Rm_1(this->frame.R_meridian + get(7));
         float_t Rn_2(pow2(Rn_1));
         float_t Rm_2(pow2(Rm_1));
 #else
@@ -393,7 +424,8 @@ class Filtered_INS2
      */
     Filtered_INS2() 
         : BaseINS(),
-          m_filter(mat_t::getI(P_SIZE), mat_t::getI(Q_SIZE)){
+          m_filter(mat_t::getI(P_SIZE), mat_t::getI(Q_SIZE)),
+          m_predict_acc(){
     }
     
     /**
@@ -405,7 +437,7 @@ class Filtered_INS2
      * @param Q Qs(͌덷Us)
      */
     Filtered_INS2(const mat_t &P, const mat_t &Q)
-        : BaseINS(), m_filter(P, Q) {}
+        : BaseINS(), m_filter(P, Q), m_predict_acc() {}
     
     /**
      * Rs[RXgN^
@@ -415,7 +447,8 @@ class Filtered_INS2
      */
     Filtered_INS2(const Filtered_INS2 &orig, const bool &deepcopy = false)
         : BaseINS(orig, deepcopy),
-          m_filter(orig.m_filter, deepcopy){
+          m_filter(orig.m_filter, deepcopy),
+          m_predict_acc(orig.m_predict_acc){
     }
     
     virtual ~Filtered_INS2(){}
@@ -445,15 +478,74 @@ class Filtered_INS2
     void update(const vec3_t &accel, const vec3_t &gyro, const float_t &deltaT){
       getAB_res AB;
       getAB(accel, gyro, AB);
-      mat_t A(AB.getA()), B(AB.getB());
-      //std::cerr << "deltaT:" << deltaT << std::endl;
-      //std::cerr << "A:" << A << std::endl;
-      //std::cerr << "B:" << B << std::endl;
-      //std::cerr << "P:" << m_filter.getP() << std::endl;
-      m_filter.predict(A, B, deltaT);
-      before_update_INS(A, B, deltaT);
+      if(m_predict_acc.block_length > 1){
+        m_predict_acc.add(AB, deltaT);
+        if(m_predict_acc.samples >= m_predict_acc.block_length){
+          flush_predict();
+        }
+      }else{
+        mat_t A(AB.getA()), B(AB.getB());
+        //std::cerr << "deltaT:" << deltaT << std::endl;
+        //std::cerr << "A:" << A << std::endl;
+        //std::cerr << "B:" << B << std::endl;
+        //std::cerr << "P:" << m_filter.getP() << std::endl;
+        m_filter.predict(A, B, deltaT);
+        before_update_INS(A, B, deltaT);
+      }
       BaseINS::update(accel, gyro, deltaT);
     }
+
+    /**
+     * Propagate the covariance with the A and B matrices accumulated
+     * since the last propagation, when decimation is activated.
+     * With the accumulated @f$ \bar{A} T = \int A dt @f$ over n samples (total interval T),
+     * the transition matrix is approximated in the second order as
+     * @f[
+     *    \Phi = I + \bar{A} T + \frac{1}{2} \left( \bar{A} T \right)^{2},
+     * @f]
+     * and the process noise by the first order Van Loan's method as
+     * @f[
+     *    Q_{d} = \Gamma Q \Gamma^{T}, \quad
+     *    \Gamma = \left( I + \frac{1}{2} \bar{A} T \right) \frac{\int B dt}{\sqrt{n}} ,
+     * @f]
+     * which is equivalent to n times of per-sample propagation with @f$ \Gamma_{k} = B_{k} \Delta t @f$.
+     * Because @f$ \Gamma @f$ is shaped and Q is untouched,
+     * filters assuming diagonal Q (UD) are applicable.
+     * This is invoked automatically when a block is filled, and before correction.
+     */
+    void flush_predict(){
+      if(m_predict_acc.samples == 0){return;}
+      float_t T(m_predict_acc.deltaT);
+      mat_t A_T(m_predict_acc.AB_dt.getA().copy());
+      mat_t I(mat_t::getI(A_T.rows()));
+
+      mat_t A_eq(A_T + (A_T * A_T) / 2); // = Phi - I
+      mat_t B_eq(
+          (I + A_T / 2) * m_predict_acc.AB_dt.getB()
+            / std::sqrt((float_t)m_predict_acc.samples)); // = Gamma
+      A_eq /= T;
+      B_eq /= T;
+
+      m_predict_acc.clear();
+      m_filter.predict(A_eq, B_eq, T);
+      before_update_INS(A_eq, B_eq, T);
+    }
+
+    /**
+     * Set block length of decimated covariance propagation.
+     * Mechanization is always performed at every sample,
+     * while the covariance is propagated once per the specified samples.
+     *
+     * @param samples number of samples per block, 0 or 1 means propagation at every sample
+     */
+    void set_predict_decimation(const unsigned int &samples){
+      flush_predict();
+      m_predict_acc.block_length = samples;
+    }
+
+    unsigned int predict_decimation() const {
+      return m_predict_acc.block_length;
+    }
   
   protected:
     /**
@@ -517,7 +609,8 @@ class Filtered_INS2
      * @param R 덷Us
      */
     void correct_primitive(const mat_t &H, const mat_t &z, const mat_t &R){
-            
+      flush_predict();
+
       // Cʂ̌vZ
       mat_t K(m_filter.correct(H, R)); //J}QC
       mat_t x_hat(K * z);
@@ -541,6 +634,7 @@ class Filtered_INS2
      * @param sigma2_delta_psi delta_psi̊m炵(U) [rad^2]
      */
     void correct_yaw(const float_t &delta_psi, const float_t &sigma2_delta_psi){
+      flush_predict();
 
       //ϑz
       float_t z_serialized[1][1] = {{-delta_psi}};
@@ -574,7 +668,21 @@ class Filtered_INS2
      * 
      * @return (Filter &) tB^[
      */
-    filter_t &getFilter(){return m_filter;}
+    filter_t &getFilter(){
+      flush_predict();
+      return m_filter;
+    }
+
+    /**
+     * Filter as of the last covariance propagation, for inspection.
+     * Unlike the non-const version, the pending decimated propagation is not flushed,
+     * therefore reading P does not cut the block short.
+     *
+     * @return (const Filter &) filter
+     */
+    const filter_t &getFilter() const {
+      return m_filter;
+    }
 
     struct StandardDeviations {
       float_t v_north_ms, v_east_ms, v_down_ms;
@@ -591,13 +699,20 @@ class Filtered_INS2
     StandardDeviations getSigma() const {
       StandardDeviations sigma;
 
-      const mat_t &P(
-          const_cast<Filtered_INS2 *>(this)->getFilter().getP());
+      // Elements of P are extracted without reconstruction of the whole P
+      const filter_t &filter(getFilter()); // without flush of decimated propagation
+      mat_t P_e2n(3, 3), P_n2b(3, 3);
+      for(unsigned int i(0); i < 3; ++i){
+        for(unsigned int j(0); j < 3; ++j){
+          P_e2n(i, j) = filter.getP(3 + i, 3 + j);
+          P_n2b(i, j) = filter.getP(7 + i, 7 + j);
+        }
+      }
 
       { // x
-        sigma.v_north_ms = std::sqrt(P(0, 0));
-        sigma.v_east_ms = std::sqrt(P(1, 1));
-        sigma.v_down_ms = std::sqrt(P(2, 2));
+        sigma.v_north_ms = std::sqrt(filter.getP(0, 0));
+        sigma.v_east_ms = std::sqrt(filter.getP(1, 1));
+        sigma.v_down_ms = std::sqrt(filter.getP(2, 2));
       }
 
       { // ʒu
@@ -613,12 +728,12 @@ class Filtered_INS2
         M(1, 1) = cl * cl * 2 - 1;
         M(1, 2) = 0;
 
-        mat_t P_euler_e2n(M * P.partial(3, 3, 3, 3) * M.transpose());
+        mat_t P_euler_e2n(M * P_e2n * M.transpose());
 
         sigma.longitude_rad = std::sqrt(P_euler_e2n(0, 0)) * 2; // ox
         sigma.latitude_rad = std::sqrt(P_euler_e2n(1, 1)) * 2; // ܓx
 
-        sigma.height_m = std::sqrt(P(6, 6)); // x
+        sigma.height_m = std::sqrt(filter.getP(6, 6)); // x
       }
 
       { // p
@@ -634,7 +749,7 @@ class Filtered_INS2
           M_conv(2, 0) =  cpsi / ctheta; M_conv(2, 1) = spsi / ctheta; M_conv(2, 2) = 0;
         }
 
-        mat_t P_euler_n2b(M_conv * P.partial(3, 3, 7, 7) * M_conv.transpose());
+        mat_t P_euler_n2b(M_conv * P_n2b * M_conv.transpose());
 
         sigma.heading_rad = std::sqrt(P_euler_n2b(0, 0)) * 2; // [
         sigma.pitch_rad = std::sqrt(P_euler_n2b(1, 1)) * 2; // sb`
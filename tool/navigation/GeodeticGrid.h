@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __GEODETIC_GRID_H__
+#define __GEODETIC_GRID_H__
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <vector>
+#include <map>
+#include <string>
+#include <istream>
+#include <ostream>
+
+/**
+ * @brief Lookup grid of a smooth vector field around the Earth
+ *
+ * A three dimensional vector field, for example, the gravity vector
+ * or the geomagnetic field in the local (north, east, down) frame, is sampled
+ * at nodes of a regular grid in latitude, longitude and height,
+ * and is trilinearly interpolated between them.
+ * The grid is divided into tiles, which are generated lazily on their first use,
+ * or in advance over a bounding box by prepare(), and can be saved to / loaded from a file.
+ * Every tile is checked against the direct evaluation at the center of each cell,
+ * where the interpolation error of a smooth field becomes maximum.
+ * If the error exceeds the tolerance, the tile is marked as rejected,
+ * and the direct evaluation is used within the tile.
+ *
+ * @param FloatT precision
+ * @param Evaluator direct evaluator of the field, which is a function (pointer) or a functor
+ * callable as evaluator(phi [rad], lambda [rad], h [m], FloatT (&res)[3])
+ */
+template <
+    class FloatT,
+    class Evaluator = void (*)(const FloatT &, const FloatT &, const FloatT &, FloatT (&)[3])>
+class GeodeticGrid {
+  public:
+    typedef FloatT float_t;
+    typedef Evaluator evaluator_t;
+
+    struct property_t {
+      float_t cell_lat, cell_lng; ///< cell size in latitude and longitude [rad]
+      float_t cell_h; ///< cell size in height [m]
+      int tile_cells, tile_cells_h; ///< number of cells per tile in horizontal and vertical directions
+      float_t tolerance; ///< acceptable interpolation error for each component, in units of the field
+      float_t latitude_limit; ///< absolute latitude [rad] beyond which the direct evaluation is always used
+      /**
+       * Constructor, whose default values are suitable for the gravity vector [m/s^2].
+       *
+       * @param cell_deg cell size in latitude and longitude [deg]
+       */
+      property_t(
+          const float_t &cell_deg = 0.05, const float_t &cell_h_ = 500,
+          const int &tile_cells_ = 8, const int &tile_cells_h_ = 4,
+          const float_t &tolerance_ = 1E-6, const float_t &latitude_limit_deg = 89)
+          : cell_lat(M_PI / 180 * cell_deg), cell_lng(M_PI / 180 * cell_deg), cell_h(cell_h_),
+          tile_cells(tile_cells_), tile_cells_h(tile_cells_h_),
+          tolerance(tolerance_), latitude_limit(M_PI / 180 * latitude_limit_deg) {}
+    };
+
+  protected:
+    struct key_t {
+      int lat, lng, h;
+      bool operator<(const key_t &another) const {
+        if(lat != another.lat){return lat < another.lat;}
+        if(lng != another.lng){return lng < another.lng;}
+        return h < another.h;
+      }
+    };
+    struct tile_t {
+      std::vector<float_t> nodes; ///< (north, east, down) of each node; empty if rejected
+      float_t max_error; ///< maximum error found in the check
+    };
+    typedef std::map<key_t, tile_t> tiles_t;
+
+    evaluator_t evaluator;
+    property_t property;
+    tiles_t tiles;
+    typename tiles_t::const_iterator last; ///< recently used tile
+    bool last_valid;
+
+    int nodes_lat() const {return property.tile_cells + 1;}
+    int nodes_h() const {return property.tile_cells_h + 1;}
+    std::size_t tile_values() const {
+      return (std::size_t)nodes_lat() * nodes_lat() * nodes_h() * 3;
+    }
+
+    key_t key_of(const float_t &phi, const float_t &lambda, const float_t &h) const {
+      key_t res = {
+        (int)std::floor(phi / (property.cell_lat * property.tile_cells)),
+        (int)std::floor(lambda / (property.cell_lng * property.tile_cells)),
+        (int)std::floor(h / (property.cell_h * property.tile_cells_h))};
+      return res;
+    }
+
+    /**
+     * Interpolate within a tile.
+     *
+     * @param u, v, w coordinates in units of cells, whose origin is the tile corner
+     */
+    void interpolate(const tile_t &tile,
+        float_t u, float_t v, float_t w, float_t (&res)[3]) const {
+      int i((int)u), j((int)v), k((int)w);
+      if(i < 0){i = 0;}else if(i >= property.tile_cells){i = property.tile_cells - 1;}
+      if(j < 0){j = 0;}else if(j >= property.tile_cells){j = property.tile_cells - 1;}
+      if(k < 0){k = 0;}else if(k >= property.tile_cells_h){k = property.tile_cells_h - 1;}
+      u -= i; v -= j; w -= k;
+      const int stride_j(nodes_lat() * 3), stride_k(stride_j * nodes_lat());
+      const float_t *p(&tile.nodes[k * stride_k + j * stride_j + i * 3]);
+      for(int c(0); c < 3; ++c, ++p){
+        float_t c00(p[0] + (p[3] - p[0]) * u),
+            c10(p[stride_j] + (p[stride_j + 3] - p[stride_j]) * u),
+            c01(p[stride_k] + (p[stride_k + 3] - p[stride_k]) * u),
+            c11(p[stride_k + stride_j] + (p[stride_k + stride_j + 3] - p[stride_k + stride_j]) * u);
+        float_t c0(c00 + (c10 - c00) * v), c1(c01 + (c11 - c01) * v);
+        res[c] = c0 + (c1 - c0) * w;
+      }
+    }
+
+    const tile_t &generate(const key_t &key){
+      tile_t &tile(tiles[key]);
+      float_t phi0(property.cell_lat * property.tile_cells * key.lat),
+          lambda0(property.cell_lng * property.tile_cells * key.lng),
+          h0(property.cell_h * property.tile_cells_h * key.h);
+      tile.nodes.resize(tile_values());
+      float_t *p(&tile.nodes[0]);
+      for(int k(0); k < nodes_h(); ++k){
+        for(int j(0); j < nodes_lat(); ++j){
+          for(int i(0); i < nodes_lat(); ++i, p += 3){
+            evaluator(
+                phi0 + property.cell_lat * i,
+                lambda0 + property.cell_lng * j,
+                h0 + property.cell_h * k,
+                *(float_t (*)[3])p);
+          }
+        }
+      }
+      tile.max_error = 0;
+      for(int k(0); k < property.tile_cells_h; ++k){
+        for(int j(0); j < property.tile_cells; ++j){
+          for(int i(0); i < property.tile_cells; ++i){
+            float_t direct[3], interpolated[3];
+            evaluator(
+                phi0 + property.cell_lat * (0.5 + i),
+                lambda0 + property.cell_lng * (0.5 + j),
+                h0 + property.cell_h * (0.5 + k),
+                direct);
+            interpolate(tile, 0.5 + i, 0.5 + j, 0.5 + k, interpolated);
+            for(int c(0); c < 3; ++c){
+              float_t err(std::abs(interpolated[c] - direct[c]));
+              if(err > tile.max_error){tile.max_error = err;}
+            }
+          }
+        }
+      }
+      if(tile.max_error > property.tolerance){
+        tile.nodes.clear(); // rejected
+      }
+      return tile;
+    }
+
+  public:
+    GeodeticGrid(const evaluator_t &f, const property_t &prop = property_t())
+        : evaluator(f), property(prop), tiles(), last(), last_valid(false) {}
+
+    const evaluator_t &get_evaluator() const {return evaluator;}
+    /**
+     * Change evaluator, which discards all generated tiles.
+     */
+    void set_evaluator(const evaluator_t &f){
+      evaluator = f;
+      clear();
+    }
+
+    const property_t &get_property() const {return property;}
+    /**
+     * Change property, which discards all generated tiles.
+     */
+    void set_property(const property_t &prop){
+      property = prop;
+      clear();
+    }
+    void clear(){
+      tiles.clear();
+      last_valid = false;
+    }
+    /**
+     * @return (int) number of generated tiles, including rejected ones
+     */
+    int tiles_generated() const {return (int)tiles.size();}
+    /**
+     * @return (int) number of tiles rejected by the tolerance check
+     */
+    int tiles_rejected() const {
+      int res(0);
+      for(typename tiles_t::const_iterator it(tiles.begin()); it != tiles.end(); ++it){
+        if(it->second.nodes.empty()){++res;}
+      }
+      return res;
+    }
+    /**
+     * @return (float_t) error bound of the interpolation, i.e.,
+     * the maximum error found in the check of accepted tiles
+     */
+    float_t max_error() const {
+      float_t res(0);
+      for(typename tiles_t::const_iterator it(tiles.begin()); it != tiles.end(); ++it){
+        if(it->second.nodes.empty()){continue;}
+        if(it->second.max_error > res){res = it->second.max_error;}
+      }
+      return res;
+    }
+
+    /**
+     * Return the field vector, which is interpolated with the grid
+     * or evaluated directly when the grid is unavailable at the position.
+     *
+     * @param phi latitude [rad]
+     * @param lambda longitude [rad]
+     * @param h height [m]
+     * @param res (output) field vector
+     */
+    void get(const float_t &phi, const float_t &lambda, const float_t &h,
+        float_t (&res)[3]){
+      if(std::abs(phi) > property.latitude_limit){
+        evaluator(phi, lambda, h, res);
+        return;
+      }
+      key_t key(key_of(phi, lambda, h));
+      if((!last_valid)
+          || (last->first.lat != key.lat) || (last->first.lng != key.lng) || (last->first.h != key.h)){
+        last = tiles.find(key);
+        if(last == tiles.end()){
+          generate(key);
+          last = tiles.find(key);
+        }
+        last_valid = true;
+      }
+      const tile_t &tile(last->second);
+      if(tile.nodes.empty()){
+        evaluator(phi, lambda, h, res);
+        return;
+      }
+      interpolate(tile,
+          phi / property.cell_lat - property.tile_cells * key.lat,
+          lambda / property.cell_lng - property.tile_cells * key.lng,
+          h / property.cell_h - property.tile_cells_h * key.h,
+          res);
+    }
+
+    /**
+     * Generate tiles covering a bounding box in advance.
+     *
+     * @return (int) number of newly generated tiles
+     */
+    int prepare(
+        const float_t &phi_min, const float_t &lambda_min, const float_t &h_min,
+        const float_t &phi_max, const float_t &lambda_max, const float_t &h_max){
+      key_t k_min(key_of(phi_min, lambda_min, h_min)), k_max(key_of(phi_max, lambda_max, h_max));
+      int res(0);
+      key_t key;
+      for(key.lat = k_min.lat; key.lat <= k_max.lat; ++key.lat){
+        if(std::abs(property.cell_lat * property.tile_cells * key.lat) > property.latitude_limit){continue;}
+        for(key.lng = k_min.lng; key.lng <= k_max.lng; ++key.lng){
+          for(key.h = k_min.h; key.h <= k_max.h; ++key.h){
+            if(tiles.find(key) != tiles.end()){continue;}
+            generate(key);
+            ++res;
+          }
+        }
+      }
+      last_valid = false;
+      return res;
+    }
+
+  protected:
+    static const char *magic() {return "GRVGRID1";}
+    template <class T>
+    static void write(std::ostream &out, const T &v){
+      out.write((const char *)&v, sizeof(v));
+    }
+    template <class T>
+    static bool read(std::istream &in, T &v){
+      return (bool)in.read((char *)&v, sizeof(v));
+    }
+
+  public:
+    /**
+     * Save property and generated tiles in a binary format,
+     * which depends on the precision and the byte order of the machine.
+     */
+    void save(std::ostream &out) const {
+      out.write(magic(), 8);
+      write(out, (int)sizeof(float_t));
+      write(out, property);
+      write(out, (int)tiles.size());
+      for(typename tiles_t::const_iterator it(tiles.begin()); it != tiles.end(); ++it){
+        write(out, it->first);
+        write(out, it->second.max_error);
+        write(out, (int)it->second.nodes.size());
+        if(!it->second.nodes.empty()){
+          out.write((const char *)&it->second.nodes[0], sizeof(float_t) * it->second.nodes.size());
+        }
+      }
+    }
+
+    /**
+     * Load property and tiles saved by save(), which replace the current ones.
+     *
+     * @return (bool) true when successfully loaded, otherwise false and the grid is cleared.
+     */
+    bool load(std::istream &in){
+      clear();
+      char buf[8];
+      int float_size, n_tiles;
+      property_t prop;
+      if(!in.read(buf, 8) || (std::string(buf, 8) != magic())
+          || !read(in, float_size) || (float_size != (int)sizeof(float_t))
+          || !read(in, prop) || !read(in, n_tiles)){
+        return false;
+      }
+      property = prop;
+      for(int i(0); i < n_tiles; ++i){
+        key_t key;
+        tile_t tile;
+        int values;
+        if(!read(in, key) || !read(in, tile.max_error) || !read(in, values)
+            || ((values != 0) && (values != (int)tile_values()))){
+          clear();
+          return false;
+        }
+        tile.nodes.resize(values);
+        if((values > 0)
+            && !in.read((char *)&tile.nodes[0], sizeof(float_t) * values)){
+          clear();
+          return false;
+        }
+        tiles[key] = tile;
+      }
+      return true;
+    }
+};
+
+#endif /* __GEODETIC_GRID_H__ */
@@ -79,6 +79,57 @@ class INS {
     vec3_t omega_e2i_4n;  ///< @f$ \vec{\omega}_{e/i}^{n} @f$
     vec3_t omega_n2e_4n;  ///< @f$ \vec{\omega}_{n/e}^{n} @f$
     
+    bool attitude_by_rotation; ///< true to propagate the attitude with rotation quaternions in update()
+    
+  public:
+    /**
+     * Quantities derived from the current states, which are shared in a step
+     * among the mechanization, the error dynamics (getAB of filtered INS),
+     * gravity evaluation, and output accessors.
+     * They are refreshed by recalc(), initPosition(), initAttitude(), and mod_euler_*().
+     */
+    struct frame_t {
+      struct dcm_t {
+        float_t v[3][3];
+        const float_t &operator()(const unsigned &i, const unsigned &j) const {return v[i][j];}
+        /**
+         * Same as quat_t::getDCM() without allocation
+         */
+        void set(const quat_t &q){
+          float_t k(float_t(2) / (pow2(q.get(0)) + pow2(q.get(1)) + pow2(q.get(2)) + pow2(q.get(3))));
+          v[0][0] = float_t(1) - (pow2(q.get(2)) + pow2(q.get(3))) * k;
+          v[0][1] = ((q.get(1) * q.get(2)) + (q.get(0) * q.get(3))) * k;
+          v[0][2] = ((q.get(1) * q.get(3)) - (q.get(0) * q.get(2))) * k;
+          v[1][0] = ((q.get(1) * q.get(2)) - (q.get(0) * q.get(3))) * k;
+          v[1][1] = float_t(1) - (pow2(q.get(1)) + pow2(q.get(3))) * k;
+          v[1][2] = ((q.get(2) * q.get(3)) + (q.get(0) * q.get(1))) * k;
+          v[2][0] = ((q.get(1) * q.get(3)) + (q.get(0) * q.get(2))) * k;
+          v[2][1] = ((q.get(2) * q.get(3)) - (q.get(0) * q.get(1))) * k;
+          v[2][2] = float_t(1) - (pow2(q.get(1)) + pow2(q.get(2))) * k;
+        }
+      };
+      float_t sin_phi, cos_phi;     ///< sine and cosine of latitude
+      float_t sin_alpha, cos_alpha; ///< sine and cosine of azimuth
+      float_t R_normal, R_meridian; ///< curvature radii at the latitude (on the ellipsoid) [m]
+      dcm_t dcm_e2n;                ///< @f$ \mathrm{DCM} \left( \Tilde{q}_{e}^{n} \right) @f$
+      dcm_t dcm_n2b;                ///< @f$ \mathrm{DCM} \left( \Tilde{q}_{n}^{b} \right) @f$
+    };
+  protected:
+    frame_t frame;
+
+    void update_frame_position(){
+      frame.sin_phi = std::sin(phi);
+      frame.cos_phi = std::cos(phi);
+      frame.sin_alpha = std::sin(alpha);
+      frame.cos_alpha = std::cos(alpha);
+      frame.R_normal = Earth::R_normal_sin(frame.sin_phi);
+      frame.R_meridian = Earth::R_meridian_sin(frame.sin_phi);
+      frame.dcm_e2n.set(q_e2n);
+    }
+    void update_frame_attitude(){
+      frame.dcm_n2b.set(q_n2b);
+    }
+
   public:
     typedef WGS84Generic<float_t> Earth; ///< nf
     static const unsigned STATE_VALUES = INS_Property<INS>::STATE_VALUES;
@@ -93,7 +144,7 @@ class INS {
      * 
      * @return (float_t) ]猻݈ʒu܂ł̋
      */
-    float_t beta() const{return (Earth::R_normal(phi) + h) * std::cos(phi);}
+    float_t beta() const{return (frame.R_normal + h) * frame.cos_phi;}
   
   private:
     /**
@@ -169,8 +220,8 @@ class INS {
      * @return (vec3_t &)
      */
     inline vec3_t &update_omega_n2e_4n(const float_t &calpha, const float_t &salpha){
-      float_t omega_n2e_4g_0 = v_E / (Earth::R_normal(phi) + h);
-      float_t omega_n2e_4g_1 = -v_N / (Earth::R_meridian(phi) + h);
+      float_t omega_n2e_4g_0 = v_E / (frame.R_normal + h);
+      float_t omega_n2e_4g_1 = -v_N / (frame.R_meridian + h);
       
       omega_n2e_4n[0] =  omega_n2e_4g_0 * calpha + omega_n2e_4g_1 * salpha;
       omega_n2e_4n[1] = -omega_n2e_4g_0 * salpha + omega_n2e_4g_1 * calpha;
@@ -183,9 +234,9 @@ class INS {
      * @return (vec3_t &)
      */
     inline vec3_t &update_omega_n2e_4n(){
-      return update_omega_n2e_4n(std::cos(alpha), std::sin(alpha));
+      return update_omega_n2e_4n(frame.cos_alpha, frame.sin_alpha);
     }
-  protected:
+  public:
     /**
      * tяČvZčŐV̏Ԃɕۂ܂B
      * 
@@ -202,8 +253,10 @@ class INS {
       update_phi();
       update_lambda();
       update_alpha();
-      
-      float_t ca(std::cos(alpha)), sa(std::sin(alpha));
+
+      update_frame_position();
+      update_frame_attitude();
+      const float_t &ca(frame.cos_alpha), &sa(frame.sin_alpha);
 
       //v_north, v_east̍XV
       update_v_N(ca, sa);
@@ -216,7 +269,6 @@ class INS {
       update_omega_n2e_4n(ca, sa);
     }
     
-  public:
     /**
      * ʒu܂B
      * 
@@ -241,6 +293,7 @@ class INS {
       q_e2n[3] = sl * (cp + sp) / sqrt2;
       h = height;
       
+      update_frame_position();
       update_omega_e2i_4n();
       update_omega_n2e_4n();
     }
@@ -300,6 +353,31 @@ class INS {
       quat_t res;
       return euler2q_internal(yaw, pitch, roll, res);
     }
+
+    /**
+     * Convert a rotation vector to quaternion.
+     *
+     * @param v rotation vector, whose direction and magnitude are the axis and angle [rad]
+     * @return (quat_t) result
+     */
+    static quat_t rotation2q(const vec3_t &v){
+      float_t theta2(v.abs2());
+      if(theta2 < 1E-8){ // Taylor expansion up to 4th order
+        return quat_t(float_t(1) - theta2 / 8, v * (float_t(0.5) - theta2 / 48));
+      }
+      float_t theta(std::sqrt(theta2));
+      return quat_t(std::cos(theta / 2), v * (std::sin(theta / 2) / theta));
+    }
+
+    /**
+     * Select how update() propagates the attitude.
+     *
+     * @param by_rotation true for rotation quaternions, which suit a long interval such as an IMU block,
+     * false (default) for the first-order integration of the quaternion derivative
+     */
+    void set_attitude_by_rotation(const bool &by_rotation){
+      attitude_by_rotation = by_rotation;
+    }
     
     /**
      * p܂B
@@ -310,6 +388,7 @@ class INS {
      */
     void initAttitude(const float_t &yaw, const float_t &pitch, const float_t &roll){
       euler2q_internal(yaw, pitch, roll, q_n2b);
+      update_frame_attitude();
     }
     
     /**
@@ -319,13 +398,14 @@ class INS {
      */
     void initAttitude(const quat_t &q){
       q_n2b = q.copy();
+      update_frame_attitude();
     }
   
     /**
      * RXgN^
      * 
      */
-    INS() : omega_e2i_4e(0, 0, Earth::Omega_Earth){
+    INS() : omega_e2i_4e(0, 0, Earth::Omega_Earth), attitude_by_rotation(false){
       initPosition(0, 0, 0);
       initVelocity(0, 0, 0);
       initAttitude(0, 0, 0); 
@@ -345,7 +425,9 @@ class INS {
       q_n2b(deepcopy ? orig.q_n2b.copy() : orig.q_n2b), 
       omega_e2i_4e(deepcopy ? orig.omega_e2i_4e.copy() : orig.omega_e2i_4e), 
       omega_e2i_4n(deepcopy ? orig.omega_e2i_4n.copy() : orig.omega_e2i_4n), 
-      omega_n2e_4n(deepcopy ? orig.omega_n2e_4n.copy() : orig.omega_n2e_4n){
+      omega_n2e_4n(deepcopy ? orig.omega_n2e_4n.copy() : orig.omega_n2e_4n),
+      attitude_by_rotation(orig.attitude_by_rotation),
+      frame(orig.frame){
     }
     
     /**
@@ -415,7 +497,7 @@ class INS {
             q_e2n[1] * q_e2n[3] + q_e2n[0] * q_e2n[2], // -cos(lambda) * cos(phi) / 2
             q_e2n[3] * q_e2n[2] - q_e2n[1] * q_e2n[0], // -sin(lambda) * cos(phi) / 2
             0);
-      centripetal_f *= (pow2(Earth::Omega_Earth) * (Earth::R_normal(phi) + h) * 2);
+      centripetal_f *= (pow2(Earth::Omega_Earth) * (frame.R_normal + h) * 2);
       return (q_e2n.conj() * centripetal_f * q_e2n).vector();
     }
 
@@ -427,7 +509,7 @@ class INS {
      * @return (vec3_t) total gravity in the navigation frame
      */
     virtual vec3_t gravity_total() const {
-      vec3_t res(0, 0, Earth::gravity(phi, h));
+      vec3_t res(0, 0, Earth::gravity_sin(frame.sin_phi, h));
 
       if(false){
         /* WGS84 theoretical normal gravity on and above the ellipsoidal surface
@@ -471,7 +553,14 @@ class INS {
       v_2e_4n += delta_v_2e_4n * deltaT;
       q_e2n += delta_q_e2n * deltaT;
       h += delta_h * deltaT;
-      q_n2b += dot_q_n2b * deltaT;
+      if(attitude_by_rotation){
+        // Rotation quaternions are used, which are exact when the angular speeds
+        // are constant during deltaT, in order to keep accuracy with a long deltaT,
+        // for example, of a block accumulated by ConingScullingAccumulator.
+        q_n2b = rotation2q((omega_e2i_4n + omega_n2e_4n) * -deltaT) * q_n2b * rotation2q(gyro * deltaT);
+      }else{
+        q_n2b += dot_q_n2b * deltaT;
+      }
       
       //tI̍ČvZ
       recalc();
@@ -545,6 +634,7 @@ class INS {
       float_t delta_psi_h(delta_psi / 2);
       quat_t delta_q(std::cos(delta_psi_h), 0, 0, std::sin(delta_psi_h));
       q_n2b = delta_q * q_n2b;
+      update_frame_attitude();
     }
 
     /**
@@ -572,6 +662,7 @@ class INS {
         quat_t delta_q(c_theta, 0, s_theta * std::cos(roll), -s_theta * std::sin(roll));
         q_n2b *= delta_q;
       }
+      update_frame_attitude();
     }
 
     /**
@@ -584,6 +675,7 @@ class INS {
       float_t delta_phi_h(delta_phi / 2);
       quat_t delta_q(std::cos(delta_phi_h), std::sin(delta_phi_h), 0, 0);
       q_n2b *= delta_q;
+      update_frame_attitude();
     }
 
     /**
@@ -597,6 +689,7 @@ class INS {
     
     const vec3_t &omega_e2i() const{return omega_e2i_4n;} /**< @f$ \vec{\omega}_{e/i}^{n} @f$ Ԃ܂B @return @f$ \vec{\omega}_{e/i}^{n} @f$ */
     const vec3_t &omega_n2e() const{return omega_n2e_4n;} /**< @f$ \vec{\omega}_{n/e}^{n} @f$ Ԃ܂B @return @f$ \vec{\omega}_{n/e}^{n} @f$ */
+    const frame_t &frame_cache() const{return frame;} /**< Return quantities derived from the current states. @return (const frame_t &) */
     
     /**
      * 鋗̈ܐ̈ړɑ΂āA݈ʒuɂܓx̕ω߂܂B
@@ -608,7 +701,7 @@ class INS {
      * 
      * @return (float_t) ܓx̕ω
      */
-    float_t meter2lat(const float_t &distance) const{return distance / Earth::R_meridian(phi);}
+    float_t meter2lat(const float_t &distance) const{return distance / frame.R_meridian;}
     /**
      * 鋗̌öړɑ΂āA݈ʒuɂox̕ω߂܂B
      * ŕ\ƁA
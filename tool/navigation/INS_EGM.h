@@ -25,8 +25,26 @@
  *
  */
 
+#include <cmath>
+
 #include "INS.h"
 #include "EGM.h"
+#include "GeodeticGrid.h"
+
+/**
+ * @brief Lookup grid of the gravity vector
+ *
+ * @see GeodeticGrid
+ */
+template <class FloatT>
+class GravityGrid : public GeodeticGrid<FloatT> {
+  public:
+    typedef GeodeticGrid<FloatT> super_t;
+    typedef typename super_t::evaluator_t evaluator_t;
+    typedef typename super_t::property_t property_t;
+    GravityGrid(evaluator_t f, const property_t &prop = property_t())
+        : super_t(f, prop) {}
+};
 
 /**
  * @brief INS including EGM
@@ -47,12 +65,15 @@ class INS_EGM : public PureINS {
     using typename super_t::float_t;
     using typename super_t::vec3_t;
 #endif
+    typedef GravityGrid<float_t> gravity_grid_t;
+  protected:
+    gravity_grid_t *m_gravity_grid; ///< if NULL, gravity is directly evaluated with EGM
   public:
     /**
      * Constructor
      *
      */
-    INS_EGM() : super_t() {}
+    INS_EGM() : super_t(), m_gravity_grid(NULL) {}
 
     /**
      * Copy constructor
@@ -61,7 +82,8 @@ class INS_EGM : public PureINS {
      * @param deepcopy if true, perform deep copy
      */
     INS_EGM(const INS_EGM &orig, const bool &deepcopy = false)
-        : super_t(orig, deepcopy){
+        : super_t(orig, deepcopy),
+        m_gravity_grid(orig.m_gravity_grid){
 
     }
 
@@ -72,34 +94,78 @@ class INS_EGM : public PureINS {
     virtual ~INS_EGM(){}
 
     /**
-     * Return the total gravity vector in accordance to current position.
-     * The total gravity is derivative of the Earth's total potential,
-     * which includes both the gravitational potential and the potential due to the Earths rotation.
+     * Return the total gravity vector in the local frame, whose axes are
+     * directed to north, east, and down, without any cache.
      *
-     * @return (vec3_t) total gravity in the navigation frame
+     * @param phi latitude [rad]
+     * @param lambda longitude [rad]
+     * @param h height [m]
+     * @param res (output) total gravity in north, east, and down directions
      */
-    virtual vec3_t gravity_total() const {
-      typename super_t::Earth::xz_t xz(super_t::Earth::xz(super_t::phi, super_t::h));
+    static void gravity_total_local(
+        const float_t &phi, const float_t &lambda, const float_t &h,
+        float_t (&res)[3]){
+      typename super_t::Earth::xz_t xz(super_t::Earth::xz(phi, h));
       float_t phi_gc(xz.geocentric_latitude()), r(xz.distance());
-      typename EGM::gravity_res_t g(EGM::gravity(r, phi_gc, super_t::lambda));
+      typename EGM::gravity_res_t g(EGM::gravity(r, phi_gc, lambda));
 
       /* gravity_res_t is in a local frame, whose -Z direction points to the center,
        * and whose X axis is parallel to meridian.
-       * Therefore, In order to coincide to n-frame, rotating delta-phi around the Y axis,
-       * then, rotating alpha around the Z axis are required.
+       * Therefore, In order to coincide to the local frame, rotating delta-phi around the Y axis is required.
        */
-      float_t delta_phi(super_t::phi - phi_gc);
+      float_t delta_phi(phi - phi_gc);
       float_t cp(std::cos(delta_phi)), sp(std::sin(delta_phi));
-      float_t ca(std::cos(super_t::alpha)), sa(std::sin(super_t::alpha));
 
-      vec3_t res(
-          (g.phi *  ca * cp) + (g.lambda * sa) + (-g.r *  ca * sp),
-          (g.phi * -sa * cp) + (g.lambda * ca) + (-g.r * -sa * sp),
-          (g.phi       * sp)                   + (-g.r       * cp));
+      // centripetal acceleration due to the Earth's rotation, which is directed to the rotation axis
+      float_t centripetal(
+          std::pow(super_t::Earth::Omega_Earth, 2)
+            * (super_t::Earth::R_normal(phi) + h) * std::cos(phi));
 
-      res -= super_t::gravity_rotational();
+      res[0] = (g.phi * cp) + (-g.r * sp) - centripetal * std::sin(phi);
+      res[1] = g.lambda;
+      res[2] = (g.phi * sp) + (-g.r * cp) - centripetal * std::cos(phi);
+    }
+
+    /**
+     * Return the lookup grid shared by all instances of this class.
+     * It is not used until activated by set_gravity_grid().
+     */
+    static gravity_grid_t &shared_gravity_grid(){
+      static gravity_grid_t grid(gravity_total_local);
+      return grid;
+    }
+
+    /**
+     * Specify the lookup grid of gravity, which must outlive this instance.
+     *
+     * @param grid lookup grid; if NULL, the gravity is directly evaluated every time.
+     */
+    void set_gravity_grid(gravity_grid_t *grid){
+      m_gravity_grid = grid;
+    }
+    gravity_grid_t *gravity_grid() const {return m_gravity_grid;}
+
+    /**
+     * Return the total gravity vector in accordance to current position.
+     * The total gravity is derivative of the Earth's total potential,
+     * which includes both the gravitational potential and the potential due to the Earths rotation.
+     *
+     * @return (vec3_t) total gravity in the navigation frame
+     */
+    virtual vec3_t gravity_total() const {
+      float_t g[3];
+      if(m_gravity_grid){
+        m_gravity_grid->get(super_t::phi, super_t::lambda, super_t::h, g);
+      }else{
+        gravity_total_local(super_t::phi, super_t::lambda, super_t::h, g);
+      }
 
-      return res;
+      // rotating alpha around the Z axis to coincide to n-frame
+      const float_t &ca(super_t::frame.cos_alpha), &sa(super_t::frame.sin_alpha);
+      return vec3_t(
+          (g[0] *  ca) + (g[1] * sa),
+          (g[0] * -sa) + (g[1] * ca),
+          g[2]);
     }
 };
 
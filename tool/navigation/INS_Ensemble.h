@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __INS_ENSEMBLE_H__
+#define __INS_ENSEMBLE_H__
+
+/** @file
+ * @brief Ensemble of independent INS propagated with the same IMU stream
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "INS.h"
+
+/**
+ * @brief Ensemble of independent strapdown INS
+ *
+ * The states of K members are stored in the structure-of-arrays form,
+ * where each state quantity of all members is contiguous, and are propagated
+ * by the same mechanization as INS::update() with a shared IMU sample,
+ * where the attitude is propagated with rotation quaternions as INS::set_attitude_by_rotation(true),
+ * for example, for Monte Carlo error analysis, or for initialization
+ * with multiple hypotheses of yaw angle.
+ * The loops over the members have neither dependency between iterations nor branches
+ * so as to be vectorized by compilers. Loops of pure arithmetic are separated from
+ * the ones calling transcendental functions, the latter of which are vectorized only
+ * when a vector math library is available to the compiler.
+ *
+ * @param FloatT precision
+ */
+template <class FloatT = double>
+class INS_Ensemble {
+  public:
+    typedef FloatT float_t;
+    typedef INS<float_t> ins_t;
+    typedef typename ins_t::vec3_t vec3_t;
+    typedef typename ins_t::quat_t quat_t;
+    typedef typename ins_t::Earth Earth;
+
+    enum field_t {
+      V_2E_4N_0, V_2E_4N_1, V_2E_4N_2,
+      Q_E2N_0, Q_E2N_1, Q_E2N_2, Q_E2N_3,
+      HEIGHT,
+      Q_N2B_0, Q_N2B_1, Q_N2B_2, Q_N2B_3, // the above are the states in the order of INS::operator[]
+      PHI, LAMBDA, ALPHA,
+      V_NORTH, V_EAST,
+      OMEGA_E2I_4N_0, OMEGA_E2I_4N_1, OMEGA_E2I_4N_2,
+      OMEGA_N2E_4N_0, OMEGA_N2E_4N_1,
+      SIN_PHI, COS_PHI, SIN_ALPHA, COS_ALPHA,
+      R_NORMAL, R_MERIDIAN,
+      FIELDS,
+    };
+
+  protected:
+    unsigned m_size;
+    std::vector<float_t> data; ///< FIELDS arrays, each of which has m_size elements
+
+    float_t *field(const field_t &i){return &data[(std::size_t)i * m_size];}
+    const float_t *field(const field_t &i) const {return &data[(std::size_t)i * m_size];}
+
+    /**
+     * Recalculate the derived quantities of members [k_begin, k_end)
+     * as INS::recalc().
+     */
+    void recalc(const unsigned &k_begin, const unsigned &k_end){
+      float_t *v0(field(V_2E_4N_0)), *v1(field(V_2E_4N_1));
+      float_t *qe0(field(Q_E2N_0)), *qe1(field(Q_E2N_1)), *qe2(field(Q_E2N_2)), *qe3(field(Q_E2N_3));
+      float_t *qb0(field(Q_N2B_0)), *qb1(field(Q_N2B_1)), *qb2(field(Q_N2B_2)), *qb3(field(Q_N2B_3));
+      float_t *h(field(HEIGHT)), *phi(field(PHI)), *lambda(field(LAMBDA)), *alpha(field(ALPHA));
+      float_t *v_N(field(V_NORTH)), *v_E(field(V_EAST));
+      float_t *wei0(field(OMEGA_E2I_4N_0)), *wei1(field(OMEGA_E2I_4N_1)), *wei2(field(OMEGA_E2I_4N_2));
+      float_t *wne0(field(OMEGA_N2E_4N_0)), *wne1(field(OMEGA_N2E_4N_1));
+      float_t *sp(field(SIN_PHI)), *cp(field(COS_PHI)), *sa(field(SIN_ALPHA)), *ca(field(COS_ALPHA));
+      float_t *Rn(field(R_NORMAL)), *Rm(field(R_MERIDIAN));
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+      for(unsigned k = k_begin; k < k_end; ++k){ // regularize
+        float_t ne(std::sqrt(qe0[k] * qe0[k] + qe1[k] * qe1[k] + qe2[k] * qe2[k] + qe3[k] * qe3[k]));
+        qe0[k] /= ne; qe1[k] /= ne; qe2[k] /= ne; qe3[k] /= ne;
+        float_t nb(std::sqrt(qb0[k] * qb0[k] + qb1[k] * qb1[k] + qb2[k] * qb2[k] + qb3[k] * qb3[k]));
+        qb0[k] /= nb; qb1[k] /= nb; qb2[k] /= nb; qb3[k] /= nb;
+      }
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+      for(unsigned k = k_begin; k < k_end; ++k){ // transcendental functions
+        phi[k] = std::asin(float_t(1) - (qe0[k] * qe0[k] + qe3[k] * qe3[k]) * 2);
+        lambda[k] = std::atan2(
+            (qe0[k] * qe1[k] - qe2[k] * qe3[k]),
+            (-qe0[k] * qe2[k] - qe1[k] * qe3[k]));
+        alpha[k] = std::atan2(
+            (-qe0[k] * qe1[k] - qe2[k] * qe3[k]),
+            (qe1[k] * qe3[k] - qe0[k] * qe2[k]));
+
+        sp[k] = std::sin(phi[k]); cp[k] = std::cos(phi[k]);
+        sa[k] = std::sin(alpha[k]); ca[k] = std::cos(alpha[k]);
+        Rn[k] = Earth::R_normal_sin(sp[k]);
+        Rm[k] = Earth::R_meridian_sin(sp[k]);
+      }
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+      for(unsigned k = k_begin; k < k_end; ++k){
+        v_N[k] = v0[k] * ca[k] - v1[k] * sa[k];
+        v_E[k] = v0[k] * sa[k] + v1[k] * ca[k];
+
+        { // omega_e2i_4n = q_e2n^{*} * {0, 0, Omega_Earth} * q_e2n
+          float_t s(Earth::Omega_Earth * 2);
+          wei0[k] = (qe1[k] * qe3[k] - qe0[k] * qe2[k]) * s;
+          wei1[k] = (qe2[k] * qe3[k] + qe0[k] * qe1[k]) * s;
+          wei2[k] = (qe0[k] * qe0[k] - qe1[k] * qe1[k] - qe2[k] * qe2[k] + qe3[k] * qe3[k]) * Earth::Omega_Earth;
+        }
+
+        { // omega_n2e_4n
+          float_t w_g0(v_E[k] / (Rn[k] + h[k])), w_g1(-v_N[k] / (Rm[k] + h[k]));
+          wne0[k] =  w_g0 * ca[k] + w_g1 * sa[k];
+          wne1[k] = -w_g0 * sa[k] + w_g1 * ca[k];
+        }
+      }
+    }
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param size number of members
+     * @param initial initial state of all members
+     */
+    INS_Ensemble(const unsigned &size, const ins_t &initial = ins_t())
+        : m_size(size), data((std::size_t)FIELDS * size) {
+      for(unsigned k(0); k < m_size; ++k){
+        copy_from(k, initial);
+      }
+    }
+
+    unsigned size() const {return m_size;}
+
+    /**
+     * Return the array of a quantity of all members.
+     *
+     * @param i quantity
+     * @return (const float_t *) array whose length is size()
+     */
+    const float_t *operator[](const field_t &i) const {return field(i);}
+
+    /**
+     * Set the state of a member from an INS.
+     *
+     * @param k index of the member
+     * @param ins source
+     */
+    void copy_from(const unsigned &k, const ins_t &ins){
+      for(unsigned i(0); i < ins_t::STATE_VALUES; ++i){
+        field((field_t)i)[k] = ins.get(i);
+      }
+      recalc(k, k + 1);
+    }
+
+    /**
+     * Set the state of a member to an INS.
+     *
+     * @param k index of the member
+     * @param ins destination
+     */
+    void copy_to(const unsigned &k, ins_t &ins) const {
+      for(unsigned i(0); i < ins_t::STATE_VALUES; ++i){
+        ins[i] = field((field_t)i)[k];
+      }
+      ins.recalc();
+    }
+
+    /**
+     * Initialize the attitude of a member.
+     *
+     * @param k index of the member
+     * @param yaw yaw angle [rad]
+     * @param pitch pitch angle [rad]
+     * @param roll roll angle [rad]
+     */
+    void initAttitude(const unsigned &k,
+        const float_t &yaw, const float_t &pitch, const float_t &roll){
+      quat_t q(ins_t::euler2q(yaw, pitch, roll));
+      for(unsigned i(0); i < 4; ++i){
+        field((field_t)(Q_N2B_0 + i))[k] = q[i];
+      }
+    }
+
+    /**
+     * Update all members with the same IMU sample as INS::update().
+     *
+     * @param accel acceleration [m/s^2]
+     * @param gyro angular speed [rad/s]
+     * @param deltaT interval from the last update [s]
+     */
+    void update(const vec3_t &accel, const vec3_t &gyro, const float_t &deltaT){
+      const quat_t q_b(ins_t::rotation2q(gyro * deltaT)); // common to all members
+      const float_t
+          a0(accel.get(0)), a1(accel.get(1)), a2(accel.get(2)),
+          r0(q_b.get(0)), r1(q_b.get(1)), r2(q_b.get(2)), r3(q_b.get(3));
+      float_t *v0(field(V_2E_4N_0)), *v1(field(V_2E_4N_1)), *v2(field(V_2E_4N_2));
+      float_t *qe0(field(Q_E2N_0)), *qe1(field(Q_E2N_1)), *qe2(field(Q_E2N_2)), *qe3(field(Q_E2N_3));
+      float_t *qb0(field(Q_N2B_0)), *qb1(field(Q_N2B_1)), *qb2(field(Q_N2B_2)), *qb3(field(Q_N2B_3));
+      float_t *h(field(HEIGHT));
+      const float_t *wei0(field(OMEGA_E2I_4N_0)), *wei1(field(OMEGA_E2I_4N_1)), *wei2(field(OMEGA_E2I_4N_2));
+      const float_t *wne0(field(OMEGA_N2E_4N_0)), *wne1(field(OMEGA_N2E_4N_1));
+      const float_t *sp(field(SIN_PHI));
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+      for(unsigned k = 0; k < m_size; ++k){
+        // Velocity; accel in the navigation frame, gravity, and Coriolis terms
+        float_t f0, f1, f2;
+        {
+          float_t t0(qb0[k] * a0 + qb2[k] * a2 - qb3[k] * a1),
+              t1(qb0[k] * a1 + qb3[k] * a0 - qb1[k] * a2),
+              t2(qb0[k] * a2 + qb1[k] * a1 - qb2[k] * a0); // q_n2b * accel
+          f0 = a0 + (qb2[k] * t2 - qb3[k] * t1) * 2;
+          f1 = a1 + (qb3[k] * t0 - qb1[k] * t2) * 2;
+          f2 = a2 + (qb1[k] * t1 - qb2[k] * t0) * 2;
+        }
+        f2 += Earth::gravity_sin(sp[k], h[k]);
+        {
+          float_t w0(wei0[k] * 2 + wne0[k]), w1(wei1[k] * 2 + wne1[k]), w2(wei2[k] * 2);
+          f0 -= w1 * v2[k] - w2 * v1[k];
+          f1 -= w2 * v0[k] - w0 * v2[k];
+          f2 -= w0 * v1[k] - w1 * v0[k];
+        }
+
+        // Attitude (first half); q_n2b * q_b
+        float_t p0(qb0[k] * r0 - qb1[k] * r1 - qb2[k] * r2 - qb3[k] * r3),
+            p1(qb0[k] * r1 + qb1[k] * r0 + qb2[k] * r3 - qb3[k] * r2),
+            p2(qb0[k] * r2 - qb1[k] * r3 + qb2[k] * r0 + qb3[k] * r1),
+            p3(qb0[k] * r3 + qb1[k] * r2 - qb2[k] * r1 + qb3[k] * r0);
+        qb0[k] = p0; qb1[k] = p1; qb2[k] = p2; qb3[k] = p3;
+
+        // Position; q_e2n += q_e2n * {0, omega_n2e_4n} / 2 * deltaT, h += -v_D * deltaT
+        {
+          float_t s(deltaT / 2);
+          float_t d0(-qe1[k] * wne0[k] - qe2[k] * wne1[k]),
+              d1(qe0[k] * wne0[k] - qe3[k] * wne1[k]),
+              d2(qe0[k] * wne1[k] + qe3[k] * wne0[k]),
+              d3(qe1[k] * wne1[k] - qe2[k] * wne0[k]);
+          qe0[k] += d0 * s; qe1[k] += d1 * s; qe2[k] += d2 * s; qe3[k] += d3 * s;
+        }
+        h[k] -= v2[k] * deltaT;
+
+        v0[k] += f0 * deltaT;
+        v1[k] += f1 * deltaT;
+        v2[k] += f2 * deltaT;
+      }
+#if defined(_OPENMP)
+#pragma omp simd
+#endif
+      for(unsigned k = 0; k < m_size; ++k){
+        // Attitude (second half); q_n2b_next = q_n * (q_n2b * q_b),
+        // q_n = rotation2q((omega_e2i_4n + omega_n2e_4n) * -deltaT),
+        // whose small angle approximation is selected without branch.
+        // cos and sin of theta / 2 are obtained from a single tan(theta / 4),
+        // because a pair of cos and sin is fused into sincos, which is not vectorized.
+        float_t u0((wei0[k] + wne0[k]) * -deltaT),
+            u1((wei1[k] + wne1[k]) * -deltaT),
+            u2(wei2[k] * -deltaT);
+        float_t theta2(u0 * u0 + u1 * u1 + u2 * u2);
+        float_t theta(std::sqrt(theta2));
+        float_t t(std::tan(theta / 4)), t2(t * t);
+        float_t n0((theta2 < 1E-8)
+            ? (float_t(1) - theta2 / 8)
+            : ((float_t(1) - t2) / (float_t(1) + t2)));
+        float_t n_s((theta2 < 1E-8)
+            ? (float_t(0.5) - theta2 / 48)
+            : (t * 2 / (float_t(1) + t2) / ((theta2 < 1E-8) ? float_t(1) : theta)));
+        u0 *= n_s; u1 *= n_s; u2 *= n_s;
+        float_t p0(qb0[k]), p1(qb1[k]), p2(qb2[k]), p3(qb3[k]);
+        qb0[k] = n0 * p0 - u0 * p1 - u1 * p2 - u2 * p3;
+        qb1[k] = n0 * p1 + u0 * p0 + u1 * p3 - u2 * p2;
+        qb2[k] = n0 * p2 - u0 * p3 + u1 * p0 + u2 * p1;
+        qb3[k] = n0 * p3 + u0 * p2 - u1 * p1 + u2 * p0;
+      }
+      recalc(0, m_size);
+    }
+
+    const float_t &v_north(const unsigned &k) const {return field(V_NORTH)[k];}
+    const float_t &v_east(const unsigned &k) const {return field(V_EAST)[k];}
+    const float_t &v_down(const unsigned &k) const {return field(V_2E_4N_2)[k];}
+    const float_t &latitude(const unsigned &k) const {return field(PHI)[k];}
+    const float_t &longitude(const unsigned &k) const {return field(LAMBDA)[k];}
+    const float_t &height(const unsigned &k) const {return field(HEIGHT)[k];}
+    const float_t &azimuth(const unsigned &k) const {return field(ALPHA)[k];}
+
+    /**
+     * @return (quat_t) attitude of a member
+     */
+    quat_t n2b(const unsigned &k) const {
+      return quat_t(
+          field(Q_N2B_0)[k], field(Q_N2B_1)[k], field(Q_N2B_2)[k], field(Q_N2B_3)[k]);
+    }
+    float_t euler_psi(const unsigned &k) const {return ins_t::q2psi(n2b(k));}
+    float_t euler_theta(const unsigned &k) const {return ins_t::q2theta(n2b(k));}
+    float_t euler_phi(const unsigned &k) const {return ins_t::q2phi(n2b(k));}
+    float_t heading(const unsigned &k) const {
+      float_t _heading(euler_psi(k) + azimuth(k));
+      return _heading > M_PI ? (_heading - (2 * M_PI)) : (_heading < -M_PI ? (_heading + (2 * M_PI)) : _heading);
+    }
+};
+
+#endif /* __INS_ENSEMBLE_H__ */
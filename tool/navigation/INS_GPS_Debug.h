@@ -39,6 +39,7 @@
 
 #include "param/matrix.h"
 #include "Filtered_INS2.h"
+#include "INS_GPS_Debug_Dump.h"
 
 struct INS_GPS_Debug_Property {
   enum debug_target_t {DEBUG_NONE, DEBUG_KF_P, DEBUG_KF_FULL, DEBUG_PURE_INERTIAL} debug_target;
@@ -95,6 +96,12 @@ class INS_GPS_Debug : public INS_GPS, protected INS_GPS_Debug_Property {
     }
 
     virtual void inspect(std::ostream &out) const {}
+    /**
+     * Write a record of the binary debug dump.
+     *
+     * @param t time stamp [s]
+     */
+    virtual void inspect_binary(INS_GPS_Debug_Dump_Writer &writer, const double &t) const {}
 };
 
 template <class INS_GPS>
@@ -111,14 +118,17 @@ class INS_GPS_Debug_Covariance : public INS_GPS_Debug<INS_GPS> {
   protected:
     enum {ACTION_LAST_NOP, ACTION_LAST_UPDATE, ACTION_LAST_CORRECT} last_action;
     struct snapshot_t {
-      mat_t A, B, H, R, K;
-      snapshot_t() : A(), B(), H(), R(), K() {}
+      mat_t A, B, H, R, K, v;
+      float_t elapsedT;
+      snapshot_t() : A(), B(), H(), R(), K(), v(), elapsedT(0) {}
       snapshot_t(const snapshot_t &orig, const bool &deepcopy = false)
           : A(deepcopy ? orig.A.copy() : orig.A),
             B(deepcopy ? orig.B.copy() : orig.B),
             H(deepcopy ? orig.H.copy() : orig.H),
             R(deepcopy ? orig.R.copy() : orig.R),
-            K(deepcopy ? orig.K.copy() : orig.K) {}
+            K(deepcopy ? orig.K.copy() : orig.K),
+            v(deepcopy ? orig.v.copy() : orig.v),
+            elapsedT(orig.elapsedT) {}
     } snapshot;
   public:
     INS_GPS_Debug_Covariance()
@@ -128,17 +138,32 @@ class INS_GPS_Debug_Covariance : public INS_GPS_Debug<INS_GPS> {
         const bool &deepcopy = false)
         : super_t(orig, deepcopy), last_action(orig.last_action), snapshot(orig.snapshot, deepcopy) {}
     INS_GPS_Debug_Covariance<INS_GPS> &operator=(const INS_GPS_Debug_Covariance<INS_GPS> &another){
-      INS_GPS_Debug_Covariance<INS_GPS>::operator=(another);
+      super_t::operator=(another);
       last_action = another.last_action;
       snapshot.A = another.snapshot.A;
       snapshot.B = another.snapshot.B;
       snapshot.H = another.snapshot.H;
       snapshot.R = another.snapshot.R;
       snapshot.K = another.snapshot.K;
+      snapshot.v = another.snapshot.v;
+      snapshot.elapsedT = another.snapshot.elapsedT;
       return *this;
     }
     virtual ~INS_GPS_Debug_Covariance(){}
 
+    /**
+     * @return (mat_t) P as of the last propagation, pending decimated propagation is not flushed
+     */
+    mat_t current_P() const {
+      mat_t P(super_t::P_SIZE, super_t::P_SIZE);
+      for(unsigned int i(0); i < super_t::P_SIZE; ++i){
+        for(unsigned int j(i); j < super_t::P_SIZE; ++j){
+          P(i, j) = P(j, i) = super_t::getFilter().getP(i, j);
+        }
+      }
+      return P;
+    }
+
     static void inspect_matrix(
         std::ostream &out, const mat_t &mat){
       for(int i(0); i < mat.rows(); i++){
@@ -153,10 +178,9 @@ class INS_GPS_Debug_Covariance : public INS_GPS_Debug<INS_GPS> {
       inspect_matrix(out, mat);
     }
     void inspect(std::ostream &out) const {
-      typedef INS_GPS_Debug_Covariance<INS_GPS> self_t;
       switch(super_t::debug_target){
         case super_t::DEBUG_KF_P:
-          inspect_matrix(out, const_cast<self_t *>(this)->getFilter().getP());
+          inspect_matrix(out, current_P());
           break;
         case super_t::DEBUG_KF_FULL:
           switch(last_action){
@@ -172,11 +196,40 @@ class INS_GPS_Debug_Covariance : public INS_GPS_Debug<INS_GPS> {
               inspect_matrix2(out, snapshot.K, "K");
               break;
           }
-          inspect_matrix2(out, const_cast<self_t *>(this)->getFilter().getP(), "P");
+          inspect_matrix2(out, current_P(), "P");
           break;
       }
     }
 
+    /**
+     * Write P, and additionally Phi, K, and residual when DEBUG_KF_FULL.
+     * Nothing is prepared when the record is thinned out by the writer.
+     */
+    void inspect_binary(INS_GPS_Debug_Dump_Writer &writer, const double &t) const {
+      int action(INS_GPS_Debug_Dump_Format::ACTION_NOP);
+      switch(last_action){
+        case ACTION_LAST_UPDATE: action = INS_GPS_Debug_Dump_Format::ACTION_TIME_UPDATE; break;
+        case ACTION_LAST_CORRECT: action = INS_GPS_Debug_Dump_Format::ACTION_MEASUREMENT_UPDATE; break;
+        default: break;
+      }
+      if(!writer.due(t, action)){return;}
+      mat_t P(current_P());
+      if((super_t::debug_target != super_t::DEBUG_KF_FULL)
+          || (action == INS_GPS_Debug_Dump_Format::ACTION_NOP)){
+        writer.write(t, action, P);
+      }else if(action == INS_GPS_Debug_Dump_Format::ACTION_TIME_UPDATE){
+        if(writer.dump_contents() & INS_GPS_Debug_Dump_Format::CONTENT_PHI){
+          mat_t Phi(snapshot.A * snapshot.elapsedT);
+          for(unsigned int i(0); i < Phi.rows(); i++){Phi(i, i) += 1;}
+          writer.write(t, action, P, &Phi);
+        }else{
+          writer.write(t, action, P);
+        }
+      }else{
+        writer.write(t, action, P, (const mat_t *)NULL, &snapshot.K, &snapshot.v);
+      }
+    }
+
   protected:
     void before_update_INS(
         const mat_t &A, const mat_t &B,
@@ -184,6 +237,7 @@ class INS_GPS_Debug_Covariance : public INS_GPS_Debug<INS_GPS> {
       last_action = ACTION_LAST_UPDATE;
       snapshot.A = A;
       snapshot.B = B;
+      snapshot.elapsedT = elapsedT;
       super_t::before_update_INS(A, B, elapsedT);
     }
 
@@ -197,6 +251,7 @@ class INS_GPS_Debug_Covariance : public INS_GPS_Debug<INS_GPS> {
       snapshot.H = H;
       snapshot.R = R;
       snapshot.K = K;
+      snapshot.v = v;
       super_t::before_correct_INS(H, R, K, v, x_hat);
     }
 };
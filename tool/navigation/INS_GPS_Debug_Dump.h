@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __INS_GPS_DEBUG_DUMP_H__
+#define __INS_GPS_DEBUG_DUMP_H__
+
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+/**
+ * @brief Binary format of the Kalman filter debug dump
+ *
+ * A dump consists of a header, and fixed-size records each of which is written per update.
+ * All values are in the byte order of the writer machine; integers are 4 bytes,
+ * and real numbers are 8 bytes (double).
+ * A record consists of, in this order,
+ * - time [s], action (ACTION_*), and dimension of measurement (zero for the time update),
+ * - upper triangle of the covariance matrix P after the update, packed in row major order,
+ *   i.e., P(0,0), P(0,1), ..., P(0,n-1), P(1,1), ..., P(n-1,n-1),
+ * - (when CONTENT_PHI) state transition matrix @f$ \Phi = I + A \Delta t @f$ of the time update
+ *   in row major order,
+ * - (when CONTENT_K) Kalman gain K (n * m) of the measurement update
+ *   in row major order whose row stride is measurements_max,
+ * - (when CONTENT_RESIDUAL) measurement residual z (m), padded up to measurements_max.
+ * The items which are not relevant to the action of the record are filled with zeros.
+ * Measurements beyond measurements_max are truncated.
+ */
+struct INS_GPS_Debug_Dump_Format {
+  enum action_t {
+    ACTION_NOP = 0,
+    ACTION_TIME_UPDATE = 1,
+    ACTION_MEASUREMENT_UPDATE = 2,
+    ACTIONS
+  };
+  enum content_t {
+    CONTENT_PHI = 0x01,
+    CONTENT_K = 0x02,
+    CONTENT_RESIDUAL = 0x04
+  };
+  static const char *magic() {return "INSDBGP1";}
+
+  struct header_t {
+    char magic[8];
+    int value_size; ///< size of real number, which is always sizeof(double)
+    int states; ///< dimension of state, n
+    int measurements_max; ///< maximum dimension of measurement, m_max
+    int contents; ///< combination of CONTENT_*
+    int record_size; ///< size of a record in bytes
+    int reserved;
+  };
+  struct record_head_t {
+    double time;
+    int action;
+    int measurements;
+  };
+
+  /**
+   * Offsets of items in a record, in units of double, following record_head_t.
+   */
+  struct layout_t {
+    int states, measurements_max, contents;
+    std::size_t P, Phi, K, residual, values;
+    layout_t(const int &n = 0, const int &m_max = 0, const int &contents_ = 0)
+        : states(n), measurements_max(m_max), contents(contents_) {
+      P = 0;
+      Phi = P + (std::size_t)n * (n + 1) / 2;
+      K = Phi + ((contents & CONTENT_PHI) ? (std::size_t)n * n : 0);
+      residual = K + ((contents & CONTENT_K) ? (std::size_t)n * m_max : 0);
+      values = residual + ((contents & CONTENT_RESIDUAL) ? m_max : 0);
+    }
+    std::size_t record_size() const {
+      return sizeof(record_head_t) + sizeof(double) * values;
+    }
+    /**
+     * @return (std::size_t) index of the upper triangle element, which is symmetrically accessible.
+     */
+    std::size_t P_index(int i, int j) const {
+      if(i > j){int k(i); i = j; j = k;}
+      return P + (std::size_t)i * states - (std::size_t)i * (i - 1) / 2 + (j - i);
+    }
+  };
+};
+
+/**
+ * Writer of the debug dump.
+ * Records are accumulated in a large buffer and written in blocks.
+ * Records can be thinned out by the minimum interval, which is applied to each action independently,
+ * so that a measurement update is not hidden by time updates.
+ */
+class INS_GPS_Debug_Dump_Writer : public INS_GPS_Debug_Dump_Format {
+  protected:
+    std::ostream *out;
+    int contents, measurements_max;
+    double interval;
+    layout_t layout;
+    std::vector<char> buf;
+    std::size_t buf_size;
+    struct {
+      bool valid;
+      double time;
+    } last[ACTIONS];
+    unsigned int m_records;
+
+    INS_GPS_Debug_Dump_Writer(const INS_GPS_Debug_Dump_Writer &);
+    INS_GPS_Debug_Dump_Writer &operator=(const INS_GPS_Debug_Dump_Writer &);
+
+    void write_header(const int &n){
+      int m_max(measurements_max > 0 ? measurements_max : n);
+      layout = layout_t(n, m_max, contents);
+      header_t header;
+      std::memset(&header, 0, sizeof(header));
+      std::memcpy(header.magic, magic(), sizeof(header.magic));
+      header.value_size = sizeof(double);
+      header.states = n;
+      header.measurements_max = m_max;
+      header.contents = contents;
+      header.record_size = (int)layout.record_size();
+      out->write((const char *)&header, sizeof(header));
+    }
+
+  public:
+    INS_GPS_Debug_Dump_Writer()
+        : out(NULL), contents(0), measurements_max(0), interval(0),
+        layout(), buf(), buf_size(0), m_records(0) {
+      for(int i(0); i < ACTIONS; i++){last[i].valid = false;}
+    }
+    ~INS_GPS_Debug_Dump_Writer(){
+      flush();
+    }
+
+    /**
+     * Start dump. The header is written with the first record.
+     *
+     * @param out_ output stream, which should be opened in binary mode
+     * @param contents_ combination of CONTENT_*
+     * @param interval_ minimum interval of records of each action [s]; zero means all records
+     * @param measurements_max_ maximum dimension of measurement; zero means the dimension of state
+     * @param buffer_size size of the write buffer in bytes
+     */
+    void open(std::ostream &out_,
+        const int &contents_ = 0,
+        const double &interval_ = 0,
+        const int &measurements_max_ = 0,
+        const std::size_t &buffer_size = 0x400000){
+      flush();
+      out = &out_;
+      contents = contents_;
+      interval = interval_;
+      measurements_max = measurements_max_;
+      layout = layout_t();
+      buf.resize(buffer_size);
+      m_records = 0;
+      for(int i(0); i < ACTIONS; i++){last[i].valid = false;}
+    }
+    bool active() const {return out != NULL;}
+    unsigned int records() const {return m_records;}
+    int dump_contents() const {return contents;}
+
+    /**
+     * Check whether a record of the action at the time should be written,
+     * which is invoked prior to write() to skip preparation of unnecessary records.
+     */
+    bool due(const double &t, const int &action){
+      if(!out){return false;}
+      if(interval <= 0){return true;}
+      if(last[action].valid && ((t - last[action].time) < (interval - 1E-6)) // 1E-6 for rounding of time stamps
+          && (t >= last[action].time)){ // rewind of time resets thinning.
+        return false;
+      }
+      last[action].valid = true;
+      last[action].time = t;
+      return true;
+    }
+
+    /**
+     * Write a record.
+     *
+     * @param t time [s]
+     * @param action ACTION_*
+     * @param P covariance matrix (n * n)
+     * @param Phi state transition matrix (n * n), or NULL
+     * @param K Kalman gain (n * m), or NULL
+     * @param z residual (m * 1), or NULL
+     */
+    template <class MatrixT>
+    void write(const double &t, const int &action,
+        const MatrixT &P,
+        const MatrixT *Phi = NULL, const MatrixT *K = NULL, const MatrixT *z = NULL){
+      if(!out){return;}
+      const int n(P.rows());
+      if(layout.states == 0){write_header(n);}
+      if(n != layout.states){return;} // dimension must be kept
+
+      std::size_t record_size(layout.record_size());
+      if(buf_size + record_size > buf.size()){
+        flush();
+        if(record_size > buf.size()){buf.resize(record_size);}
+      }
+      char *record(&buf[buf_size]);
+      std::memset(record, 0, record_size);
+
+      record_head_t head;
+      std::memset(&head, 0, sizeof(head));
+      head.time = t;
+      head.action = action;
+      int m(0);
+      if(K){m = K->columns();}else if(z){m = z->rows();}
+      head.measurements = m;
+      std::memcpy(record, &head, sizeof(head));
+
+      double *v((double *)(record + sizeof(head)));
+      for(int i(0), k(layout.P); i < n; i++){
+        for(int j(i); j < n; j++){
+          v[k++] = (double)P(i, j);
+        }
+      }
+      if(m > layout.measurements_max){m = layout.measurements_max;}
+      if(Phi && (layout.contents & CONTENT_PHI)){
+        for(int i(0), k(layout.Phi); i < n; i++){
+          for(int j(0); j < n; j++){
+            v[k++] = (double)(*Phi)(i, j);
+          }
+        }
+      }
+      if(K && (layout.contents & CONTENT_K)){
+        for(int i(0); i < n; i++){
+          for(int j(0); j < m; j++){
+            v[layout.K + (std::size_t)i * layout.measurements_max + j] = (double)(*K)(i, j);
+          }
+        }
+      }
+      if(z && (layout.contents & CONTENT_RESIDUAL)){
+        for(int i(0); i < m; i++){
+          v[layout.residual + i] = (double)(*z)(i, 0);
+        }
+      }
+      buf_size += record_size;
+      m_records++;
+    }
+
+    void flush(){
+      if(!out){return;}
+      if(buf_size > 0){out->write(&buf[0], buf_size);}
+      buf_size = 0;
+      out->flush();
+    }
+};
+
+/**
+ * Reader of the debug dump.
+ * Records are read sequentially by next(), or randomly by seek() owing to their fixed size.
+ */
+class INS_GPS_Debug_Dump_Reader : public INS_GPS_Debug_Dump_Format {
+  protected:
+    std::istream &in;
+    header_t header;
+    layout_t layout;
+    std::vector<char> record;
+    bool m_valid;
+
+    const record_head_t &head() const {
+      return *(const record_head_t *)&record[0];
+    }
+    const double *values() const {
+      return (const double *)(&record[0] + sizeof(record_head_t));
+    }
+
+  public:
+    INS_GPS_Debug_Dump_Reader(std::istream &in_)
+        : in(in_), header(), layout(), record(), m_valid(false) {
+      if(!in.read((char *)&header, sizeof(header))
+          || (std::string(header.magic, sizeof(header.magic)) != magic())
+          || (header.value_size != sizeof(double))
+          || (header.states <= 0) || (header.measurements_max < 0)){
+        return;
+      }
+      layout = layout_t(header.states, header.measurements_max, header.contents);
+      if((int)layout.record_size() != header.record_size){return;}
+      record.resize(layout.record_size());
+      m_valid = true;
+    }
+
+    /**
+     * @return (bool) true when the header is valid
+     */
+    bool valid() const {return m_valid;}
+    int states() const {return header.states;}
+    int measurements_max() const {return header.measurements_max;}
+    int contents() const {return header.contents;}
+
+    /**
+     * Read the next record.
+     *
+     * @return (bool) true when read, otherwise false (end of the dump)
+     */
+    bool next(){
+      if(!m_valid){return false;}
+      return (bool)in.read(&record[0], record.size());
+    }
+    /**
+     * Move to the specified record, which is read by the following next().
+     * The stream must be seekable.
+     */
+    bool seek(const std::size_t &index){
+      if(!m_valid){return false;}
+      in.clear();
+      return (bool)in.seekg(
+          (std::streamoff)(sizeof(header_t) + record.size() * index), std::ios::beg);
+    }
+
+    double time() const {return head().time;}
+    int action() const {return head().action;}
+    int measurements() const {return head().measurements;}
+    double P(const int &i, const int &j) const {
+      return values()[layout.P_index(i, j)];
+    }
+    double Phi(const int &i, const int &j) const {
+      return (layout.contents & CONTENT_PHI)
+          ? values()[layout.Phi + (std::size_t)i * layout.states + j]
+          : 0;
+    }
+    double K(const int &i, const int &j) const {
+      return (layout.contents & CONTENT_K)
+          ? values()[layout.K + (std::size_t)i * layout.measurements_max + j]
+          : 0;
+    }
+    double residual(const int &i) const {
+      return (layout.contents & CONTENT_RESIDUAL)
+          ? values()[layout.residual + i]
+          : 0;
+    }
+};
+
+#endif /* __INS_GPS_DEBUG_DUMP_H__ */
@@ -20,8 +20,275 @@
 #ifndef __INS_GPS_SYNCHRONIZATION__
 #define __INS_GPS_SYNCHRONIZATION__
 
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <vector>
+#include <algorithm>
+
 #include "param/matrix.h"
 #include "param/vector3.h"
+#include "util/spill_file.h"
+
+/**
+ * Ring buffer to hold snapshots of INS/GPS.
+ * The storage is preallocated, and slots are reused without any reallocation
+ * as long as the number of the elements does not exceed the capacity.
+ * Pruning the oldest elements is performed by advancing the head index.
+ * When the capacity is insufficient, it is extended automatically.
+ *
+ * @param T type of element
+ */
+template <class T>
+class INS_GPS_Snapshot_Buffer {
+  public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+  protected:
+    T *m_buf;
+    size_type m_capacity, m_head, m_size;
+
+    T *slot(const size_type &index) const {
+      size_type i(m_head + index);
+      if(i >= m_capacity){i -= m_capacity;}
+      return m_buf + i;
+    }
+
+    template <class U, class Buffer>
+    struct iterator_base {
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef T value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef U *pointer;
+      typedef U &reference;
+      Buffer *buf;
+      size_type index;
+      iterator_base(Buffer *_buf = NULL, const size_type &_index = 0)
+          : buf(_buf), index(_index) {}
+      reference operator*() const {return *(buf->slot(index));}
+      pointer operator->() const {return buf->slot(index);}
+      iterator_base &operator++(){++index; return *this;}
+      iterator_base operator++(int){iterator_base res(*this); ++index; return res;}
+      iterator_base &operator--(){--index; return *this;}
+      iterator_base operator--(int){iterator_base res(*this); --index; return res;}
+      bool operator==(const iterator_base &another) const {return index == another.index;}
+      bool operator!=(const iterator_base &another) const {return index != another.index;}
+    };
+
+  public:
+    typedef iterator_base<T, INS_GPS_Snapshot_Buffer> iterator;
+    typedef iterator_base<const T, const INS_GPS_Snapshot_Buffer> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    INS_GPS_Snapshot_Buffer() : m_buf(NULL), m_capacity(0), m_head(0), m_size(0) {}
+    INS_GPS_Snapshot_Buffer(const INS_GPS_Snapshot_Buffer &orig)
+        : m_buf(NULL), m_capacity(0), m_head(0), m_size(0) {
+      *this = orig;
+    }
+    ~INS_GPS_Snapshot_Buffer(){
+      clear();
+      ::operator delete(m_buf);
+    }
+    INS_GPS_Snapshot_Buffer &operator=(const INS_GPS_Snapshot_Buffer &another){
+      if(this != &another){
+        clear();
+        reserve(another.m_capacity);
+        for(size_type i(0); i < another.m_size; ++i){
+          push_back(another[i]);
+        }
+      }
+      return *this;
+    }
+
+    size_type size() const {return m_size;}
+    size_type capacity() const {return m_capacity;}
+    bool empty() const {return m_size == 0;}
+
+    /**
+     * Extend the capacity. The existing elements are copied into the new storage.
+     *
+     * @param new_capacity new capacity, which is ignored when it is less than the current one
+     */
+    void reserve(const size_type &new_capacity){
+      if(new_capacity <= m_capacity){return;}
+      set_capacity(new_capacity);
+    }
+
+    /**
+     * Change the capacity exactly. When the capacity is less than the number of the elements,
+     * the oldest elements are removed.
+     *
+     * @param new_capacity new capacity
+     */
+    void set_capacity(const size_type &new_capacity){
+      if(new_capacity == m_capacity){return;}
+      if(new_capacity < m_size){pop_front(m_size - new_capacity);}
+      T *buf_new(static_cast<T *>(::operator new(sizeof(T) * new_capacity)));
+      for(size_type i(0); i < m_size; ++i){
+        T *src(slot(i));
+        new (buf_new + i) T(*src);
+        src->~T();
+      }
+      ::operator delete(m_buf);
+      m_buf = buf_new;
+      m_capacity = new_capacity;
+      m_head = 0;
+    }
+
+    /**
+     * Return storage next to the last element, where a new element will be constructed
+     * by using placement new. The constructed element becomes valid after commit_back().
+     *
+     * @return (void *) storage next to the last element
+     */
+    void *reserve_back(){
+      if(m_size >= m_capacity){
+        reserve(m_capacity > 0 ? (m_capacity * 2) : 0x10);
+      }
+      return slot(m_size);
+    }
+    void commit_back(){++m_size;}
+    void push_back(const T &v){
+      new (reserve_back()) T(v);
+      commit_back();
+    }
+    void pop_back(){
+      slot(--m_size)->~T();
+    }
+    /**
+     * Remove the specified number of the oldest elements.
+     *
+     * @param n number of elements to be removed
+     */
+    void pop_front(size_type n = 1){
+      if(n > m_size){n = m_size;}
+      for(; n > 0; --n, --m_size){
+        m_buf[m_head].~T();
+        if(++m_head >= m_capacity){m_head = 0;}
+      }
+      if(m_size == 0){m_head = 0;}
+    }
+    void clear(){pop_front(m_size);}
+
+    T &operator[](const size_type &index){return *slot(index);}
+    const T &operator[](const size_type &index) const {return *slot(index);}
+    T &front(){return *slot(0);}
+    const T &front() const {return *slot(0);}
+    T &back(){return *slot(m_size - 1);}
+    const T &back() const {return *slot(m_size - 1);}
+
+    iterator begin(){return iterator(this, 0);}
+    iterator end(){return iterator(this, m_size);}
+    const_iterator begin() const {return const_iterator(this, 0);}
+    const_iterator end() const {return const_iterator(this, m_size);}
+    reverse_iterator rbegin(){return reverse_iterator(end());}
+    reverse_iterator rend(){return reverse_iterator(begin());}
+    const_reverse_iterator rbegin() const {return const_reverse_iterator(end());}
+    const_reverse_iterator rend() const {return const_reverse_iterator(begin());}
+};
+
+/**
+ * Fixed-size record of INS/GPS at a time update, which is trivially copyable
+ * so that taking a snapshot is a plain copy of values without any allocation.
+ * It consists of the states, and matrix A, the interval,
+ * and the process noise @f$ \Gamma Q \Gamma^{T} @f$ of the time update;
+ * the symmetric one is packed in upper triangle in column major order.
+ * The INS/GPS is rebuilt from the record by restore() only when it is required.
+ *
+ * @param INS_GPS type of INS/GPS
+ */
+template <class INS_GPS>
+struct INS_GPS_Snapshot_Record {
+  typedef typename INS_GPS::float_t float_t;
+  typedef typename INS_GPS::mat_t mat_t;
+
+  float_t x[INS_GPS::STATE_VALUES];
+  float_t A[INS_GPS::P_SIZE][INS_GPS::P_SIZE];
+  float_t GQGt[INS_GPS::P_SIZE * (INS_GPS::P_SIZE + 1) / 2];
+  float_t elapsedT;
+
+  static unsigned int packed_index(const unsigned int &i, const unsigned int &j){
+    return (i <= j) ? (j * (j + 1) / 2 + i) : (i * (i + 1) / 2 + j);
+  }
+
+  /**
+   * Record the matrices of a time update
+   *
+   * @param _A matrix A
+   * @param B matrix B
+   * @param Q matrix Q
+   * @param _elapsedT interval time
+   */
+  void set(
+      const mat_t &_A, const mat_t &B, const mat_t &Q,
+      const float_t &_elapsedT){
+    for(unsigned int i(0); i < INS_GPS::P_SIZE; ++i){
+      for(unsigned int j(0); j < INS_GPS::P_SIZE; ++j){A[i][j] = _A(i, j);}
+    }
+    elapsedT = _elapsedT;
+
+    // GQGt = (B dt) Q (B dt)^{T}
+    float_t BQ[INS_GPS::Q_SIZE];
+    float_t dt2(elapsedT * elapsedT);
+    for(unsigned int i(0); i < INS_GPS::P_SIZE; ++i){
+      for(unsigned int k(0); k < INS_GPS::Q_SIZE; ++k){
+        float_t sum(0);
+        for(unsigned int l(0); l < INS_GPS::Q_SIZE; ++l){sum += B(i, l) * Q(l, k);}
+        BQ[k] = sum;
+      }
+      for(unsigned int j(0); j <= i; ++j){
+        float_t sum(0);
+        for(unsigned int k(0); k < INS_GPS::Q_SIZE; ++k){sum += BQ[k] * B(j, k);}
+        GQGt[packed_index(j, i)] = sum * dt2;
+      }
+    }
+  }
+
+  /**
+   * Record the states
+   *
+   * @param ins_gps INS/GPS to be recorded
+   */
+  void save(const INS_GPS &ins_gps){
+    for(unsigned int i(0); i < INS_GPS::STATE_VALUES; ++i){x[i] = ins_gps[i];}
+  }
+  /**
+   * Restore the recorded states
+   *
+   * @param ins_gps INS/GPS to which the states are restored
+   */
+  void restore(INS_GPS &ins_gps) const {
+    for(unsigned int i(0); i < INS_GPS::STATE_VALUES; ++i){ins_gps[i] = x[i];}
+    ins_gps.recalc(false);
+  }
+
+  mat_t getA() const {
+    return mat_t(INS_GPS::P_SIZE, INS_GPS::P_SIZE, (const float_t *)A);
+  }
+  /**
+   * @return (mat_t) @f$ \Phi = I + A \Delta t @f$
+   */
+  mat_t getPhi() const {
+    mat_t Phi(mat_t::blank(INS_GPS::P_SIZE, INS_GPS::P_SIZE));
+    for(unsigned int i(0); i < INS_GPS::P_SIZE; ++i){
+      for(unsigned int j(0); j < INS_GPS::P_SIZE; ++j){
+        Phi(i, j) = A[i][j] * elapsedT;
+      }
+      Phi(i, i) += 1;
+    }
+    return Phi;
+  }
+  mat_t getGQGt() const {
+    mat_t GQGt_(mat_t::blank(INS_GPS::P_SIZE, INS_GPS::P_SIZE));
+    for(unsigned int j(0); j < INS_GPS::P_SIZE; ++j){
+      for(unsigned int i(0); i <= j; ++i){GQGt_(i, j) = GQGt_(j, i) = GQGt[packed_index(i, j)];}
+    }
+    return GQGt_;
+  }
+};
 
 template <class FloatT>
 struct INS_GPS_Back_Propagate_Property {
@@ -30,7 +297,11 @@ struct INS_GPS_Back_Propagate_Property {
    * Zero means the last snapshot to be corrected, and negative values mean deeper.
    */
   FloatT back_propagate_depth;
-  INS_GPS_Back_Propagate_Property() : back_propagate_depth(0) {}
+  /**
+   * Expected rate of time update [Hz], which is used to preallocate the snapshot buffer.
+   */
+  FloatT time_update_rate;
+  INS_GPS_Back_Propagate_Property() : back_propagate_depth(0), time_update_rate(100) {}
 };
 
 template <class INS_GPS>
@@ -44,36 +315,87 @@ class INS_GPS_Back_Propagate : public INS_GPS, protected INS_GPS_Back_Propagate_
     using typename INS_GPS::mat_t;
 #endif
   public:
-    struct snapshot_content_t {
-      INS_GPS ins_gps;
-      mat_t Phi;
-      mat_t GQGt;
+    /**
+     * Snapshot, which additionally holds the covariance P packed in upper triangle.
+     */
+    struct snapshot_content_t : public INS_GPS_Snapshot_Record<INS_GPS> {
+      typedef INS_GPS_Snapshot_Record<INS_GPS> super_t;
+      float_t P[INS_GPS::P_SIZE * (INS_GPS::P_SIZE + 1) / 2];
       float_t elapsedT_from_last_correct;
-      snapshot_content_t(
-          const INS_GPS &_ins_gps,
-          const mat_t &_Phi,
-          const mat_t &_GQGt,
-          const float_t &_elapsedT)
-          : ins_gps(_ins_gps, true), Phi(_Phi), GQGt(_GQGt),
-          elapsedT_from_last_correct(_elapsedT){
+
+      /**
+       * Record the states and P
+       *
+       * @param ins_gps INS/GPS to be recorded
+       */
+      void save(const INS_GPS &ins_gps){
+        super_t::save(ins_gps);
+        for(unsigned int j(0); j < INS_GPS::P_SIZE; ++j){
+          for(unsigned int i(0); i <= j; ++i){
+            P[super_t::packed_index(i, j)] = ins_gps.getFilter().getP(i, j); // without flush
+          }
+        }
+      }
+      /**
+       * Restore the states and P
+       *
+       * @param ins_gps INS/GPS to which the record is restored
+       */
+      void restore(INS_GPS &ins_gps) const {
+        super_t::restore(ins_gps);
+        ins_gps.getFilter().setP(getP());
+      }
+      mat_t getP() const {
+        mat_t P_(mat_t::blank(INS_GPS::P_SIZE, INS_GPS::P_SIZE));
+        for(unsigned int j(0); j < INS_GPS::P_SIZE; ++j){
+          for(unsigned int i(0); i <= j; ++i){P_(i, j) = P_(j, i) = P[super_t::packed_index(i, j)];}
+        }
+        return P_;
       }
     };
-    typedef std::vector<snapshot_content_t> snapshots_t;
+    typedef INS_GPS_Snapshot_Buffer<snapshot_content_t> snapshots_t;
+    typedef INS_GPS_Snapshot_Buffer<INS_GPS> restored_t;
   protected:
     snapshots_t snapshots;
+    mutable restored_t restored; ///< INS/GPS rebuilt from snapshots for output
   public:
     INS_GPS_Back_Propagate()
-        : INS_GPS(), snapshots() {}
+        : INS_GPS(), snapshots(), restored() {}
     INS_GPS_Back_Propagate(
         const INS_GPS_Back_Propagate &orig,
         const bool &deepcopy = false)
-        : INS_GPS(orig, deepcopy), snapshots(orig.snapshots){}
+        : INS_GPS(orig, deepcopy), snapshots(orig.snapshots), restored() {}
     virtual ~INS_GPS_Back_Propagate(){}
     void setup_back_propagation(const INS_GPS_Back_Propagate_Property<float_t> &property){
       INS_GPS_Back_Propagate_Property<float_t>::operator=(property);
+      // Snapshots covering the depth and the interval of measurement update (<= 2 sec.) are retained.
+      float_t span(2);
+      if(property.back_propagate_depth < 0){span -= property.back_propagate_depth;}
+      if(property.time_update_rate > 0){
+        snapshots.reserve((typename snapshots_t::size_type)(span * property.time_update_rate) + 1);
+      }
     }
     const snapshots_t &get_snapshots() const {return snapshots;}
 
+    /**
+     * Rebuild INS/GPS from the oldest snapshots, which is required only for output.
+     * The rebuilt ones are valid until the next call.
+     *
+     * @param n number of snapshots to be rebuilt
+     * @return (const restored_t &) rebuilt INS/GPS in the same order as snapshots
+     */
+    const restored_t &restore_snapshots(typename snapshots_t::size_type n) const {
+      if(n > snapshots.size()){n = snapshots.size();}
+      restored.clear();
+      restored.reserve(n);
+      for(typename snapshots_t::size_type i(0); i < n; ++i){
+        new (restored.reserve_back()) INS_GPS(*this, true);
+        restored.commit_back();
+        snapshots[i].restore(restored.back());
+      }
+      return restored;
+    }
+
   protected:
     /**
      * Call-back function for time update
@@ -85,19 +407,17 @@ class INS_GPS_Back_Propagate : public INS_GPS, protected INS_GPS_Back_Propagate_
     void before_update_INS(
         const mat_t &A, const mat_t &B,
         const float_t &elapsedT){
-      mat_t Phi(A * elapsedT);
-      for(unsigned i(0); i < A.rows(); i++){Phi(i, i) += 1;}
-      mat_t Gamma(B * elapsedT);
 
       float_t elapsedT_from_last_correct(elapsedT);
       if(!snapshots.empty()){
         elapsedT_from_last_correct += snapshots.back().elapsedT_from_last_correct;
       }
 
-      snapshots.push_back(
-          snapshot_content_t(*this,
-              Phi, Gamma * INS_GPS::getFilter().getQ() * Gamma.transpose(),
-              elapsedT_from_last_correct));
+      snapshot_content_t &snapshot(*(new (snapshots.reserve_back()) snapshot_content_t));
+      snapshot.set(A, B, INS_GPS::getFilter().getQ(), elapsedT);
+      snapshot.save(*this);
+      snapshot.elapsedT_from_last_correct = elapsedT_from_last_correct;
+      snapshots.commit_back();
     }
 
     /**
@@ -123,40 +443,326 @@ class INS_GPS_Back_Propagate : public INS_GPS, protected INS_GPS_Back_Propagate_
         if(mod_elapsedT > 0){
 
           // The latest is the first
-          for(typename snapshots_t::reverse_iterator it(snapshots.rbegin());
-              it != snapshots.rend();
-              ++it){
+          for(typename snapshots_t::size_type i(snapshots.size()); i > 0; --i){
+            snapshot_content_t &snapshot(snapshots[i - 1]);
             // This statement controls depth of back propagation.
-            if(it->elapsedT_from_last_correct
+            if(snapshot.elapsedT_from_last_correct
                 < INS_GPS_Back_Propagate_Property<float_t>::back_propagate_depth){
               if(mod_elapsedT > 0.1){ // Skip only when sufficient amount of snapshots are existed.
-                snapshots.erase(snapshots.begin(), it.base());
+                snapshots.pop_front(i);
                 //cerr << "[erase]" << endl;
                 if(snapshots.empty()){return;}
               }
               break;
             }
             // Positive value stands for states to which applied back-propagation have not been applied
-            it->elapsedT_from_last_correct -= mod_elapsedT;
+            snapshot.elapsedT_from_last_correct -= mod_elapsedT;
           }
         }
 
-        snapshot_content_t previous(snapshots.back());
-        snapshots.pop_back();
+        // Perform back-propagation to the latest snapshot with INS/GPS rebuilt from it
+        snapshot_content_t &previous(snapshots.back());
+        mat_t H_dash(H * previous.getPhi());
+        mat_t R_dash(R + H * previous.getGQGt() * H.transpose());
+        INS_GPS ins_gps(*this, true);
+        previous.restore(ins_gps);
+        ins_gps.correct_primitive(H_dash, v, R_dash);
+        previous.save(ins_gps);
+      }
+    }
+};
 
-        // Perform back-propagation
-        mat_t H_dash(H * previous.Phi);
-        mat_t R_dash(R + H * previous.GQGt * H.transpose());
-        previous.ins_gps.correct_primitive(H_dash, v, R_dash);
+struct INS_GPS_RTS_Smoother_Property {
+  /**
+   * File name to spill the records of the forward pass.
+   * NULL means a temporary file, which is removed automatically.
+   */
+  const char *spill_file;
+  INS_GPS_RTS_Smoother_Property() : spill_file(NULL) {}
+};
 
-        snapshots.push_back(previous);
+/**
+ * Rauch-Tung-Striebel (RTS) fixed-interval smoother over the whole time series.
+ *
+ * In the forward pass, each time update appends a record consisting of
+ * the filtered states @f$ x_{k|k} @f$ and covariance @f$ P_{k|k} @f$,
+ * the transition matrix @f$ \Phi_{k} @f$, and
+ * the predicted states @f$ x_{k+1|k} @f$ and covariance @f$ P_{k+1|k} @f$
+ * to a disk-backed spill file; covariance matrices are packed in upper triangle.
+ * The effects of any measurement update between time updates are included implicitly
+ * as the differences between @f$ x_{k+1|k} @f$ and @f$ x_{k+1|k+1} @f$.
+ * After the forward pass, smooth() performs the backward pass
+ * @f[
+ *    C_{k} = P_{k|k} \Phi_{k}^{T} P_{k+1|k}^{-1}, \quad
+ *    \delta x_{k|N} = C_{k} \left( x_{k+1|k} \ominus x_{k+1|N} \right), \quad
+ *    P_{k|N} = P_{k|k} + C_{k} \left( P_{k+1|N} - P_{k+1|k} \right) C_{k}^{T},
+ * @f]
+ * where @f$ \ominus @f$ is the error between the states in the manner of correct_INS(),
+ * and @f$ x_{k|N} @f$ is obtained by correcting @f$ x_{k|k} @f$ with @f$ \delta x_{k|N} @f$.
+ * The smoothed results overwrite the filtered ones in the file,
+ * and they are restored in chronological order with replay_next();
+ * the filtered ones can be restored in the same manner before smooth().
+ * The file is accessed sequentially in both passes, and the resident memory is bounded
+ * regardless of the length of the time series.
+ *
+ * The layout of the errors is assumed to be that of Filtered_INS2
+ * (velocity, position quaternion, height, attitude quaternion) optionally followed by
+ * additive states such as biases.
+ * Decimated covariance propagation is deactivated, because a record is required for each time update.
+ */
+template <class INS_GPS>
+class INS_GPS_RTS_Smoother : public INS_GPS, protected INS_GPS_RTS_Smoother_Property {
+  public:
+#if defined(__GNUC__) && (__GNUC__ < 5)
+    typedef typename INS_GPS::float_t float_t;
+    typedef typename INS_GPS::vec3_t vec3_t;
+    typedef typename INS_GPS::quat_t quat_t;
+    typedef typename INS_GPS::mat_t mat_t;
+#else
+    using typename INS_GPS::float_t;
+    using typename INS_GPS::vec3_t;
+    using typename INS_GPS::quat_t;
+    using typename INS_GPS::mat_t;
+#endif
+  protected:
+    SpillFile *spill;
+    unsigned int n_x; ///< number of state values
+    unsigned int n_P; ///< size of P
+    float_t *recording; ///< record under the time update
+    float_t m_time_tag;
+    SpillFile::size_type replay_index;
+    bool closed; ///< true when the forward pass is closed
+    bool smoothed;
+
+    unsigned int offset_x_filtered() const {return 1;}
+    unsigned int offset_x_predicted() const {return offset_x_filtered() + n_x;}
+    unsigned int offset_P_filtered() const {return offset_x_predicted() + n_x;}
+    unsigned int offset_P_predicted() const {return offset_P_filtered() + n_P * (n_P + 1) / 2;}
+    unsigned int offset_Phi() const {return offset_P_predicted() + n_P * (n_P + 1) / 2;}
+    unsigned int record_length() const {return offset_Phi() + n_P * n_P;}
+
+    void save_state(float_t *dst) const {
+      for(unsigned int i(0); i < n_x; ++i){
+        dst[i] = static_cast<const INS_GPS &>(*this)[i];
+      }
+    }
+    void load_state(const float_t *src){
+      for(unsigned int i(0); i < n_x; ++i){
+        static_cast<INS_GPS &>(*this)[i] = src[i];
+      }
+      INS_GPS::recalc();
+    }
+    void save_P(float_t *dst, const mat_t &P) const {
+      for(unsigned int j(0); j < n_P; ++j){
+        for(unsigned int i(0); i <= j; ++i){*(dst++) = P(i, j);}
+      }
+    }
+    void save_P(float_t *dst){
+      for(unsigned int j(0); j < n_P; ++j){
+        for(unsigned int i(0); i <= j; ++i){*(dst++) = INS_GPS::getFilter().getP(i, j);}
       }
     }
+    mat_t load_P(const float_t *src) const {
+      mat_t P(mat_t::blank(n_P, n_P));
+      for(unsigned int j(0); j < n_P; ++j){
+        for(unsigned int i(0); i <= j; ++i){P(i, j) = P(j, i) = *(src++);}
+      }
+      return P;
+    }
+
+    /**
+     * Store the error between quaternions, which corresponds to the one
+     * applied as (1, -e) * q_a by correct_INS().
+     */
+    static void quaternion_error(
+        mat_t &e, const unsigned int &i, const float_t *q_a, const float_t *q_b){
+      quat_t qa(q_a[0], q_a[1], q_a[2], q_a[3]);
+      quat_t qb(q_b[0], q_b[1], q_b[2], q_b[3]);
+      quat_t r(qb * qa.conj()); // q_b = r * q_a = (1, -e) * q_a
+      for(unsigned int k(0); k < 3; ++k){
+        e(i + k, 0) = -r.vector()[k] / r.scalar();
+      }
+    }
+
+    /**
+     * Calculate the error between the states in the layout of P,
+     * which satisfies that applying correct_INS() with the error to x_a results in x_b.
+     *
+     * @param x_a reference states
+     * @param x_b target states
+     * @return (mat_t) error, column vector
+     */
+    mat_t state_error(const float_t *x_a, const float_t *x_b) const {
+      mat_t e(n_P, 1);
+      for(unsigned int i(0); i < 3; ++i){e(i, 0) = x_a[i] - x_b[i];} // velocity
+      quaternion_error(e, 3, &x_a[3], &x_b[3]); // position, x[3..6] => P[3..5]
+      e(6, 0) = x_a[7] - x_b[7]; // height
+      quaternion_error(e, 7, &x_a[8], &x_b[8]); // attitude, x[8..11] => P[7..9]
+      for(unsigned int i(10), j(12); i < n_P; ++i, ++j){e(i, 0) = x_a[j] - x_b[j];}
+      return e;
+    }
+
+  public:
+    INS_GPS_RTS_Smoother()
+        : INS_GPS(), INS_GPS_RTS_Smoother_Property(),
+        spill(NULL), n_x(0), n_P(0), recording(NULL),
+        m_time_tag(0), replay_index(0), closed(false), smoothed(false) {}
+    /**
+     * Copy constructor.
+     * The spill file is not shared, and the copy does not record anything.
+     */
+    INS_GPS_RTS_Smoother(
+        const INS_GPS_RTS_Smoother &orig,
+        const bool &deepcopy = false)
+        : INS_GPS(orig, deepcopy), INS_GPS_RTS_Smoother_Property(orig),
+        spill(NULL), n_x(orig.n_x), n_P(orig.n_P), recording(NULL),
+        m_time_tag(orig.m_time_tag), replay_index(0), closed(false), smoothed(false) {}
+    virtual ~INS_GPS_RTS_Smoother(){
+      delete spill;
+    }
+    void setup_rts_smoothing(const INS_GPS_RTS_Smoother_Property &property){
+      INS_GPS_RTS_Smoother_Property::operator=(property);
+      INS_GPS::set_predict_decimation(1);
+      n_x = INS_GPS::state_values();
+      n_P = INS_GPS::P_SIZE;
+      delete spill;
+      spill = new SpillFile(sizeof(float_t) * record_length(), spill_file);
+      closed = smoothed = false;
+    }
+
+    /**
+     * Set the time tag of the current states, which is increased by time update.
+     *
+     * @param t time tag
+     */
+    void set_time_tag(const float_t &t){m_time_tag = t;}
+    const float_t &time_tag() const {return m_time_tag;}
+
+    /**
+     * @return (SpillFile::size_type) number of records
+     */
+    SpillFile::size_type records() const {return spill ? spill->size() : 0;}
+
+    void update(const vec3_t &accel, const vec3_t &gyro, const float_t &deltaT){
+      if((!spill) || closed){
+        INS_GPS::update(accel, gyro, deltaT);
+        return;
+      }
+      recording = static_cast<float_t *>(spill->append());
+      recording[0] = m_time_tag;
+      save_state(recording + offset_x_filtered());
+      save_P(recording + offset_P_filtered());
+      INS_GPS::update(accel, gyro, deltaT); // Phi is saved in before_update_INS()
+      save_state(recording + offset_x_predicted());
+      save_P(recording + offset_P_predicted());
+      recording = NULL;
+      m_time_tag += deltaT;
+    }
+
+  protected:
+    void before_update_INS(
+        const mat_t &A, const mat_t &B,
+        const float_t &elapsedT){
+      if(recording){
+        float_t *Phi(recording + offset_Phi());
+        for(unsigned int i(0); i < n_P; ++i){
+          for(unsigned int j(0); j < n_P; ++j){
+            *(Phi++) = A(i, j) * elapsedT + ((i == j) ? 1 : 0);
+          }
+        }
+      }
+      INS_GPS::before_update_INS(A, B, elapsedT);
+    }
+
+    /**
+     * Close the forward pass by appending the terminal record, which holds the current states.
+     * After that, time update is not recorded anymore.
+     */
+    void close_forward(){
+      if((!spill) || closed){return;}
+      closed = true;
+      float_t *terminal(static_cast<float_t *>(spill->append()));
+      terminal[0] = m_time_tag;
+      save_state(terminal + offset_x_filtered());
+      save_P(terminal + offset_P_filtered());
+    }
+
+  public:
+    /**
+     * Perform the backward pass.
+     * The forward pass is closed in advance if it has not been closed.
+     */
+    void smooth(){
+      close_forward();
+      if((!spill) || smoothed){return;}
+      smoothed = true;
+
+      // At the terminal, the filtered is the smoothed.
+      SpillFile::size_type k(spill->size() - 1);
+
+      std::vector<float_t> x_smoothed(n_x);
+      mat_t P_smoothed;
+      {
+        const float_t *rec(static_cast<const float_t *>((*spill)[k]));
+        std::copy(rec + offset_x_filtered(), rec + offset_x_filtered() + n_x, x_smoothed.begin());
+        P_smoothed = load_P(rec + offset_P_filtered());
+      }
+
+      while(k-- > 0){
+        float_t *rec(static_cast<float_t *>((*spill)[k]));
+        mat_t P_filtered(load_P(rec + offset_P_filtered()));
+        mat_t P_predicted(load_P(rec + offset_P_predicted()));
+        mat_t Phi(n_P, n_P, rec + offset_Phi());
+
+        mat_t C(P_filtered * Phi.transpose() * P_predicted.inverse());
+        mat_t x_hat(C * state_error(rec + offset_x_predicted(), &x_smoothed[0]));
+        P_smoothed = P_filtered + C * (P_smoothed - P_predicted) * C.transpose();
+
+        load_state(rec + offset_x_filtered());
+        INS_GPS::correct_INS(x_hat);
+        save_state(rec + offset_x_filtered());
+        save_P(rec + offset_P_filtered(), P_smoothed);
+        std::copy(rec + offset_x_filtered(), rec + offset_x_filtered() + n_x, x_smoothed.begin());
+      }
+    }
+
+    /**
+     * Rewind the position of replay_next().
+     * The forward pass is closed in advance if it has not been closed.
+     */
+    void replay_begin(){
+      close_forward();
+      replay_index = 0;
+    }
+
+    /**
+     * Restore the states and covariance of the next record, which are smoothed after smooth().
+     * The time tag is restored too.
+     *
+     * @return (bool) true when restored, otherwise false (end of records)
+     */
+    bool replay_next(){
+      if((!spill) || (replay_index >= spill->size())){return false;}
+      const float_t *rec(static_cast<const float_t *>((*spill)[replay_index++]));
+      m_time_tag = rec[0];
+      load_state(rec + offset_x_filtered());
+      INS_GPS::getFilter().setP(load_P(rec + offset_P_filtered()));
+      return true;
+    }
 };
 
 struct INS_GPS_RealTime_Property {
   enum rt_mode_t {RT_NORMAL, RT_LIGHT_WEIGHT} rt_mode; ///< Algorithm selection for realtime mode
-  INS_GPS_RealTime_Property() : rt_mode(RT_NORMAL) {}
+  double max_delay; ///< Maximum delay of GPS information to be compensated [s]
+  double time_update_rate; ///< Expected rate of time update [Hz]
+  INS_GPS_RealTime_Property() : rt_mode(RT_NORMAL), max_delay(2), time_update_rate(100) {}
+  /**
+   * @return (unsigned int) capacity of the snapshot pool, which covers max_delay
+   */
+  unsigned int snapshot_capacity() const {
+    double n(max_delay * time_update_rate);
+    return (n > 0 ? (unsigned int)n : 0) + 2;
+  }
 };
 
 template <class INS_GPS>
@@ -172,35 +778,26 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
     using typename INS_GPS::mat_t;
 #endif
   protected:
-    struct snapshot_content_t {
-      INS_GPS ins_gps;
-      mat_t A;
-      mat_t Phi_inv;
-      mat_t GQGt;
-      float_t elapsedT_from_last_update;
-      snapshot_content_t(
-          const INS_GPS &_ins_gps,
-          const mat_t &_A,
-          const mat_t &_Phi_inv,
-          const mat_t &_GQGt,
-          const float_t &_elapsedT)
-          : ins_gps(_ins_gps, true),
-          A(_A), Phi_inv(_Phi_inv), GQGt(_GQGt),
-          elapsedT_from_last_update(_elapsedT){
-      }
+    struct snapshot_content_t : public INS_GPS_Snapshot_Record<INS_GPS> {
+      float_t t; ///< time of the states relative to an arbitrary origin
     };
-    typedef std::vector<snapshot_content_t> snapshots_t;
-    snapshots_t snapshots;
+    typedef INS_GPS_Snapshot_Buffer<snapshot_content_t> snapshots_t;
+    snapshots_t snapshots; ///< fixed-capacity pool, where the oldest is overwritten when full
+    float_t elapsedT; ///< time of the current states relative to the origin of snapshot_content_t::t
   public:
     INS_GPS_RealTime()
-        : INS_GPS(), snapshots() {}
+        : INS_GPS(), INS_GPS_RealTime_Property(), snapshots(), elapsedT(0) {
+      snapshots.set_capacity(snapshot_capacity());
+    }
     INS_GPS_RealTime(
         const INS_GPS_RealTime &orig,
         const bool &deepcopy = false)
-        : INS_GPS(orig, deepcopy), snapshots(orig.snapshots){}
+        : INS_GPS(orig, deepcopy), INS_GPS_RealTime_Property(orig),
+        snapshots(orig.snapshots), elapsedT(orig.elapsedT){}
     virtual ~INS_GPS_RealTime(){}
     void setup_realtime(const INS_GPS_RealTime_Property &property){
       INS_GPS_RealTime_Property::operator=(property);
+      snapshots.set_capacity(snapshot_capacity()); // preallocate
     }
 
   protected:
@@ -214,14 +811,36 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
     void before_update_INS(
         const mat_t &A, const mat_t &B,
         const float_t &elapsedT){
-      mat_t Phi(A * elapsedT);
-      for(unsigned i(0); i < A.rows(); i++){Phi(i, i) += 1;}
-      mat_t Gamma(B * elapsedT);
+      // Without reallocation, the oldest is dropped when the pool is full.
+      if(snapshots.size() >= snapshots.capacity()){snapshots.pop_front();}
+      snapshot_content_t &snapshot(*(new (snapshots.reserve_back()) snapshot_content_t));
+      snapshot.set(A, B, INS_GPS::getFilter().getQ(), elapsedT);
+      snapshot.save(*this);
+      snapshot.t = this->elapsedT;
+      snapshots.commit_back();
+      this->elapsedT += elapsedT;
+    }
 
-      snapshots.push_back(
-          snapshot_content_t(*this,
-              A, Phi.inverse(), Gamma * INS_GPS::getFilter().getQ() * Gamma.transpose(),
-              elapsedT));
+    /**
+     * Find the latest snapshot whose time is less than the specified time.
+     * Because snapshots are sorted and almost evenly spaced in time,
+     * the index is estimated by interpolation at first, and then adjusted locally,
+     * which results in O(1) in usual.
+     *
+     * @param t time
+     * @return (int) index of the snapshot, or -1 when all snapshots are newer.
+     */
+    int find_snapshot(const float_t &t) const {
+      if(snapshots.empty() || (snapshots.front().t >= t)){return -1;}
+      int last(snapshots.size() - 1);
+      if(snapshots.back().t < t){return last;}
+      // Here, front().t < t <= back().t, and therefore 0 <= index < last
+      int index((int)(last * (t - snapshots.front().t)
+          / (snapshots.back().t - snapshots.front().t)));
+      if(index >= last){index = last - 1;}
+      while(snapshots[index].t >= t){--index;}
+      while(snapshots[index + 1].t < t){++index;}
+      return index;
     }
 
   public:
@@ -235,21 +854,14 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
     bool setup_correct(float_t advanceT){
       if(advanceT > 0){return false;} // positive value (future) is odd
 
-      for(typename snapshots_t::reverse_iterator it(snapshots.rbegin());
-          it != snapshots.rend();
-          ++it){
-        advanceT += it->elapsedT_from_last_update;
-        if(advanceT > -0.005){ // Find the closest
-          if(it == snapshots.rbegin()){
-            // Keep at least one snapshot
-            it++;
-          }
-          snapshots.erase(snapshots.begin(), it.base());
-          return true;
-        }
-      }
+      // Find the closest
+      int index(find_snapshot(elapsedT + advanceT + 0.005));
+      if(index < 0){return false;} // Too old
 
-      return false; // Too old
+      // Keep at least one snapshot
+      if(index == (int)snapshots.size() - 1){index--;}
+      snapshots.pop_front(index + 1);
+      return true;
     }
 
   protected:
@@ -269,9 +881,9 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
             for(typename snapshots_t::iterator it(snapshots.begin());
                 it != snapshots.end();
                 ++it){
-              sum_A += it->A;
-              sum_GQGt += it->GQGt;
-              bar_delteT += it->elapsedT_from_last_update;
+              sum_A += it->getA();
+              sum_GQGt += it->getGQGt();
+              bar_delteT += it->elapsedT;
             }
             int n(snapshots.size());
             bar_delteT /= n;
@@ -287,8 +899,8 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
           for(typename snapshots_t::iterator it(snapshots.begin());
               it != snapshots.end();
               ++it){
-            H *= it->Phi_inv;
-            R += H * it->GQGt * H.transpose();
+            H *= it->getPhi().inverse(); // only when correction is performed
+            R += H * it->getGQGt() * H.transpose();
           }
       }
       INS_GPS::correct_primitive(info);
@@ -297,7 +909,9 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
   public:
     template <class GPS_Packet>
     void correct(const GPS_Packet &gps){
-      CorrectInfo<float_t> info(snapshots[0].ins_gps.correct_info(gps));
+      INS_GPS ins_gps(*this, true); // rebuilt from the snapshot, whose states are only required
+      snapshots[0].restore(ins_gps);
+      CorrectInfo<float_t> info(ins_gps.correct_info(gps));
       correct_with_info(info);
     }
 
@@ -305,7 +919,9 @@ class INS_GPS_RealTime : public INS_GPS, protected INS_GPS_RealTime_Property {
     void correct(const GPS_Packet &gps,
         const vec3_t &lever_arm_b,
         const vec3_t &omega_b2i_4b){
-      CorrectInfo<float_t> info(snapshots[0].ins_gps.correct_info(gps, lever_arm_b, omega_b2i_4b));
+      INS_GPS ins_gps(*this, true);
+      snapshots[0].restore(ins_gps);
+      CorrectInfo<float_t> info(ins_gps.correct_info(gps, lever_arm_b, omega_b2i_4b));
       correct_with_info(info);
     }
 };
@@ -131,66 +131,92 @@ class MagneticFieldGeneric {
 
     struct field_components_res_t {FloatT north, east, down;};
   protected:
+    /**
+     * Terms depending on geocentric latitude, i.e., Schmidt semi-normalized
+     * associated Legendre functions (p) and their derivatives (q),
+     * which can be shared among points having the same latitude and height.
+     */
+    struct latitude_terms_t {
+      FloatT slat, clat;
+      FloatT p[118], q[118];
+      void update(const int &dof,
+          const FloatT &sin_geocentric_latitude, const FloatT &cos_geocentric_latitude){
+        using std::sqrt;
+        slat = sin_geocentric_latitude;
+        clat = cos_geocentric_latitude;
+        FloatT aa(sqrt(3.0)), bb, cc;
+        p[0] = 2.0 * slat;
+        p[1] = 2.0 * clat;
+        p[2] = 4.5 * slat * slat - 1.5;
+        p[3] = 3.0 * aa * clat * slat;
+        q[0] = -clat;
+        q[1] = slat;
+        q[2] = -3.0 * clat * slat;
+        q[3] = aa * (slat * slat - clat * clat);
+        for(int k(0), m(0), n(-1); k < ((dof * (dof + 3)) / 2); k++, m++){
+          if(m > n){
+            m = -1;
+            n++;
+          }
+          if(k <= 3){continue;}
+          FloatT fm(m + 1), fn(n + 1);
+          if (m == n){
+            aa = sqrt(1.0 - 0.5 / fm);
+            int j(k - n - 2);
+            p[k] = (1.0 + 1.0 / fm) * aa * clat * p[j];
+            q[k] = aa * (clat * q[j] + slat/fm * p[j]);
+          }else{
+            aa = sqrt(fn * fn - fm * fm);
+            bb = sqrt(((fn - 1.0) * (fn - 1.0)) - (fm * fm)) / aa;
+            cc = (2.0 * fn - 1.0) / aa;
+            int i(k - n - 1), j(k - 2 * n - 1);
+            p[k] = (fn + 1.0) * (cc * slat / fn * p[i] - bb / (fn - 1.0) * p[j]);
+            q[k] = cc * (slat * q[i] - clat / fn * p[i]) - bb * q[j];
+          }
+        }
+      }
+    };
+
+    /**
+     * Terms depending on longitude, i.e., sin((m + 1) * lng) and cos((m + 1) * lng),
+     * which can be shared among points having the same longitude.
+     */
+    struct longitude_terms_t {
+      FloatT sl[13], cl[13];
+      void update(const int &dof, const FloatT &longitude_rad){
+        sl[0] = std::sin(longitude_rad);
+        cl[0] = std::cos(longitude_rad);
+        for(int m(1); m < dof; ++m){
+          sl[m] = sl[m-1] * cl[0] + cl[m-1] * sl[0];
+          cl[m] = cl[m-1] * cl[0] - sl[m-1] * sl[0];
+        }
+      }
+    };
+
     static field_components_res_t field_components_geocentric(
         const model_t &model,
-        const FloatT &sin_geocentric_latitude, const FloatT &cos_geocentric_latitude,
-        const FloatT &longitude_rad,
+        const latitude_terms_t &lat, const longitude_terms_t &lng,
         const FloatT &radius_meter){
-      using std::cos;
-      using std::sin;
-      using std::pow;
-      using std::sqrt;
       field_components_res_t res;
       
       // @see http://mooring.ucsd.edu/software/matlab/mfiles/toolbox/geo/IGRF/geomag60.c
 
-      const FloatT slat(sin_geocentric_latitude);
-      const FloatT clat(cos_geocentric_latitude);
-
-      FloatT sl[13] = {sin(longitude_rad)};
-      FloatT cl[13] = {cos(longitude_rad)};
+      const FloatT &slat(lat.slat), &clat(lat.clat);
+      const FloatT *p(lat.p), *q(lat.q), *sl(lng.sl), *cl(lng.cl);
       
       res.north = res.east = res.down = 0;
-      
-      FloatT aa, bb, cc, rr;
-      
-      aa = sqrt(3.0);
-      FloatT p[118] = {
-          2.0 * slat,
-          2.0 * clat,
-          4.5 * slat * slat - 1.5,
-          3.0 * aa * clat * slat};
-      FloatT q[118] = {
-          -clat,
-          slat,
-          -3.0 * clat * slat,
-          aa * (slat * slat - clat * clat)};
+
+      static const FloatT earths_radius(6371.2E3);
+      const FloatT ratio(earths_radius / radius_meter);
+      FloatT aa, bb, cc, rr(ratio * ratio);
       
       for(int k(0), l(0), m(0), n(-1); k < ((model.dof * (model.dof + 3)) / 2); k++, m++){
         if(m > n){
           m = -1;
           n++;
-          static const FloatT earths_radius(6371.2E3);
-          rr = pow(earths_radius / radius_meter, n + 3);
+          rr *= ratio; // = pow(earths_radius / radius_meter, n + 3)
         }
         FloatT fm(m + 1), fn(n + 1);
-        if (k > 3){
-          if (m == n){
-            aa = sqrt(1.0 - 0.5 / fm);
-            int j(k - n - 2);
-            p[k] = (1.0 + 1.0 / fm) * aa * clat * p[j];
-            q[k] = aa * (clat * q[j] + slat/fm * p[j]);
-            sl[m] = sl[m-1] * cl[0] + cl[m-1] * sl[0];
-            cl[m] = cl[m-1] * cl[0] - sl[m-1] * sl[0];
-          }else{
-            aa = sqrt(fn * fn - fm * fm);
-            bb = sqrt(((fn - 1.0) * (fn - 1.0)) - (fm * fm)) / aa;
-            cc = (2.0 * fn - 1.0) / aa;
-            int i(k - n - 1), j(k - 2 * n - 1);
-            p[k] = (fn + 1.0) * (cc * slat / fn * p[i] - bb / (fn - 1.0) * p[j]);
-            q[k] = cc * (slat * q[i] - clat / fn * p[i]) - bb * q[j];
-          }
-        }
         aa = rr * model.coef[l];
         
         if(m < 0){
@@ -214,6 +240,73 @@ class MagneticFieldGeneric {
       return res;
     }
 
+    static field_components_res_t field_components_geocentric(
+        const model_t &model,
+        const FloatT &sin_geocentric_latitude, const FloatT &cos_geocentric_latitude,
+        const FloatT &longitude_rad,
+        const FloatT &radius_meter){
+      latitude_terms_t lat;
+      lat.update(model.dof, sin_geocentric_latitude, cos_geocentric_latitude);
+      longitude_terms_t lng;
+      lng.update(model.dof, longitude_rad);
+      return field_components_geocentric(model, lat, lng, radius_meter);
+    }
+
+    /**
+     * Geocentric position corresponding to geodetic latitude and height
+     */
+    struct geocentric_t {
+      FloatT slat, clat; ///< sine and cosine of geocentric latitude
+      FloatT radius; ///< geocentric radius [m]
+      FloatT sd, cd; ///< sine and cosine of the angle between geodetic and geocentric latitudes
+      geocentric_t() {}
+      geocentric_t(const FloatT &latitude_rad, const FloatT &height_meter){
+        update(latitude_rad, height_meter);
+      }
+      void update(const FloatT &latitude_rad, const FloatT &height_meter){
+        using std::cos;
+        using std::sin;
+        using std::sqrt;
+
+        FloatT slat_d(sin(latitude_rad)), clat_d(cos(latitude_rad));
+
+        {
+          // Correction of latitude
+          FloatT latitude_deg(latitude_rad / M_PI * 180);
+          if((90.0 - latitude_deg) < 1E-3){
+            clat_d = cos((90.0 - 1E-3) / 180 * M_PI); // 300 ft. from North pole
+          }else if((90.0 + latitude_deg) < 1E-3){
+            clat_d = cos((-90.0 + 1E-3) / 180 * M_PI); // 300 ft. from South pole
+          }
+        }
+
+        {
+          // Convert geographic lat/lng(nܓxox) to geocentric lat/lng(nSܓxox)
+          FloatT aa, bb, cc, dd;
+          static const FloatT a2(40680631.59E6);            /* WGS84, a*a (m^2) */
+          static const FloatT b2(40408299.98E6);            /* WGS84, b*b (m^2) */
+          aa = a2 * clat_d * clat_d;
+          bb = b2 * slat_d * slat_d;
+          cc = aa + bb;
+          dd = sqrt(cc);
+          radius = sqrt(height_meter * (height_meter + 2.0 * dd) + (a2 * aa + b2 * bb) / cc);
+          cd = (height_meter + dd) / radius;
+          sd = (a2 - b2) / dd * slat_d * clat_d / radius;
+        }
+
+        slat = slat_d * cd - clat_d * sd;
+        clat = clat_d * cd + slat_d * sd;
+      }
+      /**
+       * Transform field components from geocentric to geodetic frame
+       */
+      void transform(field_components_res_t &res) const {
+        FloatT _north(res.north);
+        res.north = _north * cd + res.down * sd;
+        res.down = res.down * cd - _north * sd;
+      }
+    };
+
   public:
     static field_components_res_t field_components_geocentric(
         const model_t &model,
@@ -231,52 +324,82 @@ class MagneticFieldGeneric {
         const model_t &model,
         const FloatT &latitude_rad, const FloatT &longitude_rad,
         const FloatT &height_meter){
-      using std::cos;
-      using std::sin;
-      using std::pow;
-      using std::sqrt;
-
-      FloatT slat(sin(latitude_rad)), clat(cos(latitude_rad));
-      FloatT sd, cd, r;
-
-      {
-        // Correction of latitude
-        FloatT latitude_deg(latitude_rad / M_PI * 180);
-        if((90.0 - latitude_deg) < 1E-3){
-          clat = cos((90.0 - 1E-3) / 180 * M_PI); // 300 ft. from North pole
-        }else if((90.0 + latitude_deg) < 1E-3){
-          clat = cos((-90.0 + 1E-3) / 180 * M_PI); // 300 ft. from South pole
-        }
-      }
 
-      {
-        // Convert geographic lat/lng(nܓxox) to geocentric lat/lng(nSܓxox)
-        FloatT aa, bb, cc, dd;
-        static const FloatT a2(40680631.59E6);            /* WGS84, a*a (m^2) */
-        static const FloatT b2(40408299.98E6);            /* WGS84, b*b (m^2) */
-        aa = a2 * clat * clat;
-        bb = b2 * slat * slat;
-        cc = aa + bb;
-        dd = sqrt(cc);
-        r = sqrt(height_meter * (height_meter + 2.0 * dd) + (a2 * aa + b2 * bb) / cc);
-        cd = (height_meter + dd) / r;
-        sd = (a2 - b2) / dd * slat * clat / r;
-      }
+      geocentric_t pos(latitude_rad, height_meter);
 
       field_components_res_t res(field_components_geocentric(
           model,
-          slat * cd - clat * sd, clat * cd + slat * sd,
-          longitude_rad, r));
+          pos.slat, pos.clat,
+          longitude_rad, pos.radius));
 
-      { // coordinate transform
-        FloatT _north(res.north);
-        res.north = _north * cd + res.down * sd;
-        res.down = res.down * cd - _north * sd;
-      }
+      pos.transform(res); // coordinate transform
 
       return res;
     }
 
+#if !defined(SWIG)
+  protected:
+    static void field_components_range(
+        const model_t &model,
+        const FloatT latitude_rad[], const FloatT longitude_rad[], const FloatT height_meter[],
+        const int &begin, const int &end,
+        FloatT north[], FloatT east[], FloatT down[]){
+      latitude_terms_t lat;
+      longitude_terms_t lng;
+      geocentric_t pos;
+      for(int i(begin); i < end; ++i){
+        if((i == begin)
+            || (latitude_rad[i] != latitude_rad[i - 1])
+            || (height_meter[i] != height_meter[i - 1])){
+          pos.update(latitude_rad[i], height_meter[i]);
+          lat.update(model.dof, pos.slat, pos.clat);
+        }
+        if((i == begin) || (longitude_rad[i] != longitude_rad[i - 1])){
+          lng.update(model.dof, longitude_rad[i]);
+        }
+        field_components_res_t res(field_components_geocentric(model, lat, lng, pos.radius));
+        pos.transform(res);
+        north[i] = res.north;
+        east[i] = res.east;
+        down[i] = res.down;
+      }
+    }
+
+  public:
+    /**
+     * Batch version of field_components() for arrays of positions (structure of arrays).
+     * Latitude dependent terms are reused among consecutive points having
+     * the same latitude and height, and longitude dependent terms are reused
+     * among those having the same longitude. Therefore, points of a map
+     * should be ordered by rows or columns.
+     * The points are split into contiguous ranges, each of which is processed
+     * by a thread when compiled with OpenMP; otherwise, they are processed sequentially.
+     *
+     * @param n number of points
+     * @param north (output) north components [nT]
+     * @param east (output) east components [nT]
+     * @param down (output) down components [nT]
+     * @param threads number of threads
+     */
+    static void field_components(
+        const model_t &model,
+        const FloatT latitude_rad[], const FloatT longitude_rad[], const FloatT height_meter[],
+        const int &n,
+        FloatT north[], FloatT east[], FloatT down[],
+        const int &threads = 1){
+      const int ranges((threads > 1) ? ((threads < n) ? threads : n) : 1);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(ranges) schedule(static, 1)
+#endif
+      for(int j = 0; j < ranges; ++j){
+        field_components_range(model,
+            latitude_rad, longitude_rad, height_meter,
+            (int)((long long)n * j / ranges), (int)((long long)n * (j + 1) / ranges),
+            north, east, down);
+      }
+    }
+#endif
+
     struct latlng_t {
       FloatT latitude, longitude;
     };
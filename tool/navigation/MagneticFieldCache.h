@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __MAGNETIC_FIELD_CACHE_H__
+#define __MAGNETIC_FIELD_CACHE_H__
+
+#include <cmath>
+
+#include "MagneticField.h"
+#include "GeodeticGrid.h"
+
+/**
+ * @brief Magnetic field evaluated with a model at a fixed epoch, and cached in a lookup grid
+ *
+ * The model coefficients at the epoch, which are interpolated (or extrapolated)
+ * between the tabulated model years, are computed once when the epoch is set.
+ * The field components are then interpolated with GeodeticGrid,
+ * whose tiles are checked against the direct evaluation with the tolerance.
+ *
+ * @param FloatT precision
+ * @param Model model set, for example, IGRF12Generic
+ */
+template <class FloatT, template <class> class Model = IGRF12Generic>
+class MagneticFieldCacheGeneric {
+  public:
+    typedef FloatT float_t;
+    typedef MagneticFieldGeneric<float_t> field_t;
+    typedef typename field_t::model_t model_t;
+    typedef typename field_t::field_components_res_t field_components_res_t;
+
+    struct evaluator_t {
+      model_t model;
+      void operator()(
+          const float_t &phi, const float_t &lambda, const float_t &h,
+          float_t (&res)[3]) const {
+        field_components_res_t v(field_t::field_components(model, phi, lambda, h));
+        res[0] = v.north;
+        res[1] = v.east;
+        res[2] = v.down;
+      }
+    };
+    typedef GeodeticGrid<float_t, evaluator_t> grid_t;
+    typedef typename grid_t::property_t property_t;
+
+    /**
+     * Default property, whose tolerance is 1 [nT];
+     * cells are 0.25 [deg] in latitude and longitude, and 1000 [m] in height.
+     */
+    static property_t default_property(){
+      return property_t(0.25, 1000, 8, 4, 1, 89);
+    }
+
+  protected:
+    grid_t grid;
+
+    static evaluator_t make_evaluator(const float_t &year){
+      evaluator_t res = {Model<float_t>::get_model(year)};
+      return res;
+    }
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param year epoch in decimal year
+     * @param prop property of the lookup grid
+     */
+    MagneticFieldCacheGeneric(
+        const float_t &year,
+        const property_t &prop = default_property())
+        : grid(make_evaluator(year), prop) {}
+
+    const model_t &model() const {return grid.get_evaluator().model;}
+    float_t year() const {return model().year;}
+    /**
+     * Change the epoch, which discards the cached tiles.
+     *
+     * @param year epoch in decimal year
+     */
+    void set_year(const float_t &year){
+      grid.set_evaluator(make_evaluator(year));
+    }
+    grid_t &get_grid() {return grid;}
+    const grid_t &get_grid() const {return grid;}
+
+    /**
+     * Convert GPS time to decimal year, which is used as the epoch.
+     *
+     * @param week GPS week number (not truncated)
+     * @param itow time of week [s]
+     */
+    static float_t gps2year(const int &week, const float_t &itow){
+      // GPS time zero, 1980/1/6, is the 5th day of a leap year.
+      float_t days(7. * week + itow / (60 * 60 * 24) + 5);
+      int year(1980);
+      while(true){
+        int days_of_year(((year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0))) ? 366 : 365);
+        if(days < days_of_year){return days / days_of_year + year;}
+        days -= days_of_year;
+        ++year;
+      }
+    }
+
+    /**
+     * Return magnetic field components.
+     *
+     * @param latitude_rad latitude [rad]
+     * @param longitude_rad longitude [rad]
+     * @param height_meter height [m]
+     * @return (field_components_res_t) north, east, and down components [nT]
+     */
+    field_components_res_t field_components(
+        const float_t &latitude_rad, const float_t &longitude_rad,
+        const float_t &height_meter){
+      float_t v[3];
+      grid.get(latitude_rad, longitude_rad, height_meter, v);
+      field_components_res_t res = {v[0], v[1], v[2]};
+      return res;
+    }
+};
+
+typedef MagneticFieldCacheGeneric<double> MagneticFieldCache;
+
+#endif /* __MAGNETIC_FIELD_CACHE_H__ */
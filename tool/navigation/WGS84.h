@@ -77,8 +77,17 @@ class WGS84Generic{
      * @return (FloatT) radius k̋ɗa[m]
      */
     static FloatT R_meridian(const FloatT &latitude){
+      return R_meridian_sin(std::sin(latitude));
+    }
+    /**
+     * Calculate curvature radius (north-south) with sine of latitude
+     *
+     * @param sin_latitude sine of (geodetic) latitude
+     * @return (FloatT) radius [m]
+     */
+    static FloatT R_meridian_sin(const FloatT &sin_latitude){
       return R_e * (1. - pow2(epsilon_Earth))
-                  / std::pow((1. - pow2(epsilon_Earth) * pow2(std::sin(latitude))), 1.5);
+                  / std::pow((1. - pow2(epsilon_Earth) * pow2(sin_latitude)), 1.5);
     }
     
     /**
@@ -89,7 +98,16 @@ class WGS84Generic{
      * @return (FloatT) radius ̋ɗa[m]
      */
     static FloatT R_normal(const FloatT &latitude){
-      return R_e / std::sqrt(1. - pow2(epsilon_Earth) * pow2(std::sin(latitude)));  
+      return R_normal_sin(std::sin(latitude));
+    }
+    /**
+     * Calculate curvature radius (east-west) with sine of latitude
+     *
+     * @param sin_latitude sine of (geodetic) latitude
+     * @return (FloatT) radius [m]
+     */
+    static FloatT R_normal_sin(const FloatT &sin_latitude){
+      return R_e / std::sqrt(1. - pow2(epsilon_Earth) * pow2(sin_latitude));
     }
     
     /**
@@ -101,16 +119,23 @@ class WGS84Generic{
      * @return gravity d[m/s^2]
      */
     static FloatT gravity(const FloatT &latitude, const FloatT &altitude = 0){
-      FloatT slat2(pow2(std::sin(latitude)));
+      return gravity_sin(std::sin(latitude), altitude);
+    }
+    /**
+     * Calculate gravity with sine of latitude
+     *
+     * @param sin_latitude sine of (geodetic) latitude
+     * @param altitude altitude [m]
+     * @return gravity [m/s^2]
+     */
+    static FloatT gravity_sin(const FloatT &sin_latitude, const FloatT &altitude = 0){
+      FloatT slat2(pow2(sin_latitude));
       FloatT g0(g_WGS0 * (1. + g_WGS1 * slat2) / std::sqrt(1. - pow2(epsilon_Earth) * slat2));
-      if(altitude == 0){
-        return g0;
-      }else{
-        // @see Eq. (4-3)
-        return g0 * (1.0 \
-            - (2.0 / R_e * (1.0 + F_e + m_derived - 2.0 * F_e * slat2) * altitude) \
-            + (3.0 / pow2(R_e) * pow2(altitude)));
-      }
+      // @see Eq. (4-3), which is exactly g0 when altitude == 0;
+      // no branch is placed so that loops calling this can be vectorized.
+      return g0 * (1.0 \
+          - (2.0 / R_e * (1.0 + F_e + m_derived - 2.0 * F_e * slat2) * altitude) \
+          + (3.0 / pow2(R_e) * pow2(altitude)));
     }
 
     struct xz_t {
@@ -52,12 +52,15 @@
 
 #include <string>
 #include <exception>
+#include <new>
 
+#include <cstddef>
 #include <cstring>
 #include <cmath>
 #include <cfloat>
 #include <ostream>
 #include "param/complex.h"
+#include "param/matrix_kernel.h"
 
 #if (__cplusplus < 201103L) && !defined(noexcept)
 #define noexcept throw()
@@ -183,10 +186,177 @@ class Array2D{
     virtual root_t *copy(const bool &is_deep = false) const = 0;
 };
 
+/**
+ * @brief Thread-local size-class memory pool for matrix storage
+ *
+ * Blocks are classified by their byte sizes rounded up to the power of 2,
+ * and a released block is kept in the free list of the releasing thread
+ * in order to be reused by a following allocation of the same class.
+ * Heap operations are therefore mostly eliminated
+ * when identically-sized matrices are repeatedly generated and destroyed,
+ * for example, in the time and measurement updates of Kalman filter.
+ *
+ * The pool is active when the compiler supports thread_local (C++11 or later),
+ * and it can be disabled by defining MATRIX_POOL_DISABLED,
+ * in which case every request is forwarded to the global operator new/delete.
+ */
+struct MatrixPool {
+  enum {
+    MIN_SHIFT = 5,        ///< The smallest class is 2^5 = 32 bytes.
+    CLASSES = 16,         ///< The largest class is 2^(5 + 15) = 1 MB.
+    MAX_CACHED_BLOCKS = 64, ///< Upper bound of free blocks per class.
+  };
+
+  /**
+   * @brief Allocation statistics of the calling thread for diagnostics
+   */
+  struct statistics_t {
+    unsigned long allocations;    ///< Total number of allocation requests
+    unsigned long reused;         ///< Requests satisfied by free lists
+    unsigned long deallocations;  ///< Total number of deallocation requests
+    unsigned long blocks_in_use;  ///< Blocks currently in use
+    unsigned long blocks_cached;  ///< Blocks currently kept in free lists
+    std::size_t bytes_cached;     ///< Bytes currently kept in free lists
+  };
+
+  struct pool_t {
+    void *free_list[CLASSES]; ///< Heads of singly linked lists through the first word of blocks
+    unsigned int cached[CLASSES];
+    statistics_t stat;
+    bool disabled;
+  };
+
+  /**
+   * Return index of size class
+   *
+   * @param bytes Requested size
+   * @return (int) Index, or -1 when the size is too large to be pooled
+   */
+  static int class_of(std::size_t bytes) noexcept {
+    std::size_t capacity(1 << MIN_SHIFT);
+    for(int i(0); i < CLASSES; ++i, capacity <<= 1){
+      if(bytes <= capacity){return i;}
+    }
+    return -1;
+  }
+
+  static std::size_t capacity_of(const int &index) noexcept {
+    return (std::size_t)1 << (MIN_SHIFT + index);
+  }
+
+#if !defined(MATRIX_POOL_DISABLED) \
+    && ((__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1900)))
+#define MATRIX_POOL_ENABLED
+  /**
+   * Return thread-local pool.
+   * Its cached blocks are returned to heap when the thread exits,
+   * and the pool is disabled afterward to handle objects destroyed later.
+   */
+  static pool_t &pool() noexcept {
+    static thread_local pool_t p; // zero initialized
+    struct cleaner_t {
+      pool_t &target;
+      cleaner_t(pool_t &_target) : target(_target) {}
+      ~cleaner_t(){
+        release(target);
+        target.disabled = true;
+      }
+    };
+    static thread_local cleaner_t cleaner(p);
+    return cleaner.target;
+  }
+#else
+  static pool_t &pool() noexcept {
+    static pool_t p = {{NULL}, {0}, {0}, true};
+    return p;
+  }
+#endif
+
+  static void release(pool_t &p) noexcept {
+    for(int i(0); i < CLASSES; ++i){
+      while(p.free_list[i]){
+        void *next(*static_cast<void **>(p.free_list[i]));
+        ::operator delete(p.free_list[i]);
+        p.free_list[i] = next;
+      }
+      p.stat.blocks_cached -= p.cached[i];
+      p.stat.bytes_cached -= capacity_of(i) * p.cached[i];
+      p.cached[i] = 0;
+    }
+  }
+
+  /**
+   * Allocate a memory block
+   *
+   * @param bytes Requested size
+   * @return (void *) Block whose alignment is the same as one of the global operator new
+   * @throw std::bad_alloc
+   */
+  static void *allocate(const std::size_t &bytes){
+    pool_t &p(pool());
+    ++p.stat.allocations;
+    ++p.stat.blocks_in_use;
+    int index(class_of(bytes));
+    if(index < 0){return ::operator new(bytes);}
+    if(p.free_list[index]){
+      void *res(p.free_list[index]);
+      p.free_list[index] = *static_cast<void **>(res);
+      --p.cached[index];
+      --p.stat.blocks_cached;
+      p.stat.bytes_cached -= capacity_of(index);
+      ++p.stat.reused;
+      return res;
+    }
+    return ::operator new(capacity_of(index));
+  }
+
+  /**
+   * Deallocate a memory block
+   *
+   * @param ptr Block obtained by allocate()
+   * @param bytes Size which has been specified for allocate()
+   */
+  static void deallocate(void *ptr, const std::size_t &bytes) noexcept {
+    if(!ptr){return;}
+    pool_t &p(pool());
+    ++p.stat.deallocations;
+    --p.stat.blocks_in_use;
+    int index(class_of(bytes));
+    if(p.disabled || (index < 0) || (p.cached[index] >= MAX_CACHED_BLOCKS)){
+      ::operator delete(ptr);
+      return;
+    }
+    *static_cast<void **>(ptr) = p.free_list[index];
+    p.free_list[index] = ptr;
+    ++p.cached[index];
+    ++p.stat.blocks_cached;
+    p.stat.bytes_cached += capacity_of(index);
+  }
+
+  /**
+   * Return cached blocks of the calling thread to heap
+   */
+  static void release() noexcept {
+    release(pool());
+  }
+
+  /**
+   * Return allocation statistics of the calling thread
+   *
+   * @return (statistics_t) statistics
+   */
+  static statistics_t statistics() noexcept {
+    return pool().stat;
+  }
+};
+
 /**
  * @brief Array2D whose elements are dense, and are stored in sequential 1D array.
  * In other words, (i, j) element is mapped to [i * rows + j].
  *
+ * The array and its reference counter are co-allocated in a single block
+ * obtained from MatrixPool, and the instance itself is also allocated from the pool.
+ *
  * @param T precision, for example, double
  */
 template <class T>
@@ -201,7 +371,57 @@ class Array2D_Dense : public Array2D<T> {
 
   protected:
     T *values; ///< array for values
-    int *ref;  ///< reference counter
+    int *ref;  ///< reference counter, which is placed in the header of the block of values
+
+    struct block_header_t {
+      int ref;
+      unsigned int size; ///< number of elements
+    };
+    union align_t {
+      long double ld;
+      double d;
+      long l;
+      void *p;
+    };
+    static std::size_t header_bytes() noexcept {
+      return ((sizeof(block_header_t) + sizeof(align_t) - 1) / sizeof(align_t)) * sizeof(align_t);
+    }
+    static block_header_t *header_of(T *values) noexcept {
+      return reinterpret_cast<block_header_t *>(
+          reinterpret_cast<char *>(values) - header_bytes());
+    }
+
+    /**
+     * Allocate elements and a reference counter, whose initial value is 1, in a single block.
+     *
+     * @param size Number of elements
+     * @return (T *) array for values
+     */
+    static T *allocate(const unsigned int &size){
+      char *block(static_cast<char *>(
+          MatrixPool::allocate(header_bytes() + sizeof(T) * size)));
+      block_header_t *header(reinterpret_cast<block_header_t *>(block));
+      header->ref = 1;
+      header->size = size;
+      T *res(reinterpret_cast<T *>(block + header_bytes()));
+      for(unsigned int i(0); i < size; ++i){
+        new(res + i) T;
+      }
+      return res;
+    }
+    /**
+     * Destroy elements and return the block to the pool.
+     *
+     * @param values array for values obtained by allocate()
+     */
+    static void release(T *values) noexcept {
+      block_header_t *header(header_of(values));
+      unsigned int size(header->size);
+      for(unsigned int i(0); i < size; ++i){
+        values[i].~T();
+      }
+      MatrixPool::deallocate(header, header_bytes() + sizeof(T) * size);
+    }
 
     template <class T2>
     static void copy_raw(Array2D_Dense<T2> &dist, const T2 *src){
@@ -214,6 +434,13 @@ class Array2D_Dense : public Array2D<T> {
     }
 
   public:
+    static void *operator new(std::size_t size){
+      return MatrixPool::allocate(size);
+    }
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+      MatrixPool::deallocate(ptr, size);
+    }
+
     /**
      * Constructor
      *
@@ -224,7 +451,7 @@ class Array2D_Dense : public Array2D<T> {
         const unsigned int &rows,
         const unsigned int &columns)
         : super_t(rows, columns),
-        values(new T[rows * columns]), ref(new int(1)) {
+        values(allocate(rows * columns)), ref(&(header_of(values)->ref)) {
     }
     /**
      * Constructor with initializer
@@ -238,7 +465,7 @@ class Array2D_Dense : public Array2D<T> {
         const unsigned int &columns,
         const T *serialized)
         : super_t(rows, columns),
-        values(new T[rows * columns]), ref(new int(1)) {
+        values(allocate(rows * columns)), ref(&(header_of(values)->ref)) {
       copy_raw(*this, serialized);
     }
     /**
@@ -247,8 +474,9 @@ class Array2D_Dense : public Array2D<T> {
      * @param array another one
      */
     Array2D_Dense(const self_t &array)
-        : super_t(array.m_rows, array.m_columns){
-      if(values = array.values){(*(ref = array.ref))++;}
+        : super_t(array.m_rows, array.m_columns),
+        values(array.values), ref(array.ref) {
+      if(ref){++(*ref);}
     }
     /**
      * Constructor based on another type array, which performs deep copy.
@@ -257,10 +485,11 @@ class Array2D_Dense : public Array2D<T> {
      */
     template <class T2>
     Array2D_Dense(const Array2D<T2> &array)
-        : values(new T[array.rows() * array.columns()]), ref(new int(1)) {
-      T *buf;
+        : super_t(array.rows(), array.columns()),
+        values(allocate(array.rows() * array.columns())), ref(&(header_of(values)->ref)) {
+      T *buf(values);
       for(unsigned int i(0); i < array.rows(); ++i){
-        for(unsigned int j(0); j < array.rows(); ++j){
+        for(unsigned int j(0); j < array.columns(); ++j){
           *(buf++) = array(i, j);
         }
       }
@@ -269,12 +498,11 @@ class Array2D_Dense : public Array2D<T> {
      * Destructor
      *
      * The reference counter will be decreased, and when the counter equals to zero,
-     * allocated memory for elements will be deleted.
+     * allocated memory for elements will be returned to the pool.
      */
     ~Array2D_Dense() noexcept {
       if(ref && ((--(*ref)) <= 0)){
-        delete [] values;
-        delete ref;
+        release(values);
       }
     }
 
@@ -286,7 +514,7 @@ class Array2D_Dense : public Array2D<T> {
      */
     self_t &operator=(const self_t &array){
       if(this != &array){
-        if(ref && ((--(*ref)) <= 0)){delete ref; delete [] values;}
+        if(ref && ((--(*ref)) <= 0)){release(values);}
         if(values = array.values){
           super_t::m_rows = array.m_rows;
           super_t::m_columns = array.m_columns;
@@ -330,6 +558,18 @@ class Array2D_Dense : public Array2D<T> {
     }
 };
 
+/**
+ * @brief Property of storage, which tells whether its elements can be accessed
+ * through raw pointer and strides.
+ */
+template <template <class> class Array2D_Type>
+struct Array2DProperty {
+  static const bool dense = false;
+};
+template <>
+struct Array2DProperty<Array2D_Dense> {
+  static const bool dense = true;
+};
 
 struct MatrixView {
   typedef MatrixView self_t;
@@ -1266,6 +1506,117 @@ class Matrix{
       return (copy() -= matrix);
     }
 
+  protected:
+    /**
+     * Return raw access description of elements, which is valid only for dense storage.
+     * Because all views are affine mappings of indices,
+     * strides can be obtained from the addresses of neighbor elements.
+     */
+    typename MatrixKernel<T>::operand_t kernel_operand() const {
+      typename MatrixKernel<T>::operand_t res = {const_cast<T *>(&(*this)(0, 0)), 0, 0};
+      res.row_stride = (rows() > 1) ? (&(*this)(1, 0) - res.ptr) : 0;
+      res.column_stride = (columns() > 1) ? (&(*this)(0, 1) - res.ptr) : 0;
+      return res;
+    }
+
+    template <class T2, class U = void>
+    struct is_same_content_t {
+      static const bool res = false;
+    };
+    template <class U>
+    struct is_same_content_t<T, U> {
+      static const bool res = true;
+    };
+
+    template <bool kernel_available, class U = void>
+    struct multiplier_t {
+      template <
+          template <class> class Array2D_Type1, class ViewType1,
+          class T2, template <class> class Array2D_Type2, class ViewType2,
+          template <class> class Array2D_Type3, class ViewType3>
+      static void run(
+          Matrix<T, Array2D_Type3, ViewType3> &C,
+          const Matrix<T, Array2D_Type1, ViewType1> &A,
+          const Matrix<T2, Array2D_Type2, ViewType2> &B,
+          const T &alpha, const T &beta){
+        for(unsigned int i(0); i < C.rows(); i++){
+          for(unsigned int j(0); j < C.columns(); j++){
+            T sum(0);
+            if(A.columns() > 0){
+              sum = A(i, 0) * B(0, j);
+              for(unsigned int k(1); k < A.columns(); k++){
+                sum += (A(i, k) * B(k, j));
+              }
+            }
+            if(beta == T(0)){
+              C(i, j) = sum * alpha;
+            }else{
+              C(i, j) = C(i, j) * beta + sum * alpha;
+            }
+          }
+        }
+      }
+    };
+    template <class U>
+    struct multiplier_t<true, U> {
+      template <
+          template <class> class Array2D_Type1, class ViewType1,
+          class T2, template <class> class Array2D_Type2, class ViewType2,
+          template <class> class Array2D_Type3, class ViewType3>
+      static void run(
+          Matrix<T, Array2D_Type3, ViewType3> &C,
+          const Matrix<T, Array2D_Type1, ViewType1> &A,
+          const Matrix<T2, Array2D_Type2, ViewType2> &B,
+          const T &alpha, const T &beta){
+        if((C.rows() == 0) || (C.columns() == 0)){return;}
+        if(A.columns() == 0){
+          MatrixKernel<T>::scale(C.rows(), C.columns(), beta, C.kernel_operand());
+          return;
+        }
+        MatrixKernel<T>::template gemm<MatrixPool>(
+            C.rows(), C.columns(), A.columns(),
+            alpha, A.kernel_operand(), B.kernel_operand(),
+            beta, C.kernel_operand());
+      }
+    };
+
+  public:
+    /**
+     * Perform C = alpha * A * B + beta * C (bang method for C).
+     * Contiguous and strided (transposed, partial) operands of dense storage
+     * are processed by MatrixKernel; otherwise, element-wise access is used.
+     * C must not share its elements with A or B.
+     *
+     * @param C Matrix to be updated, which can be a view
+     * @param A Left hand side matrix
+     * @param B Right hand side matrix
+     * @param alpha Coefficient of product, the default is 1
+     * @param beta Coefficient of C, the default is 1
+     * @return (C)
+     * @throw MatrixException
+     */
+    template <
+        template <class> class Array2D_Type1, class ViewType1,
+        class T2, template <class> class Array2D_Type2, class ViewType2,
+        template <class> class Array2D_Type3, class ViewType3>
+    static Matrix<T, Array2D_Type3, ViewType3> &multiply_add(
+        Matrix<T, Array2D_Type3, ViewType3> &C,
+        const Matrix<T, Array2D_Type1, ViewType1> &A,
+        const Matrix<T2, Array2D_Type2, ViewType2> &B,
+        const T &alpha = T(1), const T &beta = T(1)){
+      if((A.columns() != B.rows())
+          || (C.rows() != A.rows()) || (C.columns() != B.columns())){
+        throw MatrixException("Incorrect size");
+      }
+      multiplier_t<
+          Array2DProperty<Array2D_Type1>::dense
+          && Array2DProperty<Array2D_Type2>::dense
+          && Array2DProperty<Array2D_Type3>::dense
+          && is_same_content_t<T2>::res>
+          ::run(C, A, B, alpha, beta);
+      return C;
+    }
+
     /**
      * Multiply by matrix
      *
@@ -1279,15 +1630,7 @@ class Matrix{
         throw MatrixException("Incorrect size");
       }
       viewless_t result(blank(rows(), matrix.columns()));
-      for(unsigned int i(0); i < result.rows(); i++){
-        for(unsigned int j(0); j < result.columns(); j++){
-          result(i, j) = (*this)(i, 0) * matrix(0, j);
-          for(unsigned int k(1); k < columns(); k++){
-            result(i, j) += ((*this)(i, k) * matrix(k, j));
-          }
-        }
-      }
-      return result;
+      return multiply_add(result, *this, matrix, T(1), T(0));
     }
     
     /**
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2015, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __MATRIX_KERNEL_H
+#define __MATRIX_KERNEL_H
+
+/** @file
+ * @brief Computation kernels for matrix library
+ *
+ * Kernels operate on raw arrays described by a base pointer and strides,
+ * which covers every combination of transpose and partial views
+ * of dense storage, because those views are affine mappings of indices.
+ * The product is performed as
+ * 1) a direct strided loop for small operands, whose summation order is
+ * the same as the naive triple loop, or
+ * 2) a cache-tiled and register-blocked loop with packed operands (GotoBLAS style).
+ * The micro kernel of 2) utilizes AVX2/FMA for float and double
+ * when they are enabled at compile time (for example, -mavx2 -mfma with GCC),
+ * otherwise a portable one is used.
+ */
+
+#include <cstddef>
+#include <new>
+
+#if (defined(__AVX2__) && defined(__FMA__)) && !defined(MATRIX_KERNEL_NO_SIMD)
+#include <immintrin.h>
+#define MATRIX_KERNEL_AVX2
+#endif
+
+#if (__cplusplus < 201103L) && !defined(noexcept)
+#define noexcept throw()
+#endif
+
+template <class T>
+struct MatrixKernel {
+
+  /**
+   * @brief Raw access to elements, (i, j) element is ptr[i * row_stride + j * column_stride].
+   */
+  struct operand_t {
+    T *ptr;
+    std::ptrdiff_t row_stride, column_stride;
+    inline T &operator()(const unsigned int &i, const unsigned int &j) const noexcept {
+      return ptr[row_stride * i + column_stride * j];
+    }
+  };
+
+  static const unsigned int MR = 4;   ///< Rows of register block
+  static const unsigned int NR = 8;   ///< Columns of register block
+  static const unsigned int MC = 64;  ///< Rows of A block, which should be fit in L2 cache
+  static const unsigned int KC = 256; ///< Inner dimension of blocks
+  static const unsigned int NC = 512; ///< Columns of B block
+  static const unsigned int DIRECT_THRESHOLD = 0x4000; ///< Upper bound of m * n * k for direct loop
+
+  /**
+   * @brief Scratch buffer obtained from a memory pool
+   */
+  template <class Pool>
+  struct buffer_t {
+    T *ptr;
+    std::size_t size;
+    buffer_t(const std::size_t &_size)
+        : ptr(static_cast<T *>(Pool::allocate(sizeof(T) * _size))), size(_size) {
+      for(std::size_t i(0); i < size; ++i){new(ptr + i) T;}
+    }
+    ~buffer_t() noexcept {
+      for(std::size_t i(0); i < size; ++i){ptr[i].~T();}
+      Pool::deallocate(ptr, sizeof(T) * size);
+    }
+  };
+
+  /**
+   * Perform C = beta * C in the region of m by n.
+   * When beta is zero, elements are overwritten with zero,
+   * which is required to clear uninitialized storage.
+   */
+  static void scale(
+      const unsigned int &m, const unsigned int &n,
+      const T &beta, const operand_t &C){
+    if(beta == T(1)){return;}
+    for(unsigned int i(0); i < m; ++i){
+      for(unsigned int j(0); j < n; ++j){
+        if(beta == T(0)){
+          C(i, j) = T(0);
+        }else{
+          C(i, j) *= beta;
+        }
+      }
+    }
+  }
+
+  /**
+   * Pack m by k region of A into MR-row panels, in which MR elements
+   * of the same column are adjacent. Missing rows are padded by zero.
+   */
+  static void pack_A(
+      const unsigned int &m, const unsigned int &k,
+      const operand_t &A, T *buf){
+    for(unsigned int i(0); i < m; i += MR){
+      for(unsigned int p(0); p < k; ++p){
+        for(unsigned int r(0); r < MR; ++r){
+          *(buf++) = ((i + r) < m) ? A(i + r, p) : T(0);
+        }
+      }
+    }
+  }
+
+  /**
+   * Pack k by n region of B into NR-column panels, in which NR elements
+   * of the same row are adjacent. Missing columns are padded by zero.
+   */
+  static void pack_B(
+      const unsigned int &k, const unsigned int &n,
+      const operand_t &B, T *buf){
+    for(unsigned int j(0); j < n; j += NR){
+      for(unsigned int p(0); p < k; ++p){
+        for(unsigned int c(0); c < NR; ++c){
+          *(buf++) = ((j + c) < n) ? B(p, j + c) : T(0);
+        }
+      }
+    }
+  }
+
+  /**
+   * Micro kernel calculating MR by NR block product of packed panels.
+   *
+   * @param k Inner dimension
+   * @param a Packed A panel
+   * @param b Packed B panel
+   * @param acc Result whose (r, c) element is acc[r * NR + c]
+   */
+  static void micro(const unsigned int &k, const T *a, const T *b, T *acc){
+    for(unsigned int i(0); i < MR * NR; ++i){acc[i] = T(0);}
+    for(unsigned int p(0); p < k; ++p, a += MR, b += NR){
+      for(unsigned int r(0); r < MR; ++r){
+        for(unsigned int c(0); c < NR; ++c){
+          acc[r * NR + c] += a[r] * b[c];
+        }
+      }
+    }
+  }
+
+  /**
+   * General matrix multiplication C = alpha * A * B + beta * C.
+   * C must not overlap with A or B.
+   *
+   * @param m Rows of A and C
+   * @param n Columns of B and C
+   * @param k Columns of A and rows of B
+   * @param Pool Memory pool for scratch buffers
+   */
+  template <class Pool>
+  static void gemm(
+      const unsigned int &m, const unsigned int &n, const unsigned int &k,
+      const T &alpha, const operand_t &A, const operand_t &B,
+      const T &beta, const operand_t &C){
+
+    if((std::size_t)m * n * k <= DIRECT_THRESHOLD){
+      // direct loop, whose summation order is identical to the naive one
+      if((beta == T(0)) && (alpha == T(1)) && (k > 0)
+          && (B.column_stride == 1) && (C.column_stride == 1)){
+        // row update form, in which the innermost loop is contiguous
+        for(unsigned int i(0); i < m; ++i){
+          T *c(&C(i, 0));
+          const T *b(&B(0, 0));
+          const T a0(A(i, 0));
+          for(unsigned int j(0); j < n; ++j){c[j] = a0 * b[j];}
+          for(unsigned int p(1); p < k; ++p){
+            b += B.row_stride;
+            const T a(A(i, p));
+            for(unsigned int j(0); j < n; ++j){c[j] += a * b[j];}
+          }
+        }
+        return;
+      }
+      for(unsigned int i(0); i < m; ++i){
+        for(unsigned int j(0); j < n; ++j){
+          T sum(0);
+          if(k > 0){
+            const T *a(&A(i, 0)), *b(&B(0, j));
+            sum = (*a) * (*b);
+            for(unsigned int p(1); p < k; ++p){
+              a += A.column_stride;
+              b += B.row_stride;
+              sum += (*a) * (*b);
+            }
+          }
+          T &c(C(i, j));
+          if(beta == T(0)){
+            c = (alpha == T(1)) ? sum : (sum * alpha);
+          }else{
+            if(beta != T(1)){c *= beta;}
+            c += ((alpha == T(1)) ? sum : (sum * alpha));
+          }
+        }
+      }
+      return;
+    }
+
+    scale(m, n, beta, C);
+
+    const unsigned int
+        mc_max((m < MC) ? (((m + MR - 1) / MR) * MR) : MC),
+        nc_max((n < NC) ? (((n + NR - 1) / NR) * NR) : NC),
+        kc_max((k < KC) ? k : KC);
+    buffer_t<Pool> buf_A(mc_max * kc_max), buf_B(kc_max * nc_max);
+    T acc[MR * NR];
+
+    for(unsigned int jc(0); jc < n; jc += NC){
+      const unsigned int nc(((n - jc) < NC) ? (n - jc) : NC);
+      for(unsigned int pc(0); pc < k; pc += KC){
+        const unsigned int kc(((k - pc) < KC) ? (k - pc) : KC);
+        operand_t B_block = {&B(pc, jc), B.row_stride, B.column_stride};
+        pack_B(kc, nc, B_block, buf_B.ptr);
+        for(unsigned int ic(0); ic < m; ic += MC){
+          const unsigned int mc(((m - ic) < MC) ? (m - ic) : MC);
+          operand_t A_block = {&A(ic, pc), A.row_stride, A.column_stride};
+          pack_A(mc, kc, A_block, buf_A.ptr);
+          for(unsigned int jr(0); jr < nc; jr += NR){
+            const unsigned int nr(((nc - jr) < NR) ? (nc - jr) : NR);
+            for(unsigned int ir(0); ir < mc; ir += MR){
+              const unsigned int mr(((mc - ir) < MR) ? (mc - ir) : MR);
+              micro(kc, buf_A.ptr + ir * kc, buf_B.ptr + jr * kc, acc);
+              for(unsigned int r(0); r < mr; ++r){
+                for(unsigned int c(0); c < nr; ++c){
+                  C(ic + ir + r, jc + jr + c) += ((alpha == T(1))
+                      ? acc[r * NR + c]
+                      : (acc[r * NR + c] * alpha));
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+template <class T> const unsigned int MatrixKernel<T>::MR;
+template <class T> const unsigned int MatrixKernel<T>::NR;
+template <class T> const unsigned int MatrixKernel<T>::MC;
+template <class T> const unsigned int MatrixKernel<T>::KC;
+template <class T> const unsigned int MatrixKernel<T>::NC;
+template <class T> const unsigned int MatrixKernel<T>::DIRECT_THRESHOLD;
+
+#if defined(MATRIX_KERNEL_AVX2)
+template <>
+inline void MatrixKernel<double>::micro(
+    const unsigned int &k, const double *a, const double *b, double *acc){
+  __m256d c00(_mm256_setzero_pd()), c01(_mm256_setzero_pd()),
+      c10(_mm256_setzero_pd()), c11(_mm256_setzero_pd()),
+      c20(_mm256_setzero_pd()), c21(_mm256_setzero_pd()),
+      c30(_mm256_setzero_pd()), c31(_mm256_setzero_pd());
+  for(unsigned int p(0); p < k; ++p, a += MR, b += NR){
+    __m256d b0(_mm256_loadu_pd(b)), b1(_mm256_loadu_pd(b + 4)), a_r;
+    a_r = _mm256_broadcast_sd(a);
+    c00 = _mm256_fmadd_pd(a_r, b0, c00); c01 = _mm256_fmadd_pd(a_r, b1, c01);
+    a_r = _mm256_broadcast_sd(a + 1);
+    c10 = _mm256_fmadd_pd(a_r, b0, c10); c11 = _mm256_fmadd_pd(a_r, b1, c11);
+    a_r = _mm256_broadcast_sd(a + 2);
+    c20 = _mm256_fmadd_pd(a_r, b0, c20); c21 = _mm256_fmadd_pd(a_r, b1, c21);
+    a_r = _mm256_broadcast_sd(a + 3);
+    c30 = _mm256_fmadd_pd(a_r, b0, c30); c31 = _mm256_fmadd_pd(a_r, b1, c31);
+  }
+  _mm256_storeu_pd(acc,      c00); _mm256_storeu_pd(acc + 4,  c01);
+  _mm256_storeu_pd(acc + 8,  c10); _mm256_storeu_pd(acc + 12, c11);
+  _mm256_storeu_pd(acc + 16, c20); _mm256_storeu_pd(acc + 20, c21);
+  _mm256_storeu_pd(acc + 24, c30); _mm256_storeu_pd(acc + 28, c31);
+}
+
+template <>
+inline void MatrixKernel<float>::micro(
+    const unsigned int &k, const float *a, const float *b, float *acc){
+  __m256 c0(_mm256_setzero_ps()), c1(_mm256_setzero_ps()),
+      c2(_mm256_setzero_ps()), c3(_mm256_setzero_ps());
+  for(unsigned int p(0); p < k; ++p, a += MR, b += NR){
+    __m256 b0(_mm256_loadu_ps(b));
+    c0 = _mm256_fmadd_ps(_mm256_broadcast_ss(a),     b0, c0);
+    c1 = _mm256_fmadd_ps(_mm256_broadcast_ss(a + 1), b0, c1);
+    c2 = _mm256_fmadd_ps(_mm256_broadcast_ss(a + 2), b0, c2);
+    c3 = _mm256_fmadd_ps(_mm256_broadcast_ss(a + 3), b0, c3);
+  }
+  _mm256_storeu_ps(acc,      c0);
+  _mm256_storeu_ps(acc + 8,  c1);
+  _mm256_storeu_ps(acc + 16, c2);
+  _mm256_storeu_ps(acc + 24, c3);
+}
+#endif
+
+#if (__cplusplus < 201103L) && defined(noexcept)
+#undef noexcept
+#endif
+
+#endif /* __MATRIX_KERNEL_H */
@@ -9,6 +9,7 @@
 %{
 #include <string>
 #include <vector>
+#include <stdexcept>
 
 #include "navigation/MagneticField.h"
 #include "navigation/WGS84.h"
@@ -42,6 +43,28 @@
     }
     $result = arr;
   }
+  %typemap(in) const std::vector<type> & (std::vector<type> temp) {
+    Check_Type($input, T_ARRAY);
+    for(int i(0), i_max(RARRAY_LEN($input)); i < i_max; ++i){
+      temp.push_back((type)NUM2DBL(rb_ary_entry($input, i)));
+    }
+    $1 = &temp;
+  }
+  %typemap(typecheck, precedence=SWIG_TYPECHECK_POINTER) const std::vector<type> & {
+    $1 = (TYPE($input) == T_ARRAY) ? 1 : 0;
+  }
+  %typemap(out) field_components_batch_t {
+    VALUE arr[3] = {rb_ary_new2($1.north.size()), rb_ary_new2($1.east.size()), rb_ary_new2($1.down.size())};
+    for(int i(0), i_max($1.north.size()); i < i_max; i++){
+      rb_ary_push(arr[0], DBL2NUM((double)($1.north[i])));
+      rb_ary_push(arr[1], DBL2NUM((double)($1.east[i])));
+      rb_ary_push(arr[2], DBL2NUM((double)($1.down[i])));
+    }
+    $result = rb_hash_new();
+    rb_hash_aset($result, ID2SYM(rb_intern("north")), arr[0]);
+    rb_hash_aset($result, ID2SYM(rb_intern("east")), arr[1]);
+    rb_hash_aset($result, ID2SYM(rb_intern("down")), arr[2]);
+  }
 #endif
 }
 %inline %{
@@ -71,6 +94,31 @@ struct MagneticFieldModel : public MagneticFieldGeneric<type>::model_t {
       const type &height_meter){
     return MagneticFieldGeneric<type>::field_components_geocentric(*this, latitude_rad, longitude_rad, height_meter);
   }
+  struct field_components_batch_t {
+    std::vector<type> north, east, down;
+  };
+  field_components_batch_t field_components_batch(
+      const std::vector<type> &latitude_rad,
+      const std::vector<type> &longitude_rad,
+      const std::vector<type> &height_meter,
+      const int &threads = 1){
+    if((longitude_rad.size() != latitude_rad.size())
+        || (height_meter.size() != latitude_rad.size())){
+      throw std::invalid_argument("Inconsistent length of latitude, longitude, and height");
+    }
+    int n(latitude_rad.size());
+    field_components_batch_t res;
+    res.north.resize(n);
+    res.east.resize(n);
+    res.down.resize(n);
+    if(n > 0){
+      MagneticFieldGeneric<type>::field_components(*this,
+          &latitude_rad[0], &longitude_rad[0], &height_meter[0], n,
+          &res.north[0], &res.east[0], &res.down[0],
+          threads);
+    }
+    return res;
+  }
   typename MagneticFieldGeneric<type>::latlng_t geomagnetic_latlng(
       const type &geocentric_latitude,
       const type &longitude){
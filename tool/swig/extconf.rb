@@ -3,3 +3,10 @@ cflags = " -Wall -I../../.."
 $CFLAGS += cflags
 $CPPFLAGS += cflags if RUBY_VERSION >= "2.0.0"
 $LOCAL_LIBS += " -lstdc++ "
+
+# OpenMP is used in batch evaluation if available
+if try_link("#include <omp.h>\nint main(){return omp_get_max_threads();}", " -fopenmp") then
+  $CFLAGS += " -fopenmp"
+  $CPPFLAGS += " -fopenmp" if RUBY_VERSION >= "2.0.0"
+  $LDFLAGS += " -fopenmp"
+end
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <sstream>
+#include <cmath>
+
+#include "navigation/INS_EGM.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#endif
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(EGM)
+
+BOOST_AUTO_TEST_CASE(egm_gravity_grid){
+  typedef INS_EGM<INS<double> > ins_t;
+  typedef ins_t::gravity_grid_t grid_t;
+  grid_t grid(ins_t::gravity_total_local);
+  const double tolerance(grid.get_property().tolerance);
+
+  ins_t ins_direct, ins_cached;
+  ins_cached.set_gravity_grid(&grid);
+  for(int i(0); i < 100; ++i){ // around (35, 139) deg, 0-3000 m
+    double lat(M_PI / 180 * (35 + 0.013 * (i % 10))),
+        lng(M_PI / 180 * (139 + 0.0071 * (i / 10))),
+        h(31. * i);
+    ins_direct.initPosition(lat, lng, h);
+    ins_cached.initPosition(lat, lng, h);
+    ins_t::vec3_t g_direct(ins_direct.gravity_total()), g_cached(ins_cached.gravity_total());
+    for(int j(0); j < 3; ++j){
+      BOOST_REQUIRE_SMALL(g_cached[j] - g_direct[j], tolerance);
+    }
+  }
+  BOOST_CHECK(grid.tiles_generated() > 0);
+  BOOST_CHECK_EQUAL(grid.tiles_rejected(), 0);
+
+  // Non-zero wander azimuth
+  ins_cached.initPosition(M_PI / 180 * 35, M_PI / 180 * 139, 50);
+  ins_cached.initVelocity(0, 100, 0);
+  for(int i(0); i < 1000; ++i){
+    ins_cached.update(ins_t::vec3_t(0, 0, -9.8), ins_t::vec3_t(), 1);
+  }
+  BOOST_REQUIRE(std::abs(ins_cached.azimuth()) > 1E-3);
+  {
+    ins_t ins_copy(ins_cached, true);
+    BOOST_REQUIRE_EQUAL(ins_copy.gravity_grid(), &grid);
+    ins_copy.set_gravity_grid(NULL);
+    ins_t::vec3_t g_direct(ins_copy.gravity_total()), g_cached(ins_cached.gravity_total());
+    for(int j(0); j < 3; ++j){
+      BOOST_REQUIRE_SMALL(g_cached[j] - g_direct[j], tolerance);
+    }
+  }
+
+  // Pre-generation, then save and load
+  int generated(grid.tiles_generated());
+  BOOST_CHECK(grid.prepare(
+      M_PI / 180 * 35, M_PI / 180 * 139, 0,
+      M_PI / 180 * 36, M_PI / 180 * 140, 0) > 0);
+  BOOST_CHECK(grid.tiles_generated() > generated);
+  std::stringstream ss;
+  grid.save(ss);
+  grid_t grid2(ins_t::gravity_total_local);
+  BOOST_REQUIRE(grid2.load(ss));
+  BOOST_REQUIRE_EQUAL(grid2.tiles_generated(), grid.tiles_generated());
+  for(int i(0); i < 10; ++i){
+    double g1[3], g2[3];
+    double lat(M_PI / 180 * (35 + 0.1 * i)), lng(M_PI / 180 * (139 + 0.1 * i));
+    grid.get(lat, lng, 10, g1);
+    grid2.get(lat, lng, 10, g2);
+    for(int j(0); j < 3; ++j){
+      BOOST_REQUIRE_EQUAL(g1[j], g2[j]);
+    }
+  }
+  BOOST_CHECK_EQUAL(grid2.tiles_generated(), grid.tiles_generated()); // no more generation
+
+  std::stringstream broken("GRVGRID0");
+  BOOST_CHECK(!grid2.load(broken));
+  BOOST_CHECK_EQUAL(grid2.tiles_generated(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(egm_clenshaw){
+  typedef EGM2008_70_Generic<double> egm_t;
+  static const int n(23);
+  egm_t::position_t points[n];
+  egm_t::gravity_res_t res_batch[n];
+  for(int i(0); i < n; ++i){
+    points[i].r = WGS84::R_e + 500. * i;
+    points[i].phi = M_PI / 180 * (-85 + 7.5 * i);
+    points[i].lambda = M_PI / 180 * (-179 + 15.3 * i);
+  }
+  egm_t::gravity(points, n, res_batch);
+  for(int i(0); i < n; ++i){
+    const double &r(points[i].r), &phi(points[i].phi), &lambda(points[i].lambda);
+
+    // Clenshaw summation v.s. forward recursion
+    egm_t::cache_t cache;
+    cache.update(WGS84::R_e / r, phi, lambda);
+    egm_t::gravity_res_t g(egm_t::gravity(r, phi, lambda)), g_cache(egm_t::gravity(cache, r, phi, lambda));
+    BOOST_REQUIRE_SMALL(g.r - g_cache.r, 1E-12);
+    BOOST_REQUIRE_SMALL(g.phi - g_cache.phi, 1E-12);
+    BOOST_REQUIRE_SMALL(g.lambda - g_cache.lambda, 1E-12);
+    BOOST_REQUIRE_SMALL(egm_t::potential(r, phi, lambda) - egm_t::potential(cache, r, phi, lambda), 1E-6);
+
+    // batch v.s. single
+    BOOST_REQUIRE_SMALL(res_batch[i].r - g.r, 1E-12);
+    BOOST_REQUIRE_SMALL(res_batch[i].phi - g.phi, 1E-12);
+    BOOST_REQUIRE_SMALL(res_batch[i].lambda - g.lambda, 1E-12);
+
+    // gravity v.s. numerical derivative of potential
+    static const double d(1E-6);
+    BOOST_CHECK_SMALL(g.phi
+        - (egm_t::potential(r, phi + d, lambda) - egm_t::potential(r, phi - d, lambda)) / (d * 2) / r,
+        1E-6);
+    BOOST_CHECK_SMALL(g.lambda
+        - (egm_t::potential(r, phi, lambda + d) - egm_t::potential(r, phi, lambda - d)) / (d * 2)
+          / (r * std::cos(phi)),
+        1E-6);
+    BOOST_CHECK_SMALL(g.r
+        - (egm_t::potential(r + 1, phi, lambda) - egm_t::potential(r - 1, phi, lambda)) / 2,
+        1E-6);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
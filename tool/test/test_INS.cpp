@@ -0,0 +1,159 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "param/matrix.h"
+#include "navigation/INS.h"
+#include "navigation/ConingSculling.h"
+#include "navigation/INS_Ensemble.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#endif
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(INS_mechanization)
+
+BOOST_AUTO_TEST_CASE(ins_frame_cache){
+  typedef INS<double> ins_t;
+  ins_t ins;
+  ins.initPosition(0.6, 2.4, 100);
+  ins.initVelocity(10, -5, 1);
+  ins.initAttitude(0.3, 0.02, -0.01);
+  struct checker_t {
+    static void check(const ins_t &ins){
+      const ins_t::frame_t &frame(ins.frame_cache());
+      BOOST_CHECK_SMALL(frame.sin_phi - std::sin(ins.latitude()), 1E-14);
+      BOOST_CHECK_SMALL(frame.cos_phi - std::cos(ins.latitude()), 1E-14);
+      BOOST_CHECK_SMALL(frame.sin_alpha - std::sin(ins.azimuth()), 1E-14);
+      BOOST_CHECK_SMALL(frame.cos_alpha - std::cos(ins.azimuth()), 1E-14);
+      BOOST_CHECK_SMALL(frame.R_normal / ins_t::Earth::R_normal(ins.latitude()) - 1, 1E-14);
+      BOOST_CHECK_SMALL(frame.R_meridian / ins_t::Earth::R_meridian(ins.latitude()) - 1, 1E-14);
+      Matrix<double> dcm_e2n(
+          ins_t::quat_t(ins[3], ins[4], ins[5], ins[6]).getDCM());
+      Matrix<double> dcm_n2b(ins.n2b().getDCM());
+      for(unsigned i(0); i < 3; ++i){
+        for(unsigned j(0); j < 3; ++j){
+          BOOST_CHECK_SMALL(frame.dcm_e2n(i, j) - dcm_e2n(i, j), 1E-14);
+          BOOST_CHECK_SMALL(frame.dcm_n2b(i, j) - dcm_n2b(i, j), 1E-14);
+        }
+      }
+    }
+  };
+  checker_t::check(ins);
+  for(int i(0); i < 100; ++i){
+    ins.update(ins_t::vec3_t(0.1, -0.2, -9.8), ins_t::vec3_t(1E-3, -2E-3, 3E-3), 0.01);
+  }
+  checker_t::check(ins);
+  ins.mod_euler_psi(0.1); // attitude is changed without recalc()
+  checker_t::check(ins);
+}
+
+BOOST_AUTO_TEST_CASE(coning_sculling){
+  typedef INS<double> ins_t;
+  typedef ins_t::vec3_t vec3_t;
+  struct motion_t { // coning motion with rotating specific force
+    static void sample(const double &t0, const double &dt, vec3_t &accel, vec3_t &gyro){
+      static const double w(M_PI * 4), a(0.05), f(2.0);
+      accel = vec3_t(); gyro = vec3_t();
+      for(int k(0); k < 20; ++k){ // average over the interval
+        double t(t0 + dt * (0.5 + k) / 20);
+        accel = accel + vec3_t(f * std::sin(w * t), f * std::cos(w * t), -9.8) / 20;
+        gyro = gyro + vec3_t(a * w * std::cos(w * t), a * w * std::sin(w * t), 0.01) / 20;
+      }
+    }
+  };
+  ins_t ref, sample, block;
+  ins_t *ins[] = {&ref, &sample, &block};
+  for(int i(0); i < 3; ++i){
+    ins[i]->initPosition(0.6, 2.4, 0);
+    ins[i]->initVelocity(0, 0, 0);
+    ins[i]->initAttitude(0, 0, 0);
+  }
+  ref.set_attitude_by_rotation(true);
+  block.set_attitude_by_rotation(true); // sample keeps the default first-order integration
+  static const double duration(10);
+  for(int i(0); i < 100000; ++i){ // 10 kHz
+    vec3_t accel, gyro;
+    motion_t::sample(duration / 100000 * i, duration / 100000, accel, gyro);
+    ref.update(accel, gyro, duration / 100000);
+  }
+  ConingScullingAccumulator<double> acc;
+  for(int i(0); i < 1000; ++i){ // 100 Hz, 10 samples per block
+    vec3_t accel, gyro;
+    motion_t::sample(duration / 1000 * i, duration / 1000, accel, gyro);
+    sample.update(accel, gyro, duration / 1000);
+    acc.add(accel, gyro, duration / 1000);
+    if(acc.samples() < 10){continue;}
+    BOOST_REQUIRE_CLOSE(acc.elapsed(), duration / 100, 1E-8);
+    block.update(acc.accel(), acc.gyro(), acc.elapsed());
+    acc.reset();
+  }
+  double err_sample(std::abs(sample.euler_psi() - ref.euler_psi())),
+      err_block(std::abs(block.euler_psi() - ref.euler_psi()));
+  BOOST_TEST_MESSAGE("coning_sculling: psi error " << err_sample << " (per sample), " << err_block << " (block)");
+  BOOST_CHECK(err_block < err_sample);
+  BOOST_CHECK_SMALL(block.euler_theta() - ref.euler_theta(), 1E-5);
+  BOOST_CHECK_SMALL(block.euler_phi() - ref.euler_phi(), 1E-5);
+  BOOST_CHECK_SMALL(block.v_north() - ref.v_north(), 1E-3);
+  BOOST_CHECK_SMALL(block.v_east() - ref.v_east(), 1E-3);
+  BOOST_CHECK_SMALL(block.v_down() - ref.v_down(), 1E-3);
+}
+
+BOOST_AUTO_TEST_CASE(ins_ensemble){
+  typedef INS<double> ins_t;
+  typedef INS_Ensemble<double> ensemble_t;
+  typedef ins_t::vec3_t vec3_t;
+  ins_t init;
+  init.initPosition(0.6, 2.4, 100);
+  init.initVelocity(20, -5, 1);
+  init.initAttitude(0, 0.02, -0.01);
+  init.set_attitude_by_rotation(true);
+  static const unsigned K(8);
+  ensemble_t ensemble(K, init);
+  std::vector<ins_t> reference;
+  for(unsigned k(0); k < K; ++k){ // multiple hypotheses of yaw angle
+    double yaw(M_PI * 2 / K * k - M_PI);
+    reference.push_back(ins_t(init, true)); // deep copy, otherwise the states are shared
+    reference[k].initAttitude(yaw, 0.02, -0.01);
+    ensemble.initAttitude(k, yaw, 0.02, -0.01);
+  }
+  for(int i(0); i < 10000; ++i){
+    double t(0.01 * i);
+    vec3_t accel(0.5 * std::sin(t), 0.3 * std::cos(t * 0.7), -9.8),
+        gyro(1E-2 * std::cos(t), -2E-2 * std::sin(t * 1.3), 5E-2);
+    ensemble.update(accel, gyro, 0.01);
+    for(unsigned k(0); k < K; ++k){
+      reference[k].update(accel, gyro, 0.01);
+    }
+  }
+  for(unsigned k(0); k < K; ++k){
+    const ins_t &ref(reference[k]);
+    BOOST_CHECK_SMALL(ensemble.latitude(k) - ref.latitude(), 1E-12);
+    BOOST_CHECK_SMALL(ensemble.longitude(k) - ref.longitude(), 1E-12);
+    BOOST_CHECK_SMALL(ensemble.azimuth(k) - ref.azimuth(), 1E-9);
+    BOOST_CHECK_SMALL(ensemble.height(k) - ref.height(), 1E-6);
+    BOOST_CHECK_SMALL(ensemble.v_north(k) - ref.v_north(), 1E-8);
+    BOOST_CHECK_SMALL(ensemble.v_east(k) - ref.v_east(), 1E-8);
+    BOOST_CHECK_SMALL(ensemble.v_down(k) - ref.v_down(), 1E-8);
+    BOOST_CHECK_SMALL(ensemble.heading(k) - ref.heading(), 1E-9);
+    BOOST_CHECK_SMALL(ensemble.euler_theta(k) - ref.euler_theta(), 1E-9);
+    BOOST_CHECK_SMALL(ensemble.euler_phi(k) - ref.euler_phi(), 1E-9);
+    ins_t exported;
+    ensemble.copy_to(k, exported);
+    for(unsigned i(0); i < ins_t::STATE_VALUES; ++i){ // quaternions may be regularized again
+      BOOST_CHECK_SMALL(exported[i] - ensemble[(ensemble_t::field_t)i][k], 1E-14);
+    }
+    BOOST_CHECK_SMALL(exported.latitude() - ensemble.latitude(k), 1E-14);
+    BOOST_CHECK_SMALL(exported.v_north() - ensemble.v_north(k), 1E-14);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
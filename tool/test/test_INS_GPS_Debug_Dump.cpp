@@ -0,0 +1,183 @@
+#include <iostream>
+#include <sstream>
+#include <set>
+
+#include "param/matrix.h"
+#include "navigation/INS_GPS_Debug_Dump.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#endif
+
+using namespace std;
+
+typedef Matrix<double> matrix_t;
+typedef INS_GPS_Debug_Dump_Format format_t;
+
+static matrix_t symmetric(const int &n, const double &offset = 0){
+  matrix_t res(n, n);
+  for(int i(0); i < n; i++){
+    for(int j(i); j < n; j++){
+      res(i, j) = res(j, i) = offset + 10 * i + j;
+    }
+  }
+  return res;
+}
+
+BOOST_AUTO_TEST_SUITE(INS_GPS_Debug_Dump)
+
+BOOST_AUTO_TEST_CASE(P_index){
+  const int n(6);
+  format_t::layout_t layout(n, 2, format_t::CONTENT_PHI | format_t::CONTENT_K | format_t::CONTENT_RESIDUAL);
+  BOOST_CHECK_EQUAL(layout.Phi, (std::size_t)(n * (n + 1) / 2));
+  BOOST_CHECK_EQUAL(layout.K, layout.Phi + n * n);
+  BOOST_CHECK_EQUAL(layout.residual, layout.K + n * 2);
+  BOOST_CHECK_EQUAL(layout.values, layout.residual + 2);
+
+  std::set<std::size_t> indices;
+  for(int i(0), k(0); i < n; i++){
+    for(int j(i); j < n; j++, k++){
+      BOOST_CHECK_EQUAL(layout.P_index(i, j), (std::size_t)k); // row major upper triangle
+      BOOST_CHECK_EQUAL(layout.P_index(j, i), (std::size_t)k);
+      indices.insert(layout.P_index(j, i));
+    }
+  }
+  BOOST_CHECK_EQUAL(indices.size(), layout.Phi);
+}
+
+BOOST_AUTO_TEST_CASE(round_trip){
+  const int n(4), m_max(3);
+  stringstream ss;
+  {
+    INS_GPS_Debug_Dump_Writer writer;
+    writer.open(ss,
+        format_t::CONTENT_PHI | format_t::CONTENT_K | format_t::CONTENT_RESIDUAL,
+        0, m_max, 64); // smaller buffer than a record
+    matrix_t Phi(matrix_t::getI(n) * 2);
+    writer.write(0.5, format_t::ACTION_TIME_UPDATE, symmetric(n), &Phi);
+
+    matrix_t K2(n, 2), z2(2, 1), K5(n, 5), z5(5, 1);
+    for(int i(0); i < n; i++){
+      for(int j(0); j < 2; j++){K2(i, j) = 100 + 10 * i + j;}
+      for(int j(0); j < 5; j++){K5(i, j) = 200 + 10 * i + j;}
+    }
+    for(int i(0); i < 2; i++){z2(i, 0) = -1 - i;}
+    for(int i(0); i < 5; i++){z5(i, 0) = -10 - i;}
+    writer.write(1.0, format_t::ACTION_MEASUREMENT_UPDATE, symmetric(n, 1000),
+        (const matrix_t *)NULL, &K2, &z2);
+    writer.write(1.5, format_t::ACTION_MEASUREMENT_UPDATE, symmetric(n, 2000),
+        (const matrix_t *)NULL, &K5, &z5);
+    writer.write(2.0, format_t::ACTION_MEASUREMENT_UPDATE, symmetric(n + 1)); // ignored due to dimension
+    BOOST_CHECK_EQUAL(writer.records(), 3u);
+  }
+
+  INS_GPS_Debug_Dump_Reader reader(ss);
+  BOOST_REQUIRE(reader.valid());
+  BOOST_CHECK_EQUAL(reader.states(), n);
+  BOOST_CHECK_EQUAL(reader.measurements_max(), m_max);
+
+  BOOST_REQUIRE(reader.next());
+  BOOST_CHECK_EQUAL(reader.time(), 0.5);
+  BOOST_CHECK_EQUAL(reader.action(), format_t::ACTION_TIME_UPDATE);
+  BOOST_CHECK_EQUAL(reader.measurements(), 0);
+  for(int i(0); i < n; i++){
+    for(int j(0); j < n; j++){
+      BOOST_CHECK_EQUAL(reader.P(i, j), symmetric(n)(i, j));
+      BOOST_CHECK_EQUAL(reader.Phi(i, j), (i == j) ? 2 : 0);
+    }
+    for(int j(0); j < m_max; j++){BOOST_CHECK_EQUAL(reader.K(i, j), 0);}
+  }
+  for(int i(0); i < m_max; i++){BOOST_CHECK_EQUAL(reader.residual(i), 0);}
+
+  BOOST_REQUIRE(reader.next()); // padded
+  BOOST_CHECK_EQUAL(reader.action(), format_t::ACTION_MEASUREMENT_UPDATE);
+  BOOST_CHECK_EQUAL(reader.measurements(), 2);
+  for(int i(0); i < n; i++){
+    BOOST_CHECK_EQUAL(reader.P(i, n - 1), 1000 + 10 * i + (n - 1));
+    BOOST_CHECK_EQUAL(reader.P(n - 1, i), 1000 + 10 * i + (n - 1));
+    BOOST_CHECK_EQUAL(reader.Phi(i, i), 0);
+    BOOST_CHECK_EQUAL(reader.K(i, 0), 100 + 10 * i);
+    BOOST_CHECK_EQUAL(reader.K(i, 1), 100 + 10 * i + 1);
+    BOOST_CHECK_EQUAL(reader.K(i, 2), 0);
+  }
+  BOOST_CHECK_EQUAL(reader.residual(0), -1);
+  BOOST_CHECK_EQUAL(reader.residual(1), -2);
+  BOOST_CHECK_EQUAL(reader.residual(2), 0);
+
+  BOOST_REQUIRE(reader.next()); // truncated
+  BOOST_CHECK_EQUAL(reader.time(), 1.5);
+  BOOST_CHECK_EQUAL(reader.measurements(), 5);
+  for(int i(0); i < n; i++){
+    for(int j(0); j < m_max; j++){
+      BOOST_CHECK_EQUAL(reader.K(i, j), 200 + 10 * i + j);
+    }
+  }
+  for(int i(0); i < m_max; i++){BOOST_CHECK_EQUAL(reader.residual(i), -10 - i);}
+
+  BOOST_CHECK(!reader.next());
+}
+
+BOOST_AUTO_TEST_CASE(thinning){
+  stringstream ss;
+  INS_GPS_Debug_Dump_Writer writer;
+  BOOST_CHECK(!writer.due(0, format_t::ACTION_TIME_UPDATE)); // not opened
+  writer.open(ss, 0, 1.0);
+  BOOST_REQUIRE(writer.active());
+
+  int time_updates(0), measurement_updates(0);
+  for(int i(0); i <= 20; i++){ // 10 Hz
+    if(writer.due(0.1 * i, format_t::ACTION_TIME_UPDATE)){time_updates++;}
+    if(i % 5 == 2){ // 2 Hz, which must not be hidden by time updates
+      if(writer.due(0.1 * i, format_t::ACTION_MEASUREMENT_UPDATE)){measurement_updates++;}
+    }
+  }
+  BOOST_CHECK_EQUAL(time_updates, 3); // 0, 1.0, 2.0
+  BOOST_CHECK_EQUAL(measurement_updates, 2); // 0.2, 1.2
+  BOOST_CHECK(writer.due(0.5, format_t::ACTION_TIME_UPDATE)); // rewind
+
+  writer.open(ss); // interval is reset
+  for(int i(0); i < 10; i++){
+    BOOST_CHECK(writer.due(0.1 * i, format_t::ACTION_TIME_UPDATE));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(seek){
+  const int n(3), records(100);
+  stringstream ss;
+  {
+    INS_GPS_Debug_Dump_Writer writer;
+    writer.open(ss, format_t::CONTENT_PHI, 0, 0, 0x400);
+    matrix_t Phi(matrix_t::getI(n));
+    for(int i(0); i < records; i++){
+      writer.write(0.01 * i, format_t::ACTION_TIME_UPDATE, symmetric(n, i), &Phi);
+    }
+  }
+
+  INS_GPS_Debug_Dump_Reader reader(ss);
+  BOOST_REQUIRE(reader.valid());
+  BOOST_CHECK_EQUAL(reader.measurements_max(), n); // zero means the dimension of state
+  int index[] = {57, 3, 99, 0, 57};
+  for(int k(0); k < sizeof(index) / sizeof(index[0]); k++){
+    BOOST_REQUIRE(reader.seek(index[k]));
+    BOOST_REQUIRE(reader.next());
+    BOOST_CHECK_EQUAL(reader.time(), 0.01 * index[k]);
+    BOOST_CHECK_EQUAL(reader.P(2, 1), index[k] + 12); // symmetric(n, index)(1, 2)
+    BOOST_CHECK_EQUAL(reader.Phi(1, 1), 1);
+  }
+  BOOST_REQUIRE(reader.seek(records - 1));
+  BOOST_CHECK(reader.next());
+  BOOST_CHECK(!reader.next());
+  BOOST_REQUIRE(reader.seek(records)); // end of dump, which can be sought after reaching the end
+  BOOST_CHECK(!reader.next());
+  BOOST_REQUIRE(reader.seek(1));
+  BOOST_CHECK(reader.next());
+  BOOST_CHECK_EQUAL(reader.time(), 0.01);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,8 +1,12 @@
 #include <iostream>
+#include <ctime>
+#include <sstream>
 
 #include "navigation/INS_GPS_Factory.h"
+#include "navigation/INS_GPS_Synchronization.h"
 
 #include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
 
 #define BOOST_TEST_MAIN
 #include <boost/test/included/unit_test.hpp>
@@ -199,4 +203,403 @@ BOOST_AUTO_TEST_CASE(option){
       typename opt_t::bias_t<typename opt_t::kf_t<void, KalmanFilter> > >::value));
 }
 
+BOOST_AUTO_TEST_CASE(ud_filter){
+  static const unsigned int n(10), q(7), m(1);
+  Matrix<double> P(n, n), Q(Matrix<double>::getI(q));
+  for(unsigned int i(0); i < n; ++i){
+    for(unsigned int j(0); j < n; ++j){
+      P(i, j) = (i == j) ? (1. + i) : (0.1 / (1 + i + j));
+    }
+  }
+  KalmanFilter<double> kf(P.copy(), Q.copy());
+  KalmanFilterUD<double> udkf(P.copy(), Q.copy());
+
+  Matrix<double> A(n, n), B(n, q), H(m, n), R(Matrix<double>::getI(m) * 0.5);
+  for(unsigned int i(0); i < n; ++i){
+    for(unsigned int j(0); j < n; ++j){A(i, j) = 0.01 * ((i * 7 + j * 3) % 11) - 0.05;}
+    for(unsigned int j(0); j < q; ++j){B(i, j) = 0.1 * ((i + j) % 5);}
+  }
+  for(unsigned int i(0); i < n; i += 3){H(0, i) = 1;}
+
+  for(int k(0); k < 100; ++k){
+    kf.predict(A, B, 0.01);
+    udkf.predict(A, B, 0.01);
+    if(k % 10 == 9){
+      Matrix<double> K_kf(kf.correct(H, R));
+      Matrix<double> K_udkf(udkf.correct(H, R));
+      for(unsigned int i(0); i < n; ++i){
+        BOOST_CHECK_SMALL(K_kf(i, 0) - K_udkf(i, 0), 1E-10);
+      }
+    }
+  }
+
+  const Matrix<double> &P_kf(kf.getP());
+  for(unsigned int i(0); i < n; ++i){
+    for(unsigned int j(0); j < n; ++j){
+      BOOST_CHECK_SMALL(P_kf(i, j) - udkf.getP(i, j), 1E-10); // element without reconstruction
+    }
+  }
+  const Matrix<double> &P_udkf(udkf.getP()); // reconstruction
+  for(unsigned int i(0); i < n; ++i){
+    for(unsigned int j(0); j < n; ++j){
+      BOOST_CHECK_SMALL(P_kf(i, j) - P_udkf(i, j), 1E-10);
+    }
+  }
+}
+
+template <class INS_GPS>
+struct static_scenario_t {
+  typedef typename INS_GPS::float_t float_t;
+  typedef typename INS_GPS::vec3_t vec3_t;
+  typedef typename INS_GPS::Earth Earth;
+
+  unsigned int seed;
+  float_t rand_normal(){ // Box-Muller with deterministic LCG, to compare same log
+    float_t u[2];
+    for(int i(0); i < 2; ++i){
+      seed = seed * 1103515245u + 12345u;
+      u[i] = ((float_t)((seed >> 8) & 0xFFFFFF) + 1) / (0x1000000 + 1);
+    }
+    return std::sqrt(-2 * std::log(u[0])) * std::cos(u[1] * M_PI * 2);
+  }
+
+  INS_GPS ins_gps;
+  static_scenario_t() : seed(0x12345678), ins_gps() {
+    // same as setup_filter() of INS_GPS.cpp
+    typename INS_GPS::mat_t P(ins_gps.getFilter().getP());
+    P(0, 0) = P(1, 1) = P(2, 2) = 1E+1;
+    P(3, 3) = P(4, 4) = P(5, 5) = 1E-8;
+    P(6, 6) = 1E+2;
+    P(7, 7) = P(8, 8) = 1E-4;
+    P(9, 9) = 5E-3;
+    ins_gps.getFilter().setP(P);
+
+    typename INS_GPS::mat_t Q(ins_gps.getFilter().getQ());
+    Q(0, 0) = Q(1, 1) = Q(2, 2) = 25E-4;
+    Q(3, 3) = Q(4, 4) = Q(5, 5) = 25E-6;
+    Q(6, 6) = 1E-6;
+    ins_gps.getFilter().setQ(Q);
+  }
+
+  void run(
+      const float_t &latitude, const float_t &longitude, const float_t &height,
+      const int &seconds){
+    ins_gps.initPosition(latitude + 1E-6, longitude - 1E-6, height + 5);
+    ins_gps.initVelocity(0.5, -0.5, 0.1);
+    ins_gps.initAttitude(0, 0.01, -0.01);
+
+    INS<float_t> truth;
+    truth.initPosition(latitude, longitude, height);
+    vec3_t accel(-truth.gravity_total());
+    vec3_t gyro(
+        Earth::Omega_Earth * std::cos(latitude), 0,
+        -Earth::Omega_Earth * std::sin(latitude));
+
+    for(int t(0); t < seconds; ++t){
+      for(int i(0); i < 100; ++i){ // 100 Hz IMU
+        vec3_t accel_noise(rand_normal(), rand_normal(), rand_normal()),
+            gyro_noise(rand_normal(), rand_normal(), rand_normal());
+        ins_gps.update(
+            accel + accel_noise * 1E-2, gyro + gyro_noise * 1E-4, 0.01);
+      }
+      GPS_Solution<float_t> gps; // 1 Hz GPS
+      gps.latitude = latitude + rand_normal() * 1E-7;
+      gps.longitude = longitude + rand_normal() * 1E-7;
+      gps.height = height + rand_normal();
+      gps.v_n = rand_normal() * 0.1;
+      gps.v_e = rand_normal() * 0.1;
+      gps.v_d = rand_normal() * 0.1;
+      gps.sigma_2d = 1;
+      gps.sigma_height = 2;
+      gps.sigma_vel = 0.2;
+      ins_gps.correct(gps);
+    }
+  }
+};
+
+BOOST_AUTO_TEST_CASE(mixed_precision){
+  typedef INS_GPS_Factory<INS<double> >::kf<KalmanFilterUD>::product double_t;
+  typedef INS_GPS_Factory<INS<double> >::kf<
+      KalmanFilterMixedPrecision<KalmanFilterUD, float>::filter_t>::product mixed_t;
+  BOOST_REQUIRE((boost::is_same<mixed_t::float_t, double>::value));
+
+  static const double lat(M_PI / 180 * 35), lng(M_PI / 180 * 139), h(50);
+  static_scenario_t<double_t> res_double;
+  static_scenario_t<mixed_t> res_mixed;
+  res_double.run(lat, lng, h, 120);
+  res_mixed.run(lat, lng, h, 120);
+
+  double_t::StandardDeviations sigma_double(res_double.ins_gps.getSigma());
+  mixed_t::StandardDeviations sigma_mixed(res_mixed.ins_gps.getSigma());
+
+  dbg("double: "
+      << res_double.ins_gps.latitude() << ", "
+      << res_double.ins_gps.longitude() << ", "
+      << res_double.ins_gps.height(), false);
+  dbg("mixed: "
+      << res_mixed.ins_gps.latitude() << ", "
+      << res_mixed.ins_gps.longitude() << ", "
+      << res_mixed.ins_gps.height(), false);
+
+  // Both should converge to the truth
+  BOOST_CHECK_SMALL(res_double.ins_gps.latitude() - lat, 2E-7);
+  BOOST_CHECK_SMALL(res_double.ins_gps.longitude() - lng, 2E-7);
+  BOOST_CHECK_SMALL(res_double.ins_gps.height() - h, 5.);
+
+  // Mixed precision should be consistent with double precision
+  BOOST_CHECK_SMALL(res_mixed.ins_gps.latitude() - res_double.ins_gps.latitude(), 1E-10);
+  BOOST_CHECK_SMALL(res_mixed.ins_gps.longitude() - res_double.ins_gps.longitude(), 1E-10);
+  BOOST_CHECK_SMALL(res_mixed.ins_gps.height() - res_double.ins_gps.height(), 1E-3);
+  BOOST_CHECK_SMALL(res_mixed.ins_gps.v_north() - res_double.ins_gps.v_north(), 1E-4);
+  BOOST_CHECK_SMALL(res_mixed.ins_gps.v_east() - res_double.ins_gps.v_east(), 1E-4);
+  BOOST_CHECK_SMALL(res_mixed.ins_gps.v_down() - res_double.ins_gps.v_down(), 1E-4);
+  BOOST_CHECK_CLOSE(sigma_mixed.v_north_ms, sigma_double.v_north_ms, 1E-2);
+  BOOST_CHECK_CLOSE(sigma_mixed.height_m, sigma_double.height_m, 1E-2);
+  BOOST_CHECK_CLOSE(sigma_mixed.pitch_rad, sigma_double.pitch_rad, 1E-2);
+  BOOST_CHECK_CLOSE(sigma_mixed.roll_rad, sigma_double.roll_rad, 1E-2);
+}
+
+BOOST_AUTO_TEST_CASE(predict_decimation){
+  typedef INS_GPS_Factory<INS<double> >::kf<KalmanFilterUD>::product ins_gps_t;
+
+  static const double lat(M_PI / 180 * 35), lng(M_PI / 180 * 139), h(50);
+  static_scenario_t<ins_gps_t> res_per_sample;
+  std::clock_t t0(std::clock());
+  res_per_sample.run(lat, lng, h, 120);
+  double elapsed_per_sample((double)(std::clock() - t0) / CLOCKS_PER_SEC);
+  ins_gps_t::StandardDeviations sigma_per_sample(res_per_sample.ins_gps.getSigma());
+
+  static const unsigned int blocks[] = {2, 5, 10, 20};
+  for(int i(0); i < sizeof(blocks) / sizeof(blocks[0]); ++i){
+    static_scenario_t<ins_gps_t> res;
+    res.ins_gps.set_predict_decimation(blocks[i]);
+    BOOST_REQUIRE_EQUAL(res.ins_gps.predict_decimation(), blocks[i]);
+    std::clock_t t1(std::clock());
+    res.run(lat, lng, h, 120);
+    double elapsed((double)(std::clock() - t1) / CLOCKS_PER_SEC);
+    ins_gps_t::StandardDeviations sigma(res.ins_gps.getSigma());
+
+    // accuracy / throughput report versus per-sample propagation
+    dbg("decimation(" << blocks[i] << "): "
+        << "speedup " << (elapsed_per_sample / elapsed) << ", "
+        << "d_lat " << (res.ins_gps.latitude() - res_per_sample.ins_gps.latitude()) << " [rad], "
+        << "d_height " << (res.ins_gps.height() - res_per_sample.ins_gps.height()) << " [m], "
+        << "sigma_v_north " << sigma.v_north_ms << " (" << sigma_per_sample.v_north_ms << "), "
+        << "sigma_pitch " << sigma.pitch_rad << " (" << sigma_per_sample.pitch_rad << ")", false);
+
+    BOOST_CHECK_SMALL(res.ins_gps.latitude() - res_per_sample.ins_gps.latitude(), 1E-9);
+    BOOST_CHECK_SMALL(res.ins_gps.longitude() - res_per_sample.ins_gps.longitude(), 1E-9);
+    BOOST_CHECK_SMALL(res.ins_gps.height() - res_per_sample.ins_gps.height(), 1E-2);
+    BOOST_CHECK_CLOSE(sigma.v_north_ms, sigma_per_sample.v_north_ms, 1.);
+    BOOST_CHECK_CLOSE(sigma.height_m, sigma_per_sample.height_m, 1.);
+    BOOST_CHECK_CLOSE(sigma.pitch_rad, sigma_per_sample.pitch_rad, 1.);
+    BOOST_CHECK_CLOSE(sigma.roll_rad, sigma_per_sample.roll_rad, 1.);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(predict_decimation_inspection){
+  typedef INS_GPS_Factory<INS<double> >::kf<KalmanFilterUD>::product ins_gps_t;
+
+  static const double lat(M_PI / 180 * 35), lng(M_PI / 180 * 139), h(50);
+  static const unsigned int block(10);
+  static_scenario_t<ins_gps_t> res, res_inspected;
+  res.ins_gps.set_predict_decimation(block);
+  res_inspected.ins_gps.set_predict_decimation(block);
+  res.run(lat, lng, h, 10);
+  res_inspected.run(lat, lng, h, 10); // ends with correction, i.e., no pending propagation
+
+  const ins_gps_t &inspected(res_inspected.ins_gps);
+  double sigma_v_north(std::sqrt(inspected.getFilter().getP(0, 0)));
+  ins_gps_t::vec3_t accel(0, 0, -9.8), gyro;
+  for(unsigned int i(0); i < block; ++i){
+    if(i > 0){
+      // sigma is read in the middle of a block, which must not flush the propagation
+      BOOST_REQUIRE_EQUAL(inspected.getSigma().v_north_ms, sigma_v_north);
+    }
+    res.ins_gps.update(accel, gyro, 0.01);
+    res_inspected.ins_gps.update(accel, gyro, 0.01);
+  }
+  BOOST_CHECK(inspected.getSigma().v_north_ms > sigma_v_north); // block is completed
+  BOOST_CHECK_EQUAL(res_inspected.ins_gps.predict_decimation(), block);
+
+  // reading does not change the result
+  const ins_gps_t::mat_t &P(res.ins_gps.getFilter().getP()),
+      &P_inspected(res_inspected.ins_gps.getFilter().getP());
+  for(unsigned int i(0); i < P.rows(); ++i){
+    for(unsigned int j(0); j < P.columns(); ++j){
+      BOOST_CHECK_EQUAL(P_inspected(i, j), P(i, j));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(back_propagate){
+  typedef INS_GPS_Factory<INS<double> >::kf<KalmanFilterUD>::product base_t;
+  typedef INS_GPS_Back_Propagate<base_t> ins_gps_t;
+
+  static const double lat(M_PI / 180 * 35), lng(M_PI / 180 * 139), h(50);
+  static_scenario_t<base_t> res_base;
+  static_scenario_t<ins_gps_t> res;
+  INS_GPS_Back_Propagate_Property<double> property;
+  property.back_propagate_depth = -1;
+  property.time_update_rate = 100;
+  res.ins_gps.setup_back_propagation(property);
+  const ins_gps_t::snapshots_t &snapshots(res.ins_gps.get_snapshots());
+  ins_gps_t::snapshots_t::size_type capacity(snapshots.capacity());
+  BOOST_REQUIRE(capacity >= 300);
+
+  res_base.run(lat, lng, h, 30);
+  res.run(lat, lng, h, 30);
+
+  // snapshots never affect the main filter
+  BOOST_CHECK_EQUAL(res.ins_gps.latitude(), res_base.ins_gps.latitude());
+  BOOST_CHECK_EQUAL(res.ins_gps.longitude(), res_base.ins_gps.longitude());
+  BOOST_CHECK_EQUAL(res.ins_gps.height(), res_base.ins_gps.height());
+
+  // pruning keeps the number of snapshots within the preallocated capacity
+  BOOST_CHECK(!snapshots.empty());
+  BOOST_CHECK(snapshots.size() <= capacity);
+  BOOST_CHECK_EQUAL(snapshots.capacity(), capacity);
+  BOOST_CHECK(snapshots.front().elapsedT_from_last_correct >= property.back_propagate_depth - 1.1);
+  BOOST_CHECK(snapshots.back().elapsedT_from_last_correct <= 0);
+  for(ins_gps_t::snapshots_t::const_iterator it(snapshots.begin()), it_end(snapshots.end());
+      it != it_end; ++it){
+    ins_gps_t::mat_t Phi(it->getPhi());
+    for(unsigned int i(0); i < Phi.rows(); ++i){
+      BOOST_CHECK_SMALL(Phi(i, i) - 1, 1E-2);
+    }
+  }
+
+  // snapshot is a plain record, from which INS/GPS is rebuilt
+  BOOST_CHECK(boost::has_trivial_copy<ins_gps_t::snapshot_content_t>::value);
+  const ins_gps_t::restored_t &restored(res.ins_gps.restore_snapshots(snapshots.size()));
+  BOOST_REQUIRE_EQUAL(restored.size(), snapshots.size());
+  for(unsigned int i(0); i < restored.size(); ++i){
+    for(unsigned int j(0); j < base_t::STATE_VALUES; ++j){
+      BOOST_CHECK_EQUAL(restored[i][j], snapshots[i].x[j]);
+    }
+    ins_gps_t::mat_t P(snapshots[i].getP());
+    for(unsigned int j(0); j < base_t::P_SIZE; ++j){
+      BOOST_CHECK_SMALL(restored[i].getFilter().getP(j, j) - P(j, j), P(j, j) * 1E-10);
+    }
+  }
+  BOOST_CHECK_SMALL(restored[restored.size() - 1].latitude() - res.ins_gps.latitude(), 1E-8);
+  BOOST_CHECK_SMALL(restored[restored.size() - 1].height() - res.ins_gps.height(), 1E-1);
+}
+
+BOOST_AUTO_TEST_CASE(rts_smoother){
+  typedef INS_GPS_Factory<INS<double> >::kf<KalmanFilterUD>::product base_t;
+  typedef INS_GPS_RTS_Smoother<base_t> ins_gps_t;
+
+  static const double lat(M_PI / 180 * 35), lng(M_PI / 180 * 139), h(50);
+  static const int seconds(60);
+  static_scenario_t<ins_gps_t> res;
+  res.ins_gps.setup_rts_smoothing(INS_GPS_RTS_Smoother_Property());
+  res.ins_gps.set_time_tag(100);
+  res.run(lat, lng, h, seconds);
+  BOOST_REQUIRE_EQUAL(res.ins_gps.records(), seconds * 100);
+  double lat_final(res.ins_gps.latitude()), h_final(res.ins_gps.height());
+
+  struct error_t {
+    double v2, h2, att2, sigma_h;
+    int n;
+    error_t() : v2(0), h2(0), att2(0), sigma_h(0), n(0) {}
+    void add(ins_gps_t &ins_gps, const double &height){
+      if(ins_gps.time_tag() < 110){return;} // skip convergence
+      v2 += std::pow(ins_gps.v_north(), 2) + std::pow(ins_gps.v_east(), 2) + std::pow(ins_gps.v_down(), 2);
+      h2 += std::pow(ins_gps.height() - height, 2);
+      att2 += std::pow(ins_gps.euler_theta(), 2) + std::pow(ins_gps.euler_phi(), 2); // truth is level
+      sigma_h += ins_gps.getSigma().height_m;
+      ++n;
+    }
+  } filtered, smoothed;
+
+  // forward (filtered)
+  res.ins_gps.replay_begin();
+  BOOST_REQUIRE_EQUAL(res.ins_gps.records(), seconds * 100 + 1); // with terminal
+  for(int i(0); res.ins_gps.replay_next(); ++i){
+    BOOST_REQUIRE_SMALL(res.ins_gps.time_tag() - (100 + 0.01 * i), 1E-6);
+    filtered.add(res.ins_gps, h);
+  }
+
+  // backward, then replay
+  res.ins_gps.smooth();
+  res.ins_gps.replay_begin();
+  while(res.ins_gps.replay_next()){
+    smoothed.add(res.ins_gps, h);
+  }
+  BOOST_CHECK_SMALL(res.ins_gps.latitude() - lat_final, 1E-12); // terminal is unchanged
+  BOOST_CHECK_SMALL(res.ins_gps.height() - h_final, 1E-6);
+
+  dbg("RTS: "
+      << "RMS(v) " << std::sqrt(smoothed.v2 / smoothed.n)
+        << " (" << std::sqrt(filtered.v2 / filtered.n) << "), "
+      << "RMS(h) " << std::sqrt(smoothed.h2 / smoothed.n)
+        << " (" << std::sqrt(filtered.h2 / filtered.n) << "), "
+      << "RMS(pitch, roll) " << std::sqrt(smoothed.att2 / smoothed.n)
+        << " (" << std::sqrt(filtered.att2 / filtered.n) << "), "
+      << "mean(sigma_h) " << (smoothed.sigma_h / smoothed.n)
+        << " (" << (filtered.sigma_h / filtered.n) << ")", false);
+  BOOST_CHECK(smoothed.v2 < filtered.v2);
+  BOOST_CHECK(smoothed.h2 < filtered.h2);
+  BOOST_CHECK(smoothed.att2 < filtered.att2);
+  BOOST_CHECK(smoothed.sigma_h < filtered.sigma_h);
+}
+
+BOOST_AUTO_TEST_CASE(realtime_snapshot_pool){
+  typedef INS_GPS_Factory<INS<double> >::kf<KalmanFilterUD>::product base_t;
+  struct ins_gps_t : public INS_GPS_RealTime<base_t> {
+    typedef INS_GPS_RealTime<base_t> super_t;
+    using super_t::snapshots_t;
+    const snapshots_t &get_snapshots() const {return super_t::snapshots;}
+    int find_snapshot(const double &t) const {return super_t::find_snapshot(t);}
+    const double &now() const {return super_t::elapsedT;}
+  } ins_gps;
+  INS_GPS_RealTime_Property property;
+  property.max_delay = 1;
+  property.time_update_rate = 100;
+  ins_gps.setup_realtime(property);
+  const ins_gps_t::snapshots_t &snapshots(ins_gps.get_snapshots());
+  ins_gps_t::snapshots_t::size_type capacity(snapshots.capacity());
+  BOOST_REQUIRE_EQUAL(capacity, property.snapshot_capacity());
+
+  ins_gps.initPosition(M_PI / 180 * 35, M_PI / 180 * 139, 50);
+  ins_gps_t::vec3_t accel(0, 0, -9.8), gyro;
+  for(int i(0); i < 300; ++i){
+    ins_gps.update(accel, gyro, (i % 2 == 0) ? 0.009 : 0.011); // jittered 100 Hz
+    // The pool never grows, and the oldest is dropped.
+    BOOST_REQUIRE_EQUAL(snapshots.capacity(), capacity);
+    BOOST_REQUIRE_EQUAL(snapshots.size(), std::min<int>(i + 1, capacity));
+  }
+
+  // Lookup agrees with linear search
+  for(double t(ins_gps.now() - 1.2); t < ins_gps.now() + 0.1; t += 0.0037){
+    int expected(-1);
+    for(int i(0); i < snapshots.size(); ++i){
+      if(snapshots[i].t < t){expected = i;}
+    }
+    BOOST_REQUIRE_EQUAL(ins_gps.find_snapshot(t), expected);
+  }
+
+  // GPS information delayed 0.5 seconds
+  BOOST_REQUIRE(ins_gps.setup_correct(-0.5));
+  BOOST_CHECK_SMALL(snapshots.front().t - (ins_gps.now() - 0.5), 0.0111);
+  BOOST_CHECK(!ins_gps.setup_correct(-5)); // too old
+  BOOST_CHECK(!ins_gps.setup_correct(0.1)); // future
+
+  // snapshot is a plain record, and correction rebuilds INS/GPS from it
+  BOOST_CHECK(boost::has_trivial_copy<ins_gps_t::snapshots_t::value_type>::value);
+  GPS_Solution<double> gps;
+  gps.latitude = M_PI / 180 * 35;
+  gps.longitude = M_PI / 180 * 139;
+  gps.height = 50;
+  gps.v_n = gps.v_e = gps.v_d = 0;
+  gps.sigma_2d = 1;
+  gps.sigma_height = 2;
+  gps.sigma_vel = 0.2;
+  double height_before(ins_gps.height());
+  ins_gps.correct(gps);
+  BOOST_CHECK_EQUAL(snapshots.capacity(), capacity);
+  BOOST_CHECK(std::abs(ins_gps.height() - 50) < std::abs(height_before - 50));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "MS5611.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#endif
+
+using namespace std;
+
+static const Uint16 coef_datasheet[6] = {40127, 36924, 23317, 23282, 33464, 28312};
+
+/**
+ * Step by step compensation written along Figures 2 and 3 of the datasheet
+ */
+static void convert_reference(
+    const Uint32 &d1, const Uint32 &d2,
+    Int32 &pressure, Int32 &temperature,
+    const Uint16 (&coef)[6]){
+  Int32 dT((Int32)d2 - (coef[4] << 8));
+  temperature = (Int32)2000 + (((int64_t)dT * coef[5]) >> 23);
+
+  int64_t off(((int64_t)coef[1] << 16) + (((int64_t)coef[3] * dT) >> 7));
+  int64_t sens(((int64_t)coef[0] << 15) + (((int64_t)coef[2] * dT) >> 8));
+
+  // Figure 3
+  if(temperature < 2000){
+    int64_t t2(((int64_t)dT * dT) >> 31);
+    int64_t dT2(temperature - 2000), dT2_2(dT2 * dT2);
+    int64_t off2((dT2_2 * 5) >> 1);
+    int64_t sens2((dT2_2 * 5) >> 2);
+    if(temperature < -1500){
+      int64_t dT3(temperature + 1500), dT3_2(dT3 * dT3);
+      off2 += dT3_2 * 7;
+      sens2 += (dT3_2 * 11) >> 1;
+    }
+    temperature -= (Int32)t2;
+    off -= off2;
+    sens -= sens2;
+  }
+
+  pressure = (Int32)(((((int64_t)d1 * sens) >> 21) - off) >> 15);
+}
+
+BOOST_AUTO_TEST_SUITE(MS5611_convert)
+
+BOOST_AUTO_TEST_CASE(datasheet){
+  Uint32 d1(9085466), d2(8569150);
+  Int32 pressure, temperature;
+  MS5611::convert(coef_datasheet, 1, &d1, &d2, &pressure, &temperature);
+  BOOST_CHECK_EQUAL(temperature, 2007); // 20.07 degC
+  BOOST_CHECK_EQUAL(pressure, 100009); // 1000.09 mbar
+}
+
+BOOST_AUTO_TEST_CASE(cold){
+  // D2 is swept from about -40 to 85 degC so as to cover both branches of Figure 3.
+  vector<Uint32> d1, d2;
+  for(Uint32 d(7400000); d <= 9300000; d += 1000){
+    d1.push_back(9085466 - (d2.size() % 7) * 131071);
+    d2.push_back(d);
+  }
+  const int n(d1.size()); // batch size is not a multiple of vector lanes
+  BOOST_REQUIRE(n % 2 == 1);
+  vector<Int32> pressure(n), temperature(n);
+  MS5611::convert(coef_datasheet, n, &d1[0], &d2[0], &pressure[0], &temperature[0]);
+
+  int cold(0), very_cold(0);
+  for(int i(0); i < n; ++i){
+    Int32 pressure_ref, temperature_ref;
+    convert_reference(d1[i], d2[i], pressure_ref, temperature_ref, coef_datasheet);
+    BOOST_CHECK_EQUAL(temperature[i], temperature_ref);
+    BOOST_CHECK_EQUAL(pressure[i], pressure_ref);
+    if(temperature_ref < 2000){cold++;}
+    if(temperature_ref < -1500){very_cold++;}
+  }
+  BOOST_CHECK(cold > very_cold);
+  BOOST_CHECK(very_cold > 0);
+  BOOST_CHECK(n > cold);
+}
+
+BOOST_AUTO_TEST_CASE(altitude){
+  BOOST_CHECK_SMALL(MS5611::altitude<double>(101325, 101325), 1E-12);
+  BOOST_CHECK_CLOSE(MS5611::altitude<double>(89875, 101325), 1000., 0.1); // about 1000 m in ISA
+}
+
+BOOST_AUTO_TEST_SUITE_END()
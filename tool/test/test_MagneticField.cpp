@@ -0,0 +1,86 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "navigation/MagneticFieldCache.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#endif
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(Magnetic)
+
+BOOST_AUTO_TEST_CASE(cache){
+  BOOST_CHECK_SMALL(MagneticFieldCache::gps2year(0, 0) - (1980 + 5. / 366), 1E-12);
+  BOOST_CHECK_SMALL(MagneticFieldCache::gps2year(1877, 60 * 60 * 24 * 5) - 2016, 1E-12); // 2016/1/1
+  BOOST_CHECK_SMALL(MagneticFieldCache::gps2year(2086, 60 * 60 * 24 * 3) - 2020, 1E-12); // 2020/1/1
+
+  MagneticFieldCache cache(2017.5);
+  BOOST_REQUIRE_EQUAL(cache.year(), 2017.5);
+  const MagneticField::model_t model(IGRF12::get_model(2017.5));
+  const double tolerance(cache.get_grid().get_property().tolerance);
+  for(double lat(-60); lat <= 70; lat += 13.1){
+    for(double lng(-180); lng < 180; lng += 23.3){
+      double phi(M_PI / 180 * lat), lambda(M_PI / 180 * lng), h(345);
+      MagneticField::field_components_res_t
+          cached(cache.field_components(phi, lambda, h)),
+          direct(MagneticField::field_components(model, phi, lambda, h));
+      BOOST_CHECK_SMALL(cached.north - direct.north, tolerance);
+      BOOST_CHECK_SMALL(cached.east - direct.east, tolerance);
+      BOOST_CHECK_SMALL(cached.down - direct.down, tolerance);
+    }
+  }
+  BOOST_CHECK(cache.get_grid().tiles_generated() > 0);
+  BOOST_CHECK(cache.get_grid().max_error() <= tolerance);
+
+  cache.set_year(IGRF12::IGRF2015.year); // discards tiles
+  BOOST_CHECK_EQUAL(cache.get_grid().tiles_generated(), 0);
+  MagneticField::field_components_res_t
+      cached(cache.field_components(0.6, 2.4, 0)),
+      direct(MagneticField::field_components(IGRF12::IGRF2015, 0.6, 2.4, 0));
+  BOOST_CHECK_SMALL(cached.north - direct.north, tolerance);
+  BOOST_CHECK_SMALL(cached.east - direct.east, tolerance);
+  BOOST_CHECK_SMALL(cached.down - direct.down, tolerance);
+}
+
+BOOST_AUTO_TEST_CASE(batch){
+  const MagneticField::model_t model(IGRF12::get_model(2017.5));
+  std::vector<double> lat, lng, h;
+  for(int i(0); i < 7; ++i){ // ordered by rows, in which latitude is shared
+    for(int j(0); j < 11; ++j){
+      lat.push_back(M_PI / 180 * (-75 + 25 * i));
+      lng.push_back(M_PI / 180 * (-170 + 33 * j));
+      h.push_back((j % 3) * 1000.);
+    }
+  }
+  for(int j(0); j < 11; ++j){ // ordered by columns, in which longitude is shared
+    for(int i(0); i < 7; ++i){
+      lat.push_back(M_PI / 180 * (-75 + 25 * i));
+      lng.push_back(M_PI / 180 * (-170 + 33 * j));
+      h.push_back(0);
+    }
+  }
+  const int n(lat.size());
+  for(int threads(1); threads <= 3; ++threads){
+    std::vector<double> north(n), east(n), down(n);
+    MagneticField::field_components(model,
+        &lat[0], &lng[0], &h[0], n, &north[0], &east[0], &down[0], threads);
+    for(int i(0); i < n; ++i){
+      MagneticField::field_components_res_t
+          single(MagneticField::field_components(model, lat[i], lng[i], h[i]));
+      BOOST_CHECK_SMALL(north[i] - single.north, 1E-9);
+      BOOST_CHECK_SMALL(east[i] - single.east, 1E-9);
+      BOOST_CHECK_SMALL(down[i] - single.down, 1E-9);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
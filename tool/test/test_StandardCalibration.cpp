@@ -0,0 +1,121 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+typedef double float_sylph_t;
+#include "analyze_common.h"
+#include "StandardCalibration.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#define BOOST_FIXTURE_TEST_CASE(name, fixture) void name()
+#endif
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(Calibration)
+
+/*
+ * Step-by-step calculation before the compiled transform was introduced,
+ * i.e., temperature compensation, scale factor, and then misalignment.
+ */
+template <std::size_t N>
+static void calibrate_reference(
+    const int raw[], const int &bias_mod,
+    const StandardCalibration::calibration_info_t<N> &info,
+    float_sylph_t (&res)[N]){
+  float_sylph_t bias[N];
+  for(int i(0); i < N; i++){
+    bias[i] = info.bias_base[i] + (info.bias_tc[i] * bias_mod);
+  }
+  float_sylph_t tmp[N];
+  for(int i(0); i < N; i++){
+    tmp[i] = (((float_sylph_t)raw[i] - bias[i]) / info.sf[i]);
+  }
+  for(int i(0); i < N; i++){
+    res[i] = 0;
+    for(int j(0); j < N; j++){
+      res[i] += info.alignment[i][j] * tmp[j];
+    }
+  }
+}
+
+struct fixture_t {
+  StandardCalibration calibration;
+  static const int channels = 9;
+  std::vector<int> raw;
+  std::size_t n;
+  fixture_t() : calibration(), raw(), n(1001) { // not a multiple of vector length
+    calibration.setup_default();
+    calibration.check_spec("acc_bias 32700 32800 32750");
+    calibration.check_spec("acc_bias_tc 0.5 -0.25 0.125");
+    calibration.check_spec("acc_sf 4.1e+2 4.2e+2 4.15e+2");
+    calibration.check_spec("acc_mis 1 0.01 -0.02 0.005 1 0.015 -0.01 0.02 1");
+    calibration.check_spec("gyro_bias 32760 32770 32780");
+    calibration.check_spec("gyro_bias_tc -0.1 0.2 0.3");
+    calibration.check_spec("gyro_sf 9.3e+2 9.4e+2 9.35e+2");
+    calibration.check_spec("gyro_mis 1 -0.003 0.004 0.002 1 -0.001 0.005 0.006 1");
+    unsigned int seed(0x12345678);
+    raw.resize(n * channels);
+    for(std::size_t i(0); i < raw.size(); ++i){ // deterministic LCG
+      seed = seed * 1103515245u + 12345u;
+      raw[i] = (int)((seed >> 8) & 0xFFFF);
+    }
+  }
+  void reference(std::size_t k, float_sylph_t (&accel)[3], float_sylph_t (&omega)[3]) const {
+    const int *rec(&raw[channels * k]);
+    calibrate_reference(&rec[calibration.index_base], rec[calibration.index_temp_ch],
+        calibration.accel, accel);
+    calibrate_reference(&rec[calibration.index_base + 3], rec[calibration.index_temp_ch],
+        calibration.gyro, omega);
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(strict, fixture_t){
+  calibration.check_spec("strict on");
+  BOOST_REQUIRE(calibration.strict);
+  std::vector<float_sylph_t> accel(n * 3), omega(n * 3);
+  calibration.raw2accel(&raw[0], n, (float_sylph_t (*)[3])&accel[0]);
+  calibration.raw2omega(&raw[0], n, (float_sylph_t (*)[3])&omega[0]);
+  for(std::size_t k(0); k < n; ++k){
+    float_sylph_t accel_ref[3], omega_ref[3];
+    reference(k, accel_ref, omega_ref);
+    Vector3<float_sylph_t>
+        accel_single(calibration.raw2accel(&raw[channels * k])),
+        omega_single(calibration.raw2omega(&raw[channels * k]));
+    for(int i(0); i < 3; ++i){ // bitwise identical
+      BOOST_CHECK_EQUAL(accel_single[i], accel_ref[i]);
+      BOOST_CHECK_EQUAL(omega_single[i], omega_ref[i]);
+      BOOST_CHECK_EQUAL(accel[k * 3 + i], accel_ref[i]);
+      BOOST_CHECK_EQUAL(omega[k * 3 + i], omega_ref[i]);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(compiled, fixture_t){
+  BOOST_REQUIRE(!calibration.strict);
+  std::vector<float_sylph_t> accel(n * 3), omega(n * 3);
+  calibration.raw2accel(&raw[0], n, (float_sylph_t (*)[3])&accel[0]);
+  calibration.raw2omega(&raw[0], n, (float_sylph_t (*)[3])&omega[0]);
+  for(std::size_t k(0); k < n; ++k){
+    float_sylph_t accel_ref[3], omega_ref[3];
+    reference(k, accel_ref, omega_ref);
+    Vector3<float_sylph_t>
+        accel_single(calibration.raw2accel(&raw[channels * k])),
+        omega_single(calibration.raw2omega(&raw[channels * k]));
+    for(int i(0); i < 3; ++i){ // only rounding errors, [m/s^2], [rad/s]
+      BOOST_CHECK_SMALL(accel_single[i] - accel_ref[i], 1E-10);
+      BOOST_CHECK_SMALL(omega_single[i] - omega_ref[i], 1E-12);
+      BOOST_CHECK_SMALL(accel[k * 3 + i] - accel_ref[i], 1E-10);
+      BOOST_CHECK_SMALL(omega[k * 3 + i] - omega_ref[i], 1E-12);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
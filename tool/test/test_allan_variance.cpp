@@ -0,0 +1,53 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include "algorithm/allan_variance.h"
+
+#define BOOST_TEST_MAIN
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#if !defined(BOOST_VERSION)
+#define BOOST_FIXTURE_TEST_SUITE(name, fixture)
+#define BOOST_AUTO_TEST_SUITE_END()
+#define BOOST_AUTO_TEST_CASE(name) void name()
+#endif
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(Allan)
+
+BOOST_AUTO_TEST_CASE(allan_variance){
+  static const int n(5000);
+  std::vector<double> y(n);
+  for(int i(0); i < n; ++i){ // white noise with bias and drift
+    y[i] = 9.8 + 1E-5 * i
+        + std::sqrt(-2 * std::log((std::rand() + 1.) / (RAND_MAX + 2.)))
+          * std::cos(2 * M_PI * std::rand() / RAND_MAX) * 0.05;
+  }
+  AllanVariance<double> allan(1000);
+  allan.add(&y[0], n);
+  BOOST_REQUIRE_EQUAL(allan.clusters_available(), 10); // m = 1, 2, ..., 512
+  for(int i(0); i < allan.clusters_available(); ++i){ // brute force
+    unsigned long m(allan.cluster_size(i));
+    double sum2(0);
+    for(unsigned long k(0); k + m * 2 <= (unsigned long)n; ++k){
+      double d(0);
+      for(unsigned long j(0); j < m; ++j){
+        d += y[k + m + j] - y[k + j];
+      }
+      sum2 += d * d;
+    }
+    double adev(std::sqrt(sum2 / (2. * m * m * (n - m * 2 + 1))));
+    BOOST_CHECK_CLOSE(allan.deviation(i), adev, 1E-6);
+  }
+  BOOST_CHECK_CLOSE(allan.deviation(0), 0.05, 5);
+  BOOST_CHECK_CLOSE(allan.deviation(4), 0.05 / 4, 25);
+  double mean(0);
+  for(int i(0); i < n; ++i){mean += y[i];}
+  BOOST_CHECK_CLOSE(allan.mean(), mean / n, 1E-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
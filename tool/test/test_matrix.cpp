@@ -695,6 +695,84 @@ BOOST_AUTO_TEST_CASE(UD){
   matrix_compare_delta(*A, _A, ACCEPTABLE_DELTA_DEFAULT);
 }
 
+BOOST_AUTO_TEST_CASE(multiply_add){
+  assign_unsymmetric();
+  dbg_print();
+  matrix_t C(matrix_t::getI(SIZE));
+  matrix_t::multiply_add(C, *A, B->transpose(), 2, -1);
+  matrix_compare_delta((*A) * B->transpose() * 2 - matrix_t::getI(SIZE), C, ACCEPTABLE_DELTA_DEFAULT);
+
+  matrix_t D(SIZE, SIZE * 2);
+  matrix_t::partial_t D_p(D.partial(SIZE, SIZE, 0, SIZE));
+  matrix_t::multiply_add(D_p, A->transpose(), B->partial(SIZE, SIZE, 0, 0));
+  matrix_compare_delta(A->transpose() * (*B), D_p, ACCEPTABLE_DELTA_DEFAULT);
+  matrix_compare_delta(matrix_t(SIZE, SIZE), D.partial(SIZE, SIZE, 0, 0), ACCEPTABLE_DELTA_DEFAULT);
+
+  BOOST_CHECK_THROW(matrix_t::multiply_add(D, *A, *B), MatrixException);
+}
+
+template <class M1, class M2>
+matrix_t naive_mul(const M1 &m1, const M2 &m2){
+  matrix_t res(m1.rows(), m2.columns());
+  for(unsigned int i(0); i < res.rows(); ++i){
+    for(unsigned int j(0); j < res.columns(); ++j){
+      for(unsigned int p(0); p < m1.columns(); ++p){
+        res(i, j) += m1(i, p) * m2(p, j);
+      }
+    }
+  }
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(blocked_product){
+  // sizes are chosen to exceed direct loop threshold and to leave fractions of blocks
+  const unsigned int m(MatrixKernel<content_t>::MC + 7), n(37), k(MatrixKernel<content_t>::KC + 3);
+  matrix_t X(m, k), Y(k, n);
+  for(unsigned int i(0); i < m; ++i){
+    for(unsigned int j(0); j < k; ++j){X(i, j) = gen_rand();}
+  }
+  for(unsigned int i(0); i < k; ++i){
+    for(unsigned int j(0); j < n; ++j){Y(i, j) = gen_rand();}
+  }
+  matrix_compare_delta(naive_mul(X, Y), X * Y, 1E-10 * k);
+  matrix_compare_delta(naive_mul(Y.transpose(), X.transpose()), Y.transpose() * X.transpose(), 1E-10 * k);
+  matrix_compare_delta(
+      naive_mul(X.partial(m - 3, k - 5, 2, 1), Y.partial(k - 5, n - 2, 4, 1)),
+      X.partial(m - 3, k - 5, 2, 1) * Y.partial(k - 5, n - 2, 4, 1), 1E-10 * k);
+  matrix_t Z(naive_mul(X, Y));
+  matrix_t::multiply_add(Z, X, Y, -1, 1);
+  matrix_compare_delta(matrix_t(m, n), Z, 1E-10 * k);
+}
+
+BOOST_AUTO_TEST_CASE(pool){
+  MatrixPool::release();
+  MatrixPool::statistics_t stat0(MatrixPool::statistics());
+  {
+    matrix_t _A(A->copy());
+  }
+  MatrixPool::statistics_t stat1(MatrixPool::statistics());
+  BOOST_CHECK_EQUAL(stat1.blocks_in_use, stat0.blocks_in_use);
+#if defined(MATRIX_POOL_ENABLED)
+  BOOST_CHECK(stat1.blocks_cached > stat0.blocks_cached);
+  for(int i(0); i < 0x100; ++i){
+    matrix_t _A((*A) * (*B));
+    matrix_compare_delta(*A * *B, _A, ACCEPTABLE_DELTA_DEFAULT);
+  }
+  MatrixPool::statistics_t stat2(MatrixPool::statistics());
+  BOOST_CHECK_EQUAL(stat2.blocks_in_use, stat0.blocks_in_use);
+  BOOST_CHECK(stat2.reused - stat1.reused >= (stat2.allocations - stat1.allocations) * 9 / 10);
+  MatrixPool::release();
+  BOOST_CHECK_EQUAL(MatrixPool::statistics().blocks_cached, 0);
+  BOOST_CHECK_EQUAL(MatrixPool::statistics().bytes_cached, 0);
+#endif
+  {
+    cmatrix_t _A(SIZE, SIZE), __A(_A), ___A; // storage with non-POD elements and shared counter
+    ___A = __A;
+    ___A(0, 0) = Complex<content_t>(1, 2);
+    BOOST_CHECK_EQUAL(_A(0, 0).imaginary(), 2);
+  }
+}
+
 template <class FloatT>
 void mat_mul(FloatT *x, const int &r1, const int &c1,
     FloatT *y, const int &c2,
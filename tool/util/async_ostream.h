@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __ASYNC_OSTREAM_H__
+#define __ASYNC_OSTREAM_H__
+
+#include <streambuf>
+#include <ostream>
+#include <vector>
+
+#if !defined(ASYNC_OSTREAM_THREAD_DISABLED) \
+    && ((__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1700)))
+#define ASYNC_OSTREAM_THREAD_ENABLED
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#if (__cplusplus < 201103L) && !defined(noexcept)
+#define noexcept throw()
+#endif
+
+/**
+ * Output stream buffer, which accumulates characters into a large block
+ * and hands the block over to another stream buffer.
+ * Flush requests (for example, by std::endl) are ignored,
+ * and the accumulated characters are written when the block becomes full or at close().
+ * When threaded, the blocks are written by a dedicated writer thread with double buffering,
+ * therefore formatting and writing can be overlapped.
+ */
+template<
+    class _Elem,
+    class _Traits>
+class basic_AsyncOStreambuf : public std::basic_streambuf<_Elem, _Traits> {
+  protected:
+    typedef std::basic_streambuf<_Elem, _Traits> super_t;
+    typedef std::streamsize streamsize;
+    typedef typename super_t::int_type int_type;
+
+    super_t *target;
+    std::vector<_Elem> buf[2];
+    int front; ///< index of the buffer being filled
+    bool closed;
+#if defined(ASYNC_OSTREAM_THREAD_ENABLED)
+    bool threaded;
+    std::thread writer;
+    std::mutex mtx;
+    std::condition_variable cv;
+    streamsize back_size; ///< number of characters to be written in the back buffer, zero when empty
+    bool finished;
+
+    void write_loop(){
+      std::unique_lock<std::mutex> lock(mtx);
+      while(true){
+        cv.wait(lock, [this]{return (back_size > 0) || finished;});
+        if(back_size == 0){break;} // finished
+        lock.unlock();
+        target->sputn(&buf[front ^ 1][0], back_size);
+        lock.lock();
+        back_size = 0;
+        cv.notify_all();
+      }
+    }
+#endif
+
+    void reset_pointers(){
+      super_t::setp(&buf[front][0], &buf[front][0] + buf[front].size());
+    }
+
+    void hand_over(){
+      streamsize n(super_t::pptr() - super_t::pbase());
+      if(n <= 0){return;}
+#if defined(ASYNC_OSTREAM_THREAD_ENABLED)
+      if(threaded){
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]{return back_size == 0;});
+        front ^= 1;
+        back_size = n;
+        cv.notify_all();
+        lock.unlock();
+        reset_pointers();
+        return;
+      }
+#endif
+      target->sputn(super_t::pbase(), n);
+      reset_pointers();
+    }
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param target_ stream buffer to which the blocks are written
+     * @param threaded_ when true, a writer thread is launched if available
+     * @param block_size size of a block in characters
+     */
+    basic_AsyncOStreambuf(
+        super_t *target_,
+        const bool &threaded_ = true,
+        const std::size_t &block_size = 0x10000)
+        : super_t(), target(target_), front(0), closed(false)
+#if defined(ASYNC_OSTREAM_THREAD_ENABLED)
+        , threaded(threaded_), writer(), mtx(), cv(), back_size(0), finished(false)
+#endif
+        {
+      buf[0].resize(block_size);
+      buf[1].resize(block_size);
+      reset_pointers();
+#if defined(ASYNC_OSTREAM_THREAD_ENABLED)
+      if(threaded){writer = std::thread(&basic_AsyncOStreambuf::write_loop, this);}
+#endif
+    }
+    virtual ~basic_AsyncOStreambuf() noexcept {
+      close();
+    }
+
+    /**
+     * Write all the accumulated characters, stop the writer thread,
+     * and flush the target. Further outputs are written synchronously.
+     */
+    void close(){
+      if(closed){return;}
+      hand_over();
+#if defined(ASYNC_OSTREAM_THREAD_ENABLED)
+      if(threaded){
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          finished = true;
+          cv.notify_all();
+        }
+        writer.join();
+        threaded = false;
+      }
+#endif
+      target->pubsync();
+      closed = true;
+    }
+
+  protected:
+    int_type overflow(int_type c = _Traits::eof()){
+      hand_over();
+      if(!_Traits::eq_int_type(c, _Traits::eof())){
+        *super_t::pptr() = _Traits::to_char_type(c);
+        super_t::pbump(1);
+      }
+      return _Traits::not_eof(c);
+    }
+    int sync(){
+      if(closed){ // writes synchronously after close()
+        hand_over();
+        return target->pubsync();
+      }
+      return 0;
+    }
+};
+
+typedef basic_AsyncOStreambuf<char, std::char_traits<char> > AsyncOStreambuf;
+
+class AsyncOStream : public std::ostream {
+  public:
+    typedef AsyncOStreambuf buf_t;
+  protected:
+    typedef std::ostream super_t;
+    buf_t buf;
+  public:
+    /**
+     * Constructor
+     *
+     * @param target stream to which outputs are finally written
+     * @param threaded when true, a writer thread is launched if available
+     */
+    AsyncOStream(std::ostream &target, const bool &threaded = true)
+        : super_t(NULL), buf(target.rdbuf(), threaded) {
+      super_t::init(&buf);
+    }
+    ~AsyncOStream() noexcept {}
+    void close(){buf.close();}
+};
+
+#if (__cplusplus < 201103L) && defined(noexcept)
+#undef noexcept
+#endif
+
+#endif /* __ASYNC_OSTREAM_H__ */
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __ORDERED_FORMATTER_H__
+#define __ORDERED_FORMATTER_H__
+
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(ORDERED_FORMATTER_THREAD_DISABLED) \
+    && ((__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1700)))
+#define ORDERED_FORMATTER_THREAD_ENABLED
+#include <thread>
+#endif
+
+/**
+ * Deferred text formatter, which records values to be written by operator<<
+ * and formats them later on multiple threads.
+ * The recorded values are divided into chunks, each of which is formatted
+ * into its own buffers independently, and the buffers are written
+ * to the destination streams strictly in the recorded order.
+ * Therefore, the outputs are identical to the ones written directly.
+ * The numeric format (flags and precision) of a destination is sampled at formatting,
+ * and must not be changed while values for it are recorded.
+ */
+class OrderedFormatter {
+  public:
+    typedef std::ostream &(*manipulator_t)(std::ostream &);
+  protected:
+    struct field_t {
+      enum {
+        DEST, FLOAT, INT, UINT, CHAR, TEXT, STRING, MANIP,
+      } kind;
+      union {
+        std::ostream *dest;
+        double f;
+        long long i;
+        unsigned long long u;
+        char c;
+        const char *text;
+        std::size_t string_index;
+        manipulator_t manip;
+      } v;
+    };
+    struct segment_t {
+      std::ostream *dest;
+      std::string text;
+    };
+    struct chunk_t {
+      std::size_t begin, end;
+      std::ostream *dest; ///< destination at the beginning of the chunk
+      std::vector<segment_t> segments;
+    };
+
+    std::vector<field_t> fields;
+    std::vector<std::string> strings;
+    std::vector<chunk_t> chunks;
+    std::ostream *last_dest;
+    int threads;
+    std::size_t capacity;
+
+    field_t &push(std::ostream *dest){
+      if(fields.size() >= capacity){flush();}
+      if(dest != last_dest){
+        field_t f;
+        f.kind = field_t::DEST;
+        f.v.dest = last_dest = dest;
+        fields.push_back(f);
+      }
+      fields.push_back(field_t());
+      return fields.back();
+    }
+
+    static void emit(chunk_t &chunk, std::ostream *dest, std::ostringstream &ss){
+      if(ss.tellp() <= 0){return;}
+      chunk.segments.push_back(segment_t());
+      chunk.segments.back().dest = dest;
+      chunk.segments.back().text = ss.str();
+      ss.str("");
+    }
+
+    void format(chunk_t &chunk) const {
+      std::ostringstream ss;
+      std::ostream *dest(chunk.dest);
+      if(dest){
+        ss.flags(dest->flags());
+        ss.precision(dest->precision());
+      }
+      for(std::size_t i(chunk.begin); i < chunk.end; ++i){
+        const field_t &f(fields[i]);
+        switch(f.kind){
+          case field_t::DEST:
+            emit(chunk, dest, ss);
+            dest = f.v.dest;
+            ss.flags(dest->flags());
+            ss.precision(dest->precision());
+            break;
+          case field_t::FLOAT: ss << f.v.f; break;
+          case field_t::INT: ss << f.v.i; break;
+          case field_t::UINT: ss << f.v.u; break;
+          case field_t::CHAR: ss << f.v.c; break;
+          case field_t::TEXT: ss << f.v.text; break;
+          case field_t::STRING: ss << strings[f.v.string_index]; break;
+          case field_t::MANIP: ss << f.v.manip; break;
+        }
+      }
+      emit(chunk, dest, ss);
+    }
+
+    void format_chunks(const int &offset, const int &step){
+      for(std::size_t i(offset); i < chunks.size(); i += step){
+        format(chunks[i]);
+      }
+    }
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param threads_ number of threads used for formatting
+     * @param capacity_ number of values recorded before formatting
+     */
+    OrderedFormatter(const int &threads_, const std::size_t &capacity_ = 0x40000)
+        : fields(), strings(), chunks(), last_dest(NULL),
+        threads(threads_ > 1 ? threads_ : 1), capacity(capacity_) {
+      fields.reserve(capacity + 1);
+    }
+    ~OrderedFormatter(){
+      flush();
+    }
+
+    /**
+     * Format all the recorded values, and write them to their destinations.
+     */
+    void flush(){
+      if(fields.empty()){return;}
+
+      // Divide into chunks; each chunk remembers its initial destination.
+      std::size_t n(threads * 4);
+      if(n > fields.size()){n = fields.size();}
+      chunks.resize(n);
+      {
+        std::ostream *dest(NULL);
+        std::size_t i(0);
+        for(std::size_t j(0); j < n; ++j){
+          chunk_t &chunk(chunks[j]);
+          chunk.begin = i;
+          chunk.end = fields.size() * (j + 1) / n;
+          chunk.dest = dest;
+          chunk.segments.clear();
+          for(; i < chunk.end; ++i){
+            if(fields[i].kind == field_t::DEST){dest = fields[i].v.dest;}
+          }
+        }
+      }
+
+#if defined(ORDERED_FORMATTER_THREAD_ENABLED)
+      std::vector<std::thread> workers;
+      for(int t(1); t < threads; ++t){
+        workers.push_back(std::thread(&OrderedFormatter::format_chunks, this, t, threads));
+      }
+      format_chunks(0, threads);
+      for(std::size_t t(0); t < workers.size(); ++t){
+        workers[t].join();
+      }
+#else
+      format_chunks(0, 1);
+#endif
+
+      // Commit in order
+      for(std::size_t j(0); j < n; ++j){
+        for(std::size_t k(0); k < chunks[j].segments.size(); ++k){
+          const segment_t &seg(chunks[j].segments[k]);
+          seg.dest->write(seg.text.data(), seg.text.size());
+        }
+      }
+
+      fields.clear();
+      strings.clear();
+      last_dest = NULL;
+    }
+
+    /**
+     * Proxy of a destination stream, whose operator<< writes values directly,
+     * or records them when a formatter is attached.
+     */
+    class writer_t {
+      protected:
+        std::ostream *dest;
+        OrderedFormatter *formatter;
+      public:
+        writer_t(std::ostream &dest_, OrderedFormatter *formatter_ = NULL)
+            : dest(&dest_), formatter(formatter_) {}
+#define make_entry(type, kind_, member) \
+        writer_t &operator<<(const type &v){ \
+          if(formatter){ \
+            field_t &f(formatter->push(dest)); \
+            f.kind = field_t::kind_; \
+            f.v.member = v; \
+          }else{ \
+            (*dest) << v; \
+          } \
+          return *this; \
+        }
+        make_entry(double, FLOAT, f);
+        make_entry(float, FLOAT, f);
+        make_entry(short, INT, i);
+        make_entry(int, INT, i);
+        make_entry(long, INT, i);
+        make_entry(long long, INT, i);
+        make_entry(unsigned short, UINT, u);
+        make_entry(unsigned int, UINT, u);
+        make_entry(unsigned long, UINT, u);
+        make_entry(unsigned long long, UINT, u);
+        make_entry(char, CHAR, c);
+#undef make_entry
+        /**
+         * @param v text, which must be alive until flush(), such as a string literal.
+         */
+        writer_t &operator<<(const char *v){
+          if(formatter){
+            field_t &f(formatter->push(dest));
+            f.kind = field_t::TEXT;
+            f.v.text = v;
+          }else{
+            (*dest) << v;
+          }
+          return *this;
+        }
+        writer_t &operator<<(const std::string &v){
+          if(formatter){
+            field_t &f(formatter->push(dest));
+            f.kind = field_t::STRING;
+            f.v.string_index = formatter->strings.size();
+            formatter->strings.push_back(v);
+          }else{
+            (*dest) << v;
+          }
+          return *this;
+        }
+        writer_t &operator<<(manipulator_t v){
+          if(formatter){
+            field_t &f(formatter->push(dest));
+            f.kind = field_t::MANIP;
+            f.v.manip = v;
+          }else{
+            (*dest) << v;
+          }
+          return *this;
+        }
+    };
+};
+
+#endif /* __ORDERED_FORMATTER_H__ */
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026, M.Naruoka (fenrir)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the naruoka.org nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software
+ *   without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __SPILL_FILE_H__
+#define __SPILL_FILE_H__
+
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Disk-backed array of fixed-size records, which is accessed through
+ * a memory-mapped window. Only one window is mapped at a time,
+ * therefore the resident memory is bounded regardless of the number of records.
+ * Sequential access in either forward or backward direction is efficient.
+ * A pointer returned by append() or operator[] is valid until the next call of them.
+ */
+class SpillFile {
+  public:
+    typedef std::size_t size_type;
+  protected:
+    std::FILE *fp;
+    size_type m_record_size, m_records, m_capacity;
+    size_type window_records, granularity;
+    size_type window_first; ///< index of the first record in the current window
+    char *view;      ///< mapped address
+    size_type view_size;
+    char *window;    ///< address of window_first-th record in the view
+
+    SpillFile(const SpillFile &);
+    SpillFile &operator=(const SpillFile &);
+
+    void unmap(){
+      if(!view){return;}
+#ifdef _WIN32
+      UnmapViewOfFile(view);
+#else
+      munmap(view, view_size);
+#endif
+      view = window = NULL;
+    }
+
+    void resize_file(const size_type &records){
+      std::fflush(fp);
+      long long bytes((long long)(records * m_record_size));
+#ifdef _WIN32
+      if(_chsize_s(_fileno(fp), bytes) != 0){
+#else
+      if(ftruncate(fileno(fp), (off_t)bytes) != 0){
+#endif
+        throw std::runtime_error("SpillFile: failed to resize");
+      }
+    }
+
+    void map(const size_type &index){
+      unmap();
+      window_first = index - (index % window_records);
+      size_type offset(window_first * m_record_size);
+      size_type offset_aligned(offset - (offset % granularity));
+      view_size = (window_first + window_records) * m_record_size - offset_aligned;
+#ifdef _WIN32
+      HANDLE mapping(CreateFileMapping(
+          (HANDLE)_get_osfhandle(_fileno(fp)), NULL, PAGE_READWRITE, 0, 0, NULL));
+      if(mapping){
+        view = (char *)MapViewOfFile(mapping, FILE_MAP_WRITE,
+            (DWORD)((unsigned long long)offset_aligned >> 32),
+            (DWORD)(offset_aligned & 0xFFFFFFFFu),
+            view_size);
+        CloseHandle(mapping); // The view keeps the mapping alive.
+      }
+      if(!view){
+#else
+      void *addr(mmap(NULL, view_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+          fileno(fp), (off_t)offset_aligned));
+      view = (addr == MAP_FAILED) ? NULL : (char *)addr;
+      if(!view){
+#endif
+        throw std::runtime_error("SpillFile: failed to map");
+      }
+      window = view + (offset - offset_aligned);
+    }
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param record_size size of a record in bytes
+     * @param fname file name of the spill file; if NULL, a temporary file,
+     * which is removed automatically, is used.
+     * @param window_bytes approximate size of the mapped window in bytes
+     */
+    SpillFile(
+        const size_type &record_size,
+        const char *fname = NULL,
+        const size_type &window_bytes = 0x1000000)
+        : fp(fname ? std::fopen(fname, "w+b") : std::tmpfile()),
+        m_record_size(record_size), m_records(0), m_capacity(0),
+        window_records(window_bytes / record_size), granularity(0),
+        window_first(0), view(NULL), view_size(0), window(NULL) {
+      if(!fp){throw std::runtime_error("SpillFile: failed to open");}
+      if(window_records == 0){window_records = 1;}
+#ifdef _WIN32
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      granularity = info.dwAllocationGranularity;
+#else
+      granularity = (size_type)sysconf(_SC_PAGESIZE);
+#endif
+    }
+    ~SpillFile(){
+      unmap();
+      std::fclose(fp);
+    }
+
+    size_type size() const {return m_records;}
+    size_type record_size() const {return m_record_size;}
+
+    /**
+     * Append a new record at the end.
+     *
+     * @return (void *) address of the new record, whose content is undefined.
+     */
+    void *append(){
+      if(m_records >= m_capacity){ // extend the file by one window
+        unmap();
+        m_capacity += window_records;
+        resize_file(m_capacity);
+      }
+      return (*this)[m_records++];
+    }
+
+    /**
+     * Return the address of the specified record.
+     * The window is remapped if the record is out of the current window.
+     *
+     * @param index index of the record, which must be less than size()
+     */
+    void *operator[](const size_type &index){
+      if((!view) || (index < window_first) || (index >= window_first + window_records)){
+        map(index);
+      }
+      return window + (index - window_first) * m_record_size;
+    }
+};
+
+#endif /* __SPILL_FILE_H__ */